@@ -0,0 +1,492 @@
+#define DMOD_ENABLE_REGISTRATION ON
+#include "dmod.h"
+#include "dmini.h"
+#include <string.h>
+
+/**
+ * @brief Benchmark application for dmini module
+ *
+ * This application times the dmini API on synthetic INI documents of
+ * various shapes and reports throughput and memory use. It can be loaded
+ * with dmod_loader along with the dmini module, on the host or on target,
+ * so that numbers can be compared across releases.
+ */
+
+/**
+ * @brief Millisecond clock used for all measurements
+ *
+ * Can be overridden at build time on targets with a different time source.
+ */
+#ifndef BENCH_NOW_MS
+#   define BENCH_NOW_MS()       ((uint64_t)Dmod_GetTickCount())
+#endif
+
+/**
+ * @brief Minimum wall time of a single measurement
+ *
+ * Operations are repeated until at least this much time has passed so that
+ * coarse system ticks still give stable numbers.
+ */
+#ifndef BENCH_MIN_TIME_MS
+#   define BENCH_MIN_TIME_MS    200
+#endif
+
+/**
+ * @brief Scratch files used by the file benchmarks
+ */
+#ifndef BENCH_INPUT_FILE
+#   define BENCH_INPUT_FILE     "/tmp/bench_dmini.ini"
+#endif
+#ifndef BENCH_OUTPUT_FILE
+#   define BENCH_OUTPUT_FILE    "/tmp/bench_dmini_output.ini"
+#endif
+
+#define BENCH_NAME_SIZE         24
+
+/**
+ * @brief Shape of a synthetic INI document
+ */
+typedef struct
+{
+    const char* name;
+    int sections;                   /* number of named sections */
+    int keys;                       /* keys per section */
+    int value_len;                  /* length of every value */
+} bench_config_t;
+
+/**
+ * @brief State shared by the operations of one benchmark scenario
+ */
+typedef struct
+{
+    const bench_config_t* config;
+    char* data;                     /* generated INI document */
+    size_t data_len;
+    dmini_context_t ctx;            /* context holding the parsed document */
+    char* section_names;            /* sections * BENCH_NAME_SIZE */
+    char* key_names;                /* keys * BENCH_NAME_SIZE */
+    char* miss_names;               /* keys * BENCH_NAME_SIZE, never present */
+    char* value;                    /* value written by the set benchmark */
+    dmini_handle_t* handles;        /* sections * keys handles into ctx */
+    dmini_snapshot_t snapshot;      /* frozen copy of ctx */
+    char* output;                   /* buffer for dmini_generate_string() */
+    size_t output_size;
+    size_t peak_memory;             /* largest dmini_memory_usage() seen */
+} bench_state_t;
+
+/**
+ * @brief Benchmarked operation
+ *
+ * @return 0 on success, non-zero to abort the measurement
+ */
+typedef int (*bench_fn_t)(bench_state_t* state);
+
+#define BENCH_SECTION(state, s)     ((state)->section_names + (size_t)(s) * BENCH_NAME_SIZE)
+#define BENCH_KEY(state, k)         ((state)->key_names + (size_t)(k) * BENCH_NAME_SIZE)
+#define BENCH_MISS(state, k)        ((state)->miss_names + (size_t)(k) * BENCH_NAME_SIZE)
+
+/**
+ * @brief Generate a synthetic INI document
+ *
+ * @param sections  Number of named sections
+ * @param keys      Number of keys per section
+ * @param value_len Length of each value
+ * @param out_len   Receives the length of the document (may be NULL)
+ *
+ * @return Document allocated with Dmod_Malloc, or NULL on failure
+ */
+static char* bench_make_ini(int sections, int keys, int value_len, size_t* out_len)
+{
+    /* "[section_NNNNNN]\n" + keys * "key_NNNNNN=<value>\n" */
+    size_t line_max = 24 + (size_t)value_len;
+    size_t capacity = (size_t)sections * (24 + (size_t)keys * line_max) + 1;
+    char* data = (char*)Dmod_Malloc(capacity);
+    if (!data)
+    {
+        return NULL;
+    }
+
+    size_t pos = 0;
+    for (int s = 0; s < sections; s++)
+    {
+        pos += (size_t)Dmod_SnPrintf(data + pos, capacity - pos, "[section_%d]\n", s);
+        for (int k = 0; k < keys; k++)
+        {
+            pos += (size_t)Dmod_SnPrintf(data + pos, capacity - pos, "key_%d=", k);
+            for (int v = 0; v < value_len; v++)
+            {
+                data[pos++] = (char)('a' + (k + v) % 26);
+            }
+            data[pos++] = '\n';
+        }
+    }
+    data[pos] = '\0';
+
+    if (out_len)
+    {
+        *out_len = pos;
+    }
+    return data;
+}
+
+/**
+ * @brief Build a table of names following a printf pattern
+ */
+static char* bench_make_names(const char* pattern, int count)
+{
+    char* names = (char*)Dmod_Malloc((size_t)count * BENCH_NAME_SIZE);
+    if (!names)
+    {
+        return NULL;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        Dmod_SnPrintf(names + (size_t)i * BENCH_NAME_SIZE, BENCH_NAME_SIZE, pattern, i);
+    }
+    return names;
+}
+
+/**
+ * @brief Record the memory held by a context
+ */
+static void bench_track_memory(bench_state_t* state, dmini_context_t ctx)
+{
+    size_t used = dmini_memory_usage(ctx);
+    if (used > state->peak_memory)
+    {
+        state->peak_memory = used;
+    }
+}
+
+/**
+ * @brief Time an operation and print one result line
+ *
+ * @param label         Name of the operation
+ * @param fn            Operation to repeat
+ * @param state         Scenario state
+ * @param ops_per_call  Number of API calls made by one invocation of fn
+ * @param bytes_per_call Bytes processed by one invocation (0 = report ops/s)
+ */
+static void bench_run(const char* label, bench_fn_t fn, bench_state_t* state,
+                      uint64_t ops_per_call, uint64_t bytes_per_call)
+{
+    uint64_t runs = 0;
+    uint64_t start = BENCH_NOW_MS();
+    uint64_t elapsed = 0;
+    do
+    {
+        if (fn(state) != 0)
+        {
+            DMOD_LOG_ERROR("  %-16s FAILED\n", label);
+            return;
+        }
+        runs++;
+        elapsed = BENCH_NOW_MS() - start;
+    } while (elapsed < BENCH_MIN_TIME_MS);
+
+    uint64_t ns_per_op = elapsed * 1000000u / (runs * ops_per_call);
+    if (bytes_per_call)
+    {
+        /* bytes per millisecond is the same as kB/s */
+        uint64_t kb_per_s = bytes_per_call * runs / (elapsed ? elapsed : 1);
+        Dmod_Printf("  %-16s %10lu ns/op %10lu kB/s\n", label,
+                    (unsigned long)ns_per_op, (unsigned long)kb_per_s);
+    }
+    else
+    {
+        uint64_t ops_per_s = ops_per_call * runs * 1000u / (elapsed ? elapsed : 1);
+        Dmod_Printf("  %-16s %10lu ns/op %10lu op/s\n", label,
+                    (unsigned long)ns_per_op, (unsigned long)ops_per_s);
+    }
+}
+
+static int bench_op_parse_string(bench_state_t* state)
+{
+    dmini_context_t ctx = dmini_create();
+    if (!ctx || dmini_parse_string(ctx, state->data) != DMINI_OK)
+    {
+        dmini_destroy(ctx);
+        return 1;
+    }
+    bench_track_memory(state, ctx);
+    dmini_destroy(ctx);
+    return 0;
+}
+
+static int bench_op_parse_file(bench_state_t* state)
+{
+    dmini_context_t ctx = dmini_create();
+    if (!ctx || dmini_parse_file(ctx, BENCH_INPUT_FILE) != DMINI_OK)
+    {
+        dmini_destroy(ctx);
+        return 1;
+    }
+    bench_track_memory(state, ctx);
+    dmini_destroy(ctx);
+    return 0;
+}
+
+static int bench_op_get_hit(bench_state_t* state)
+{
+    for (int s = 0; s < state->config->sections; s++)
+    {
+        const char* section = BENCH_SECTION(state, s);
+        for (int k = 0; k < state->config->keys; k++)
+        {
+            if (dmini_get_string(state->ctx, section, BENCH_KEY(state, k), NULL) == NULL)
+            {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int bench_op_get_miss(bench_state_t* state)
+{
+    for (int s = 0; s < state->config->sections; s++)
+    {
+        const char* section = BENCH_SECTION(state, s);
+        for (int k = 0; k < state->config->keys; k++)
+        {
+            if (dmini_get_string(state->ctx, section, BENCH_MISS(state, k), NULL) != NULL)
+            {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int bench_op_get_frozen(bench_state_t* state)
+{
+    for (int s = 0; s < state->config->sections; s++)
+    {
+        const char* section = BENCH_SECTION(state, s);
+        for (int k = 0; k < state->config->keys; k++)
+        {
+            if (dmini_get_string(state->snapshot, section, BENCH_KEY(state, k), NULL) == NULL)
+            {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int bench_op_get_handle(bench_state_t* state)
+{
+    size_t count = (size_t)state->config->sections * (size_t)state->config->keys;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (dmini_handle_get_string(state->ctx, state->handles[i], NULL) == NULL)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int bench_op_set(bench_state_t* state)
+{
+    for (int s = 0; s < state->config->sections; s++)
+    {
+        const char* section = BENCH_SECTION(state, s);
+        for (int k = 0; k < state->config->keys; k++)
+        {
+            if (dmini_set_string(state->ctx, section, BENCH_KEY(state, k), state->value) != DMINI_OK)
+            {
+                return 1;
+            }
+        }
+    }
+    bench_track_memory(state, state->ctx);
+    return 0;
+}
+
+static int bench_op_generate_string(bench_state_t* state)
+{
+    return dmini_generate_string(state->ctx, state->output, state->output_size) > 0 ? 0 : 1;
+}
+
+static int bench_op_generate_file(bench_state_t* state)
+{
+    return dmini_generate_file(state->ctx, BENCH_OUTPUT_FILE) == DMINI_OK ? 0 : 1;
+}
+
+/**
+ * @brief Write a document to a file
+ */
+static int bench_write_file(const char* filename, const char* data, size_t len)
+{
+    void* file = Dmod_FileOpen(filename, "w");
+    if (!file)
+    {
+        return 1;
+    }
+    size_t written = Dmod_FileWrite(data, 1, len, file);
+    Dmod_FileClose(file);
+    return written == len ? 0 : 1;
+}
+
+/**
+ * @brief Release everything held by a scenario
+ */
+static void bench_state_free(bench_state_t* state)
+{
+    dmini_destroy(state->snapshot);
+    dmini_destroy(state->ctx);
+    Dmod_Free(state->data);
+    Dmod_Free(state->section_names);
+    Dmod_Free(state->key_names);
+    Dmod_Free(state->miss_names);
+    Dmod_Free(state->value);
+    Dmod_Free(state->handles);
+    Dmod_Free(state->output);
+    Dmod_FileRemove(BENCH_INPUT_FILE);
+    Dmod_FileRemove(BENCH_OUTPUT_FILE);
+}
+
+/**
+ * @brief Benchmark: all operations on one document shape
+ */
+static void bench_scenario(const bench_config_t* config)
+{
+    bench_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.config = config;
+
+    Dmod_Printf("BENCH: %s (sections: %d, keys per section: %d, value length: %d)\n",
+                config->name, config->sections, config->keys, config->value_len);
+
+    state.data = bench_make_ini(config->sections, config->keys, config->value_len, &state.data_len);
+    state.section_names = bench_make_names("section_%d", config->sections);
+    state.key_names = bench_make_names("key_%d", config->keys);
+    state.miss_names = bench_make_names("missing_%d", config->keys);
+    state.value = (char*)Dmod_Malloc((size_t)config->value_len + 1);
+    state.ctx = dmini_create();
+    if (!state.data || !state.section_names || !state.key_names || !state.miss_names ||
+        !state.value || !state.ctx)
+    {
+        DMOD_LOG_ERROR("  Out of memory preparing the scenario\n");
+        bench_state_free(&state);
+        return;
+    }
+    memset(state.value, 'x', (size_t)config->value_len);
+    state.value[config->value_len] = '\0';
+
+    if (bench_write_file(BENCH_INPUT_FILE, state.data, state.data_len) != 0 ||
+        dmini_parse_string(state.ctx, state.data) != DMINI_OK)
+    {
+        DMOD_LOG_ERROR("  Failed to prepare the input\n");
+        bench_state_free(&state);
+        return;
+    }
+    bench_track_memory(&state, state.ctx);
+
+    uint64_t total_keys = (uint64_t)config->sections * (uint64_t)config->keys;
+    state.handles = (dmini_handle_t*)Dmod_Malloc((size_t)total_keys * sizeof(dmini_handle_t));
+    state.output_size = (size_t)dmini_generate_string(state.ctx, NULL, 0);
+    state.output = (char*)Dmod_Malloc(state.output_size);
+    state.snapshot = dmini_freeze(state.ctx);
+    if (!state.handles || !state.output || !state.snapshot)
+    {
+        DMOD_LOG_ERROR("  Out of memory preparing the scenario\n");
+        bench_state_free(&state);
+        return;
+    }
+
+    for (int s = 0; s < config->sections; s++)
+    {
+        for (int k = 0; k < config->keys; k++)
+        {
+            state.handles[(size_t)s * (size_t)config->keys + (size_t)k] =
+                dmini_lookup(state.ctx, BENCH_SECTION(&state, s), BENCH_KEY(&state, k));
+        }
+    }
+
+    bench_run("parse_string", bench_op_parse_string, &state, 1, state.data_len);
+    bench_run("parse_file", bench_op_parse_file, &state, 1, state.data_len);
+    bench_run("get_string hit", bench_op_get_hit, &state, total_keys, 0);
+    bench_run("get_string miss", bench_op_get_miss, &state, total_keys, 0);
+    bench_run("frozen get", bench_op_get_frozen, &state, total_keys, 0);
+    bench_run("handle_get", bench_op_get_handle, &state, total_keys, 0);
+    bench_run("set_string", bench_op_set, &state, total_keys, 0);
+    bench_run("generate_string", bench_op_generate_string, &state, 1, state.output_size);
+    bench_run("generate_file", bench_op_generate_file, &state, 1, state.output_size);
+
+    Dmod_Printf("  %-16s %10lu bytes input, %lu bytes peak context memory\n", "memory",
+                (unsigned long)state.data_len, (unsigned long)state.peak_memory);
+
+    bench_state_free(&state);
+}
+
+/**
+ * @brief Benchmark: parse time versus number of keys in one section
+ *
+ * With linear parsing the time per key stays flat as the section grows.
+ */
+static void bench_parse_scaling(void)
+{
+    static const int key_counts[] = { 250, 500, 1000, 2000, 4000, 8000 };
+
+    Dmod_Printf("BENCH: Parse scaling (one section, 16-byte values)\n");
+    Dmod_Printf("  %8s %10s %12s %12s\n", "keys", "runs", "us/parse", "ns/key");
+
+    for (size_t i = 0; i < sizeof(key_counts) / sizeof(key_counts[0]); i++)
+    {
+        int keys = key_counts[i];
+        char* data = bench_make_ini(1, keys, 16, NULL);
+        if (!data)
+        {
+            DMOD_LOG_ERROR("  Out of memory generating %d keys\n", keys);
+            return;
+        }
+
+        uint64_t runs = 0;
+        uint64_t start = BENCH_NOW_MS();
+        uint64_t elapsed = 0;
+        do
+        {
+            dmini_context_t ctx = dmini_create();
+            if (!ctx || dmini_parse_string(ctx, data) != DMINI_OK)
+            {
+                DMOD_LOG_ERROR("  Parse failed for %d keys\n", keys);
+                dmini_destroy(ctx);
+                Dmod_Free(data);
+                return;
+            }
+            dmini_destroy(ctx);
+            runs++;
+            elapsed = BENCH_NOW_MS() - start;
+        } while (elapsed < BENCH_MIN_TIME_MS);
+
+        Dmod_Printf("  %8d %10lu %12lu %12lu\n", keys,
+                    (unsigned long)runs,
+                    (unsigned long)(elapsed * 1000u / runs),
+                    (unsigned long)(elapsed * 1000000u / (runs * (uint64_t)keys)));
+        Dmod_Free(data);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    static const bench_config_t configs[] = {
+        { "Small config",   4,    8,   16 },
+        { "Many sections",  256,  4,   16 },
+        { "Wide section",   1,    2000, 16 },
+        { "Long values",    8,    32,  256 },
+    };
+
+    DMOD_LOG_INFO("=== DMINI Benchmarks ===\n\n");
+
+    for (size_t i = 0; i < sizeof(configs) / sizeof(configs[0]); i++)
+    {
+        bench_scenario(&configs[i]);
+        Dmod_Printf("\n");
+    }
+    bench_parse_scaling();
+
+    Dmod_Printf("\n=== Benchmarks finished ===\n");
+    return 0;
+}
@@ -0,0 +1,126 @@
+#define DMOD_ENABLE_REGISTRATION ON
+#include "dmod.h"
+#include "dmini.h"
+#include <string.h>
+
+/**
+ * @brief INI to binary image compiler
+ *
+ * Parses an INI file with the dmini module and writes it as a binary image
+ * (dmini_export_binary()) that the target opens in place with
+ * dmini_open_binary(), so no text has to be parsed at boot. The image is
+ * verified by opening it again before the tool reports success.
+ *
+ * Usage: dmini_compile <input.ini> <output.bin>
+ */
+
+/**
+ * @brief Write the whole buffer to a file
+ */
+static int compile_write_file(const char* filename, const void* data, size_t len)
+{
+    void* file = Dmod_FileOpen(filename, "w");
+    if (!file)
+    {
+        return DMINI_ERR_FILE;
+    }
+    size_t written = Dmod_FileWrite(data, 1, len, file);
+    Dmod_FileClose(file);
+    return written == len ? DMINI_OK : DMINI_ERR_FILE;
+}
+
+/**
+ * @brief Check that an image answers like the context it was built from
+ */
+static int compile_verify(dmini_context_t ctx, const void* image, size_t size)
+{
+    dmini_snapshot_t snapshot = dmini_open_binary(image, size);
+    if (!snapshot)
+    {
+        return DMINI_ERR_GENERAL;
+    }
+
+    int result = DMINI_OK;
+    if (dmini_generate_string(snapshot, NULL, 0) != dmini_generate_string(ctx, NULL, 0) ||
+        dmini_section_count(snapshot) != dmini_section_count(ctx))
+    {
+        result = DMINI_ERR_GENERAL;
+    }
+
+    dmini_destroy(snapshot);
+    return result;
+}
+
+/**
+ * @brief Compile one INI file
+ */
+static int compile_file(const char* input, const char* output)
+{
+    dmini_context_t ctx = dmini_create();
+    if (!ctx)
+    {
+        DMOD_LOG_ERROR("Out of memory\n");
+        return DMINI_ERR_MEMORY;
+    }
+
+    int result = dmini_parse_file(ctx, input);
+    if (result != DMINI_OK)
+    {
+        DMOD_LOG_ERROR("Failed to parse %s (%d)\n", input, result);
+        dmini_destroy(ctx);
+        return result;
+    }
+
+    int size = dmini_export_binary(ctx, NULL, 0);
+    if (size < 0)
+    {
+        DMOD_LOG_ERROR("%s does not fit the binary format (%d)\n", input, size);
+        dmini_destroy(ctx);
+        return size;
+    }
+
+    /* Dmod_Malloc memory is suitably aligned for the image */
+    void* image = Dmod_Malloc((size_t)size);
+    if (!image)
+    {
+        DMOD_LOG_ERROR("Out of memory\n");
+        dmini_destroy(ctx);
+        return DMINI_ERR_MEMORY;
+    }
+
+    result = dmini_export_binary(ctx, image, (size_t)size);
+    if (result == size)
+    {
+        result = compile_verify(ctx, image, (size_t)size);
+    }
+    if (result == DMINI_OK)
+    {
+        result = compile_write_file(output, image, (size_t)size);
+    }
+
+    if (result == DMINI_OK)
+    {
+        Dmod_Printf("%s: %d sections, %d bytes of text -> %s: %d bytes\n",
+                    input, dmini_section_count(ctx), dmini_generate_string(ctx, NULL, 0) - 1,
+                    output, size);
+    }
+    else
+    {
+        DMOD_LOG_ERROR("Failed to write %s (%d)\n", output, result);
+    }
+
+    Dmod_Free(image);
+    dmini_destroy(ctx);
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        Dmod_Printf("Usage: dmini_compile <input.ini> <output.bin>\n");
+        return 1;
+    }
+
+    return compile_file(argv[1], argv[2]) == DMINI_OK ? 0 : 1;
+}
@@ -518,6 +518,2293 @@ static void test_active_section(void)
     TEST_PASS();
 }
 
+/**
+ * @brief Test: Lookups in large contexts (hash index)
+ */
+static void test_many_sections_keys(void)
+{
+    TEST_START("Lookups with many sections and keys");
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+
+    char section[16];
+    char key[16];
+    for (int s = 0; s < 40; s++)
+    {
+        Dmod_SnPrintf(section, sizeof(section), "sec%d", s);
+        for (int k = 0; k < 50; k++)
+        {
+            Dmod_SnPrintf(key, sizeof(key), "key%d", k);
+            int result = dmini_set_int(ctx, section, key, s * 1000 + k);
+            TEST_ASSERT(result == DMINI_OK, "Failed to set value");
+        }
+    }
+
+    TEST_ASSERT(dmini_section_count(ctx) == 41, "Expected 41 sections");
+    TEST_ASSERT(dmini_get_int(ctx, "sec0", "key0", -1) == 0, "Wrong sec0/key0");
+    TEST_ASSERT(dmini_get_int(ctx, "sec39", "key49", -1) == 39049, "Wrong sec39/key49");
+    TEST_ASSERT(dmini_get_int(ctx, "sec17", "key23", -1) == 17023, "Wrong sec17/key23");
+    TEST_ASSERT(dmini_has_key(ctx, "sec17", "key50") == 0, "key50 should not exist");
+    TEST_ASSERT(dmini_has_section(ctx, "sec40") == 0, "sec40 should not exist");
+
+    /* Overwrite keeps a single entry */
+    dmini_set_int(ctx, "sec5", "key5", 7);
+    TEST_ASSERT(dmini_get_int(ctx, "sec5", "key5", -1) == 7, "Overwrite failed");
+    TEST_ASSERT(dmini_key_count(ctx, "sec5") == 50, "Overwrite must not add a key");
+
+    /* Removed entries disappear from lookups and can be added again */
+    for (int k = 0; k < 50; k += 2)
+    {
+        Dmod_SnPrintf(key, sizeof(key), "key%d", k);
+        dmini_remove_key(ctx, "sec3", key);
+    }
+    TEST_ASSERT(dmini_key_count(ctx, "sec3") == 25, "Expected 25 keys after removal");
+    TEST_ASSERT(dmini_has_key(ctx, "sec3", "key10") == 0, "key10 should be removed");
+    TEST_ASSERT(dmini_get_int(ctx, "sec3", "key11", -1) == 3011, "key11 should remain");
+    dmini_set_int(ctx, "sec3", "key10", 1);
+    TEST_ASSERT(dmini_get_int(ctx, "sec3", "key10", -1) == 1, "Re-added key not found");
+
+    TEST_ASSERT(dmini_remove_section(ctx, "sec20") == DMINI_OK, "Failed to remove section");
+    TEST_ASSERT(dmini_has_section(ctx, "sec20") == 0, "sec20 should be removed");
+    TEST_ASSERT(dmini_get_int(ctx, "sec21", "key1", -1) == 21001, "sec21 should remain");
+
+    /* Key order is preserved for iteration */
+    const char* name = dmini_key_name(ctx, "sec39", 0);
+    TEST_ASSERT(name != NULL && strcmp(name, "key0") == 0, "First key should be key0");
+    name = dmini_key_name(ctx, "sec39", 49);
+    TEST_ASSERT(name != NULL && strcmp(name, "key49") == 0, "Last key should be key49");
+
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Arena-backed contexts
+ */
+static void test_arena(void)
+{
+    TEST_START("Arena-backed context");
+
+    const char* ini_data =
+        "global_key=global_value\n"
+        "[section1]\n"
+        "key1=value1\n"
+        "key2=value2\n"
+        "[section2]\n"
+        "number=42\n";
+
+    /* Measure the memory a heap context needs for the data */
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_string(ctx, ini_data) == DMINI_OK, "Failed to parse string");
+    size_t needed = dmini_memory_usage(ctx);
+    TEST_ASSERT(needed > 0, "Memory usage should be reported");
+    dmini_destroy(ctx);
+
+    /* Caller-provided arena of exactly that size holds the same content */
+    static unsigned long long storage[256];
+    TEST_ASSERT(needed <= sizeof(storage), "Test storage too small");
+    ctx = dmini_create_with_arena(storage, needed);
+    TEST_ASSERT(ctx != NULL, "Failed to create arena context");
+    TEST_ASSERT(dmini_parse_string(ctx, ini_data) == DMINI_OK, "Failed to parse into arena");
+    TEST_ASSERT(dmini_memory_usage(ctx) == needed, "Arena usage should match heap usage");
+    TEST_ASSERT(dmini_get_int(ctx, "section2", "number", 0) == 42, "Wrong value from arena");
+    TEST_ASSERT(strcmp(dmini_get_string(ctx, "section1", "key2", ""), "value2") == 0,
+                "Wrong string from arena");
+
+    /* A full caller arena reports an error instead of allocating */
+    TEST_ASSERT(dmini_set_string(ctx, "section3", "key", "value") == DMINI_ERR_MEMORY,
+                "Full arena should report DMINI_ERR_MEMORY");
+    TEST_ASSERT(dmini_get_int(ctx, "section2", "number", 0) == 42, "Content intact after failure");
+    dmini_destroy(ctx);
+
+    /* Too small buffer is rejected */
+    TEST_ASSERT(dmini_create_with_arena(storage, 8) == NULL, "Tiny arena should be rejected");
+
+    /* Internally grown arena */
+    ctx = dmini_create_with_arena(NULL, 128);
+    TEST_ASSERT(ctx != NULL, "Failed to create growing arena context");
+    char key[16];
+    for (int i = 0; i < 100; i++)
+    {
+        Dmod_SnPrintf(key, sizeof(key), "key%d", i);
+        TEST_ASSERT(dmini_set_int(ctx, "grow", key, i) == DMINI_OK, "Failed to set in growing arena");
+    }
+    TEST_ASSERT(dmini_get_int(ctx, "grow", "key99", -1) == 99, "Wrong value in growing arena");
+    TEST_ASSERT(dmini_memory_usage(ctx) > 128, "Growing arena should have added blocks");
+    dmini_destroy(ctx);
+
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: In-place parsing borrows strings from the buffer
+ */
+static void test_parse_inplace(void)
+{
+    TEST_START("Parse buffer in place");
+
+    char buffer[] =
+        "global_key = global_value ; comment\n"
+        "[section1]\r\n"
+        "key1=value1\n"
+        "key2 = value2\n"
+        "[section1]\n"
+        "last=tail";
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+
+    int result = dmini_parse_buffer_inplace(ctx, buffer, sizeof(buffer) - 1);
+    TEST_ASSERT(result == DMINI_OK, "Failed to parse buffer in place");
+
+    const char* val = dmini_get_string(ctx, NULL, "global_key", "");
+    TEST_ASSERT(strcmp(val, "global_value") == 0, "Wrong global value");
+    TEST_ASSERT(val >= buffer && val < buffer + sizeof(buffer), "Value should point into the buffer");
+
+    val = dmini_get_string(ctx, "section1", "key2", "");
+    TEST_ASSERT(strcmp(val, "value2") == 0, "Wrong section1/key2 value");
+    TEST_ASSERT(val >= buffer && val < buffer + sizeof(buffer), "Value should point into the buffer");
+
+    /* The last value ends the buffer and has no room for a terminator */
+    val = dmini_get_string(ctx, "section1", "last", "");
+    TEST_ASSERT(strcmp(val, "tail") == 0, "Wrong value at end of buffer");
+    TEST_ASSERT(dmini_section_count(ctx) == 2, "Duplicate section header should merge");
+
+    /* Overwriting copies the new value and leaves the buffer alone */
+    result = dmini_set_string(ctx, "section1", "key1", "a much longer replacement value");
+    TEST_ASSERT(result == DMINI_OK, "Failed to overwrite borrowed value");
+    val = dmini_get_string(ctx, "section1", "key1", "");
+    TEST_ASSERT(strcmp(val, "a much longer replacement value") == 0, "Wrong overwritten value");
+    TEST_ASSERT(val < buffer || val >= buffer + sizeof(buffer), "New value should not be in the buffer");
+    TEST_ASSERT(strcmp(dmini_get_string(ctx, "section1", "key2", ""), "value2") == 0,
+                "Neighbouring value must be intact");
+
+    /* Borrowed entries can be removed */
+    TEST_ASSERT(dmini_remove_key(ctx, "section1", "key2") == DMINI_OK, "Failed to remove borrowed key");
+    TEST_ASSERT(dmini_remove_section(ctx, "section1") == DMINI_OK, "Failed to remove borrowed section");
+
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Parse a length-delimited memory range
+ */
+static void test_parse_memory(void)
+{
+    TEST_START("Parse memory range");
+
+    /* Only the first part of the blob belongs to the config */
+    static const char blob[] =
+        "[net]\n"
+        "address=10.0.0.1\n"
+        "port=8080"
+        "[garbage]\n"
+        "key=value\n";
+    size_t len = strlen("[net]\naddress=10.0.0.1\nport=8080");
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+
+    int result = dmini_parse_memory(ctx, blob, len);
+    TEST_ASSERT(result == DMINI_OK, "Failed to parse memory range");
+    TEST_ASSERT(strcmp(dmini_get_string(ctx, "net", "address", ""), "10.0.0.1") == 0, "Wrong address");
+    TEST_ASSERT(dmini_get_int(ctx, "net", "port", 0) == 8080, "Value must end at the range end");
+    TEST_ASSERT(dmini_has_section(ctx, "garbage") == 0, "Data past the range must be ignored");
+
+    /* Empty range is valid */
+    TEST_ASSERT(dmini_parse_memory(ctx, NULL, 0) == DMINI_OK, "Empty range should succeed");
+    TEST_ASSERT(dmini_parse_memory(ctx, NULL, 1) == DMINI_ERR_INVALID, "NULL data should be rejected");
+
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Chunked parsing with lines split across chunks
+ */
+static void test_parse_chunked(void)
+{
+    TEST_START("Parse in chunks");
+
+    const char* ini_data =
+        "global_key=global_value\r\n"
+        "[section1]\r\n"
+        "key1 = a value that is split across several chunks ; comment\r\n"
+        "\r\n"
+        "[section2]\n"
+        "number=42";
+    size_t len = strlen(ini_data);
+
+    /* Every chunk size must produce the same result */
+    for (size_t chunk = 1; chunk <= len; chunk += 3)
+    {
+        dmini_context_t ctx = dmini_create();
+        TEST_ASSERT(ctx != NULL, "Failed to create context");
+        TEST_ASSERT(dmini_parse_begin(ctx) == DMINI_OK, "Failed to begin chunked parse");
+        TEST_ASSERT(dmini_parse_begin(ctx) == DMINI_ERR_INVALID, "Nested begin should be rejected");
+
+        for (size_t pos = 0; pos < len; pos += chunk)
+        {
+            size_t n = (len - pos < chunk) ? len - pos : chunk;
+            TEST_ASSERT(dmini_parse_feed(ctx, ini_data + pos, n) == DMINI_OK, "Failed to feed chunk");
+        }
+        TEST_ASSERT(dmini_parse_end(ctx) == DMINI_OK, "Failed to end chunked parse");
+
+        TEST_ASSERT(strcmp(dmini_get_string(ctx, NULL, "global_key", ""), "global_value") == 0,
+                    "Wrong global value");
+        TEST_ASSERT(strcmp(dmini_get_string(ctx, "section1", "key1", ""),
+                           "a value that is split across several chunks") == 0,
+                    "Wrong split value");
+        TEST_ASSERT(dmini_key_count(ctx, "section1") == 1, "Blank line must not create keys");
+        TEST_ASSERT(dmini_get_int(ctx, "section2", "number", 0) == 42, "Unterminated last line lost");
+        dmini_destroy(ctx);
+    }
+
+    /* Feed without begin is rejected */
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_feed(ctx, "a=b", 3) == DMINI_ERR_INVALID, "Feed without begin should fail");
+    TEST_ASSERT(dmini_parse_end(ctx) == DMINI_ERR_INVALID, "End without begin should fail");
+
+    /* A context can be destroyed in the middle of a chunked parse */
+    TEST_ASSERT(dmini_parse_begin(ctx) == DMINI_OK, "Failed to begin chunked parse");
+    TEST_ASSERT(dmini_parse_feed(ctx, "key=unfinished", 14) == DMINI_OK, "Failed to feed chunk");
+    dmini_destroy(ctx);
+
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Block-buffered file parsing with long lines
+ */
+static void test_file_long_lines(void)
+{
+    TEST_START("Parse file with long lines");
+
+    const char* test_file = "/tmp/test_dmini_long.ini";
+    char long_value[600];
+    for (size_t i = 0; i < sizeof(long_value) - 1; i++)
+    {
+        long_value[i] = (char)('a' + (i % 26));
+    }
+    long_value[sizeof(long_value) - 1] = '\0';
+
+    void* file = Dmod_FileOpen(test_file, "w");
+    TEST_ASSERT(file != NULL, "Failed to create test file");
+    const char* head = "[section1]\r\nlong=";
+    Dmod_FileWrite(head, 1, strlen(head), file);
+    Dmod_FileWrite(long_value, 1, strlen(long_value), file);
+    const char* tail = "\r\nafter=1\r\n[section2]\nlast=2";
+    Dmod_FileWrite(tail, 1, strlen(tail), file);
+    Dmod_FileClose(file);
+
+    /* Small blocks force lines to be split across reads */
+    size_t sizes[] = { 7, 64, 0 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        dmini_context_t ctx = dmini_create();
+        TEST_ASSERT(ctx != NULL, "Failed to create context");
+        TEST_ASSERT(dmini_set_io_buffer_size(ctx, sizes[i]) == DMINI_OK, "Failed to set buffer size");
+
+        int result = dmini_parse_file(ctx, test_file);
+        TEST_ASSERT(result == DMINI_OK, "Failed to parse file");
+        TEST_ASSERT(strcmp(dmini_get_string(ctx, "section1", "long", ""), long_value) == 0,
+                    "Long line was not read completely");
+        TEST_ASSERT(dmini_get_int(ctx, "section1", "after", 0) == 1, "Line after long line lost");
+        TEST_ASSERT(dmini_get_int(ctx, "section2", "last", 0) == 2, "Unterminated last line lost");
+        TEST_ASSERT(dmini_key_count(ctx, "section1") == 2, "Long line must not be split into keys");
+        dmini_destroy(ctx);
+    }
+
+    Dmod_FileRemove(test_file);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Buffered file generation with long lines
+ */
+static void test_generate_file_buffered(void)
+{
+    TEST_START("Generate file with long lines");
+
+    const char* output_file = "/tmp/test_dmini_generated.ini";
+    char long_value[700];
+    for (size_t i = 0; i < sizeof(long_value) - 1; i++)
+    {
+        long_value[i] = (char)('A' + (i % 26));
+    }
+    long_value[sizeof(long_value) - 1] = '\0';
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    dmini_set_string(ctx, NULL, "global", "value");
+    dmini_set_string(ctx, "section1", "long", long_value);
+    dmini_set_int(ctx, "section2", "number", 42);
+
+    int size = dmini_generate_string(ctx, NULL, 0);
+    TEST_ASSERT(size > 0, "Failed to get required size");
+    char* expected = (char*)Dmod_Malloc(size);
+    char* actual = (char*)Dmod_Malloc(size + 1);
+    TEST_ASSERT(expected != NULL && actual != NULL, "Failed to allocate buffers");
+    TEST_ASSERT(dmini_generate_string(ctx, expected, size) == size, "Failed to generate string");
+
+    /* A buffer smaller than a single line must still produce the whole file */
+    TEST_ASSERT(dmini_set_io_buffer_size(ctx, 16) == DMINI_OK, "Failed to set buffer size");
+    TEST_ASSERT(dmini_generate_file(ctx, output_file) == DMINI_OK, "Failed to generate file");
+
+    void* file = Dmod_FileOpen(output_file, "r");
+    TEST_ASSERT(file != NULL, "Output file not created");
+    size_t read = Dmod_FileRead(actual, 1, size, file);
+    Dmod_FileClose(file);
+    TEST_ASSERT(read == (size_t)size - 1, "File size differs from generated string");
+    actual[read] = '\0';
+    TEST_ASSERT(strcmp(actual, expected) == 0, "File content differs from generated string");
+
+    /* Round trip */
+    dmini_context_t copy = dmini_create();
+    TEST_ASSERT(copy != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_file(copy, output_file) == DMINI_OK, "Failed to parse generated file");
+    TEST_ASSERT(strcmp(dmini_get_string(copy, "section1", "long", ""), long_value) == 0,
+                "Long value lost in round trip");
+    TEST_ASSERT(dmini_get_int(copy, "section2", "number", 0) == 42, "Value lost in round trip");
+
+    dmini_destroy(copy);
+    Dmod_Free(actual);
+    Dmod_Free(expected);
+    Dmod_FileRemove(output_file);
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Check that the size query matches the generated text
+ */
+static int generated_size_matches(dmini_context_t ctx)
+{
+    static char buffer[512];
+    int size = dmini_generate_string(ctx, NULL, 0);
+    if (size <= 0 || size > (int)sizeof(buffer))
+    {
+        return 0;
+    }
+    return dmini_generate_string(ctx, buffer, size) == size && (int)strlen(buffer) + 1 == size;
+}
+
+/**
+ * @brief Test: Cached serialized size follows every modification
+ */
+static void test_generate_size_tracking(void)
+{
+    TEST_START("Track generated size across modifications");
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_generate_string(ctx, NULL, 0) == 1, "Empty context needs only a terminator");
+
+    TEST_ASSERT(dmini_parse_string(ctx, "g=1\n[a]\nx=1\ny=22\n[b]\nz=333\n") == DMINI_OK,
+                "Failed to parse string");
+    TEST_ASSERT(generated_size_matches(ctx), "Size wrong after parse");
+
+    dmini_set_string(ctx, "a", "x", "a longer value than before");
+    TEST_ASSERT(generated_size_matches(ctx), "Size wrong after growing a value");
+    dmini_set_string(ctx, "a", "x", "");
+    TEST_ASSERT(generated_size_matches(ctx), "Size wrong after shrinking a value");
+    dmini_set_int(ctx, "c", "new", -17);
+    TEST_ASSERT(generated_size_matches(ctx), "Size wrong after adding a section");
+    dmini_remove_key(ctx, "a", "y");
+    TEST_ASSERT(generated_size_matches(ctx), "Size wrong after removing a key");
+    dmini_remove_section(ctx, "c");
+    TEST_ASSERT(generated_size_matches(ctx), "Size wrong after removing the last section");
+
+    dmini_set_active_section(ctx, "a", 0);
+    TEST_ASSERT(generated_size_matches(ctx), "Size wrong for a restricted middle section");
+    dmini_set_active_section(ctx, "b", 0);
+    TEST_ASSERT(generated_size_matches(ctx), "Size wrong for a restricted last section");
+    dmini_set_active_section(ctx, NULL, 0);
+    TEST_ASSERT(generated_size_matches(ctx), "Size wrong for the restricted global section");
+    dmini_set_active_section(ctx, "missing", 0);
+    TEST_ASSERT(dmini_generate_string(ctx, NULL, 0) == 1, "Missing active section generates nothing");
+    dmini_clear_active_section(ctx, 0);
+
+    dmini_remove_section(ctx, "a");
+    dmini_remove_section(ctx, "b");
+    TEST_ASSERT(generated_size_matches(ctx), "Size wrong with only the global section left");
+
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Appending after removing the last section or key
+ */
+static void test_append_after_remove(void)
+{
+    TEST_START("Append after removing tail entries");
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+
+    TEST_ASSERT(dmini_parse_string(ctx, "[a]\nx=1\ny=2\n[b]\nz=3\n") == DMINI_OK,
+                "Failed to parse string");
+
+    /* Remove the last key and section, then append new ones in their place */
+    TEST_ASSERT(dmini_remove_key(ctx, "a", "y") == DMINI_OK, "Failed to remove last key");
+    TEST_ASSERT(dmini_set_string(ctx, "a", "w", "4") == DMINI_OK, "Failed to append key");
+    TEST_ASSERT(dmini_remove_section(ctx, "b") == DMINI_OK, "Failed to remove last section");
+    TEST_ASSERT(dmini_set_string(ctx, "c", "v", "5") == DMINI_OK, "Failed to append section");
+
+    /* Empty a section completely and refill it */
+    TEST_ASSERT(dmini_remove_key(ctx, "c", "v") == DMINI_OK, "Failed to remove only key");
+    TEST_ASSERT(dmini_set_string(ctx, "c", "u", "6") == DMINI_OK, "Failed to refill section");
+
+    char buffer[128];
+    TEST_ASSERT(dmini_generate_string(ctx, buffer, sizeof(buffer)) > 0, "Failed to generate string");
+    TEST_ASSERT(strcmp(buffer, "[a]\nx=1\nw=4\n\n[c]\nu=6\n") == 0, "Entries not appended in order");
+
+    /* Many keys in one section keep their insertion order */
+    char key[16];
+    for (int i = 0; i < 500; i++)
+    {
+        Dmod_SnPrintf(key, sizeof(key), "k%d", i);
+        TEST_ASSERT(dmini_set_int(ctx, "big", key, i) == DMINI_OK, "Failed to set key");
+    }
+    TEST_ASSERT(strcmp(dmini_key_name(ctx, "big", 0), "k0") == 0, "First key out of order");
+    TEST_ASSERT(strcmp(dmini_key_name(ctx, "big", 499), "k499") == 0, "Last key out of order");
+
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Pre-resolved key handles
+ */
+static void test_handles(void)
+{
+    TEST_START("Read keys through handles");
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_string(ctx, "top=1\n[pid]\nkp=12\nki=3\n[other]\nx=y\n") == DMINI_OK,
+                "Failed to parse string");
+
+    dmini_handle_t kp = dmini_lookup(ctx, "pid", "kp");
+    dmini_handle_t top = dmini_lookup(ctx, NULL, "top");
+    dmini_handle_t missing = dmini_lookup(ctx, "pid", "kd");
+    TEST_ASSERT(dmini_handle_valid(ctx, kp), "Handle to existing key is invalid");
+    TEST_ASSERT(!dmini_handle_valid(ctx, missing), "Handle to missing key is valid");
+    TEST_ASSERT(dmini_handle_get_int(ctx, kp, -1) == 12, "Wrong value through handle");
+    TEST_ASSERT(dmini_handle_get_int(ctx, top, -1) == 1, "Wrong global value through handle");
+    TEST_ASSERT(dmini_handle_get_int(ctx, missing, -1) == -1, "Missing key should give default");
+
+    /* Updates are visible through the handle */
+    dmini_set_int(ctx, "pid", "kp", 40);
+    TEST_ASSERT(dmini_handle_get_int(ctx, kp, -1) == 40, "Handle does not see updated value");
+    TEST_ASSERT(strcmp(dmini_handle_get_string(ctx, kp, ""), "40") == 0, "Wrong string through handle");
+    dmini_set_string(ctx, "pid", "new", "v");
+    TEST_ASSERT(dmini_handle_valid(ctx, kp), "Adding a key invalidated the handle");
+
+    /* Removals invalidate handles */
+    dmini_remove_key(ctx, "pid", "ki");
+    TEST_ASSERT(!dmini_handle_valid(ctx, kp), "Removing a key did not invalidate the handle");
+    TEST_ASSERT(dmini_handle_get_int(ctx, kp, -1) == -1, "Stale handle should give default");
+    kp = dmini_lookup(ctx, "pid", "kp");
+    TEST_ASSERT(dmini_handle_get_int(ctx, kp, -1) == 40, "Re-resolved handle is wrong");
+    dmini_remove_section(ctx, "other");
+    TEST_ASSERT(dmini_handle_get_string(ctx, kp, NULL) == NULL, "Removing a section did not invalidate the handle");
+
+    /* Changing the active section invalidates handles */
+    kp = dmini_lookup(ctx, "pid", "kp");
+    dmini_set_active_section(ctx, "pid", 0);
+    TEST_ASSERT(!dmini_handle_valid(ctx, kp), "Activating a section did not invalidate the handle");
+    kp = dmini_lookup(ctx, NULL, "kp");
+    TEST_ASSERT(dmini_handle_get_int(ctx, kp, -1) == 40, "Lookup under active section failed");
+    dmini_clear_active_section(ctx, 0);
+    TEST_ASSERT(!dmini_handle_valid(ctx, kp), "Clearing the active section did not invalidate the handle");
+
+    TEST_ASSERT(!dmini_handle_valid(NULL, kp), "Handle valid without a context");
+
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Typed getters
+ */
+static void test_typed_values(void)
+{
+    TEST_START("Typed getters and cached values");
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+
+    const char* ini_data =
+        "[types]\n"
+        "dec=-42\n"
+        "hex=0x1F\n"
+        "neghex=-0Xff\n"
+        "big=9000000000\n"
+        "pi=3.14159\n"
+        "small=-2.5e-3\n"
+        "frac=.5\n"
+        "yes=Yes\n"
+        "off=OFF\n"
+        "bad=maybe\n";
+    TEST_ASSERT(dmini_parse_string(ctx, ini_data) == DMINI_OK, "Failed to parse string");
+
+    TEST_ASSERT(dmini_get_int(ctx, "types", "dec", 0) == -42, "Wrong decimal value");
+    TEST_ASSERT(dmini_get_int(ctx, "types", "hex", 0) == 31, "Wrong hex value");
+    TEST_ASSERT(dmini_get_int(ctx, "types", "neghex", 0) == -255, "Wrong negative hex value");
+    TEST_ASSERT(dmini_get_int64(ctx, "types", "big", 0) == 9000000000LL, "Wrong 64-bit value");
+    TEST_ASSERT(dmini_get_int64(ctx, "types", "missing", -7) == -7, "Missing int64 should give default");
+
+    float pi = dmini_get_float(ctx, "types", "pi", 0.0f);
+    TEST_ASSERT(pi > 3.14158f && pi < 3.14160f, "Wrong float value");
+    float small = dmini_get_float(ctx, "types", "small", 0.0f);
+    TEST_ASSERT(small < -0.00249f && small > -0.00251f, "Wrong float with exponent");
+    TEST_ASSERT(dmini_get_float(ctx, "types", "frac", 0.0f) == 0.5f, "Wrong float without integer part");
+    TEST_ASSERT(dmini_get_float(ctx, "types", "hex", 0.0f) == 31.0f, "Wrong float from hex");
+    TEST_ASSERT(dmini_get_float(ctx, "types", "missing", 1.5f) == 1.5f, "Missing float should give default");
+
+    TEST_ASSERT(dmini_get_bool(ctx, "types", "yes", 0) == 1, "Wrong true value");
+    TEST_ASSERT(dmini_get_bool(ctx, "types", "off", 1) == 0, "Wrong false value");
+    TEST_ASSERT(dmini_get_bool(ctx, "types", "bad", 5) == 5, "Invalid boolean should give default");
+    TEST_ASSERT(dmini_get_bool(ctx, "types", "missing", 5) == 5, "Missing boolean should give default");
+
+    /* Reading another type after a cached read converts again */
+    TEST_ASSERT(dmini_get_int(ctx, "types", "pi", 0) == 3, "Int after float read is wrong");
+    TEST_ASSERT(dmini_get_float(ctx, "types", "dec", 0.0f) == -42.0f, "Float after int read is wrong");
+
+    /* Updates invalidate the cached value */
+    TEST_ASSERT(dmini_get_int(ctx, "types", "dec", 0) == -42, "Wrong cached value");
+    dmini_set_string(ctx, "types", "dec", "0x10");
+    TEST_ASSERT(dmini_get_int(ctx, "types", "dec", 0) == 16, "Cached value not invalidated");
+    dmini_set_int(ctx, "types", "dec", -2147483647 - 1);
+    TEST_ASSERT(dmini_get_int(ctx, "types", "dec", 0) == -2147483647 - 1, "Wrong value after set_int");
+    TEST_ASSERT(strcmp(dmini_get_string(ctx, "types", "dec", ""), "-2147483648") == 0, "Wrong string after set_int");
+    dmini_set_string(ctx, "types", "dec", "true");
+    TEST_ASSERT(dmini_get_bool(ctx, "types", "dec", 0) == 1, "Boolean after set_int is wrong");
+    TEST_ASSERT(dmini_get_int(ctx, "types", "dec", 9) == 0, "Non-numeric value should convert to 0");
+
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Iterators over sections and pairs
+ */
+static void test_iterators(void)
+{
+    TEST_START("Iterate with cursors");
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_string(ctx, "g=0\n[a]\nx=1\ny=22\n[b]\nz=333\n") == DMINI_OK,
+                "Failed to parse string");
+
+    /* Sections in order, global first */
+    dmini_iter_t iter;
+    const char* name = "unset";
+    size_t name_len = 99;
+    TEST_ASSERT(dmini_iter_sections(ctx, &iter) == DMINI_OK, "Failed to start section iteration");
+    TEST_ASSERT(dmini_next_section(&iter, &name, &name_len) == 1 && name == NULL && name_len == 0,
+                "First section should be global");
+    TEST_ASSERT(dmini_next_section(&iter, &name, &name_len) == 1 && strcmp(name, "a") == 0 && name_len == 1,
+                "Second section should be a");
+    TEST_ASSERT(dmini_next_section(&iter, &name, NULL) == 1 && strcmp(name, "b") == 0,
+                "Third section should be b");
+    TEST_ASSERT(dmini_next_section(&iter, &name, NULL) == 0, "Iteration should end after b");
+
+    /* Pairs with values and lengths */
+    dmini_entry_t entry;
+    TEST_ASSERT(dmini_iter_pairs(ctx, "a", &iter) == DMINI_OK, "Failed to start pair iteration");
+    TEST_ASSERT(dmini_next_pair(&iter, &entry) == 1, "Missing first pair");
+    TEST_ASSERT(strcmp(entry.key, "x") == 0 && strcmp(entry.value, "1") == 0 &&
+                entry.key_len == 1 && entry.value_len == 1, "Wrong first pair");
+    TEST_ASSERT(dmini_next_pair(&iter, &entry) == 1, "Missing second pair");
+    TEST_ASSERT(strcmp(entry.key, "y") == 0 && entry.value_len == 2, "Wrong second pair");
+    TEST_ASSERT(dmini_next_pair(&iter, &entry) == 0, "Iteration should end after y");
+    TEST_ASSERT(dmini_iter_pairs(ctx, "missing", &iter) == DMINI_ERR_NOT_FOUND, "Missing section should fail");
+    TEST_ASSERT(dmini_next_pair(&iter, &entry) == 0, "Iterator over missing section should be empty");
+
+    /* Removal ends the iteration */
+    dmini_iter_pairs(ctx, "a", &iter);
+    dmini_remove_key(ctx, "b", "z");
+    TEST_ASSERT(dmini_next_pair(&iter, &entry) == 0, "Removal should end the iteration");
+
+    /* Active-section restriction */
+    dmini_set_active_section(ctx, "a", 0);
+    dmini_iter_sections(ctx, &iter);
+    TEST_ASSERT(dmini_next_section(&iter, &name, NULL) == 1 && strcmp(name, "a") == 0,
+                "Only the active section should be visible");
+    TEST_ASSERT(dmini_next_section(&iter, &name, NULL) == 0, "Restricted iteration should end");
+    TEST_ASSERT(dmini_iter_pairs(ctx, NULL, &iter) == DMINI_OK, "Failed to iterate active section");
+    TEST_ASSERT(dmini_next_pair(&iter, &entry) == 1 && strcmp(entry.key, "x") == 0,
+                "Wrong pair in active section");
+    TEST_ASSERT(dmini_section_count(ctx) == 1, "Wrong restricted section count");
+    dmini_clear_active_section(ctx, 0);
+
+    /* Index-based access in any order still returns the right names */
+    char key[16];
+    for (int i = 0; i < 100; i++)
+    {
+        Dmod_SnPrintf(key, sizeof(key), "k%d", i);
+        dmini_set_int(ctx, "big", key, i);
+    }
+    TEST_ASSERT(strcmp(dmini_key_name(ctx, "big", 50), "k50") == 0, "Wrong key at 50");
+    TEST_ASSERT(strcmp(dmini_key_name(ctx, "big", 51), "k51") == 0, "Wrong key at 51");
+    TEST_ASSERT(strcmp(dmini_key_name(ctx, "big", 10), "k10") == 0, "Wrong key walking backwards");
+    TEST_ASSERT(strcmp(dmini_key_name(ctx, "a", 1), "y") == 0, "Wrong key in another section");
+    TEST_ASSERT(dmini_key_name(ctx, "big", 100) == NULL, "Out of range key should be NULL");
+    TEST_ASSERT(strcmp(dmini_section_name(ctx, 3), "big") == 0, "Wrong section at 3");
+    TEST_ASSERT(strcmp(dmini_section_name(ctx, 1), "a") == 0, "Wrong section walking backwards");
+    dmini_remove_section(ctx, "a");
+    TEST_ASSERT(strcmp(dmini_section_name(ctx, 1), "b") == 0, "Cursor not reset after removal");
+    TEST_ASSERT(strcmp(dmini_key_name(ctx, "big", 51), "k51") == 0, "Wrong key after removal");
+
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Batch getter
+ */
+static void test_get_batch(void)
+{
+    TEST_START("Get many values in one call");
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+
+    /* More keys than the index threshold, queried out of order */
+    char key[16];
+    for (int i = 0; i < 20; i++)
+    {
+        Dmod_SnPrintf(key, sizeof(key), "k%d", i);
+        dmini_set_int(ctx, "pid", key, i * 10);
+    }
+    TEST_ASSERT(dmini_parse_string(ctx, "[pid]\nlimit=2.5\nmode=manual\nen=on\nbig=0x100000000\n") == DMINI_OK,
+                "Failed to parse string");
+
+    int k3 = 0, k19 = 0, k0 = 0, missing = 0, en = 0, nobool = 0;
+    int64_t big = 0;
+    float limit = 0.0f;
+    const char* mode = NULL;
+    const char* other = NULL;
+    dmini_query_t queries[] = {
+        { "k3",      DMINI_TYPE_INT,    { .i = -1 },     &k3 },
+        { "limit",   DMINI_TYPE_FLOAT,  { .f = 0.0f },   &limit },
+        { "k19",     DMINI_TYPE_INT,    { .i = -1 },     &k19 },
+        { "k0",      DMINI_TYPE_INT,    { .i = -1 },     &k0 },
+        { "mode",    DMINI_TYPE_STRING, { .s = "auto" }, &mode },
+        { "nothere", DMINI_TYPE_INT,    { .i = 77 },     &missing },
+        { "nothere", DMINI_TYPE_STRING, { .s = "dflt" }, &other },
+        { "en",      DMINI_TYPE_BOOL,   { .i = 0 },      &en },
+        { "mode",    DMINI_TYPE_BOOL,   { .i = 5 },      &nobool },
+        { "big",     DMINI_TYPE_INT64,  { .i64 = 0 },    &big },
+        { "k5",      DMINI_TYPE_INT,    { .i = 0 },      NULL },
+    };
+    size_t count = sizeof(queries) / sizeof(queries[0]);
+
+    TEST_ASSERT(dmini_get_batch(ctx, "pid", queries, count) == 9, "Wrong number of keys found");
+    TEST_ASSERT(k3 == 30 && k19 == 190 && k0 == 0, "Wrong integer values");
+    TEST_ASSERT(limit == 2.5f, "Wrong float value");
+    TEST_ASSERT(mode && strcmp(mode, "manual") == 0, "Wrong string value");
+    TEST_ASSERT(missing == 77 && strcmp(other, "dflt") == 0, "Missing keys should get defaults");
+    TEST_ASSERT(en == 1 && nobool == 5, "Wrong boolean values");
+    TEST_ASSERT(big == 0x100000000LL, "Wrong 64-bit value");
+
+    /* Missing section fills every output with its default */
+    TEST_ASSERT(dmini_get_batch(ctx, "none", queries, count) == 0, "Missing section should find nothing");
+    TEST_ASSERT(k3 == -1 && limit == 0.0f && strcmp(mode, "auto") == 0, "Defaults not applied");
+
+    /* Small section without an index, queried in reverse order */
+    dmini_parse_string(ctx, "[small]\na=1\nb=2\nc=3\n");
+    int a = 0, b = 0, c = 0;
+    dmini_query_t small[] = {
+        { "c", DMINI_TYPE_INT, { .i = 0 }, &c },
+        { "b", DMINI_TYPE_INT, { .i = 0 }, &b },
+        { "a", DMINI_TYPE_INT, { .i = 0 }, &a },
+    };
+    TEST_ASSERT(dmini_get_batch(ctx, "small", small, 3) == 3, "Reverse-order batch missed keys");
+    TEST_ASSERT(a == 1 && b == 2 && c == 3, "Wrong reverse-order values");
+
+    TEST_ASSERT(dmini_get_batch(NULL, "pid", queries, count) == DMINI_ERR_INVALID, "NULL context should fail");
+    TEST_ASSERT(dmini_get_batch(ctx, "pid", NULL, 0) == 0, "Empty batch should succeed");
+
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Concurrent mode keeps retired memory alive for readers
+ */
+static void test_concurrency(void)
+{
+    TEST_START("Concurrent mode read-side sections");
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    /* DMINI_ERR_GENERAL means the module was built without concurrency support;
+     * the sequence below must then behave the same way */
+    int result = dmini_enable_concurrency(ctx);
+    TEST_ASSERT(result == DMINI_OK || result == DMINI_ERR_GENERAL, "Failed to enable concurrency");
+    TEST_ASSERT(dmini_enable_concurrency(ctx) == result, "Enabling twice should give the same result");
+    TEST_ASSERT(dmini_parse_string(ctx, "[cfg]\nmode=first\ngain=3\n[tmp]\nx=1\n") == DMINI_OK,
+                "Failed to parse string");
+
+    /* A reader keeps the old value while a writer replaces it */
+    unsigned int token = dmini_read_begin(ctx);
+    const char* mode = dmini_get_string(ctx, "cfg", "mode", NULL);
+    const char* x = dmini_get_string(ctx, "tmp", "x", NULL);
+    TEST_ASSERT(mode && strcmp(mode, "first") == 0, "Wrong value before update");
+    TEST_ASSERT(dmini_set_string(ctx, "cfg", "mode", "second") == DMINI_OK, "Failed to update value");
+    TEST_ASSERT(dmini_remove_section(ctx, "tmp") == DMINI_OK, "Failed to remove section");
+    for (int i = 0; i < 4; i++)
+    {
+        dmini_set_int(ctx, "cfg", "gain", i);
+    }
+    if (result == DMINI_OK)
+    {
+        TEST_ASSERT(strcmp(mode, "first") == 0, "Old value reclaimed while a reader was active");
+        TEST_ASSERT(strcmp(x, "1") == 0, "Removed section reclaimed while a reader was active");
+    }
+    TEST_ASSERT(strcmp(dmini_get_string(ctx, "cfg", "mode", ""), "second") == 0, "New value not visible");
+    TEST_ASSERT(!dmini_has_section(ctx, "tmp"), "Removed section still visible");
+    dmini_read_end(ctx, token);
+
+    /* Later writes reclaim what readers no longer use */
+    for (int i = 0; i < 4; i++)
+    {
+        dmini_set_int(ctx, "cfg", "gain", 10 + i);
+    }
+    TEST_ASSERT(dmini_get_int(ctx, "cfg", "gain", 0) == 13, "Wrong value after updates");
+
+    /* Iteration, handles and generation still work */
+    dmini_handle_t gain = dmini_lookup(ctx, "cfg", "gain");
+    TEST_ASSERT(dmini_handle_get_int(ctx, gain, -1) == 13, "Wrong value through handle");
+    dmini_iter_t iter;
+    dmini_entry_t entry;
+    int count = 0;
+    dmini_iter_pairs(ctx, "cfg", &iter);
+    while (dmini_next_pair(&iter, &entry))
+    {
+        TEST_ASSERT(entry.value_len == strlen(entry.value), "Wrong value length");
+        count++;
+    }
+    TEST_ASSERT(count == 2, "Wrong number of pairs");
+    TEST_ASSERT(strcmp(dmini_key_name(ctx, "cfg", 1), "gain") == 0, "Wrong key name");
+
+    char buffer[64];
+    TEST_ASSERT(dmini_generate_string(ctx, buffer, sizeof(buffer)) > 0, "Failed to generate string");
+    TEST_ASSERT(strcmp(buffer, "[cfg]\nmode=second\ngain=13\n") == 0, "Wrong generated output");
+
+    /* Contexts without concurrency ignore read-side sections */
+    dmini_context_t plain = dmini_create();
+    TEST_ASSERT(plain != NULL, "Failed to create context");
+    token = dmini_read_begin(plain);
+    dmini_read_end(plain, token);
+    dmini_destroy(plain);
+
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Frozen snapshots answer every read API and reject writes
+ */
+static void test_freeze(void)
+{
+    TEST_START("Frozen snapshot");
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_string(ctx,
+                "version=3\n"
+                "[net]\nhost=example\nport=0x50\nratio=2.5\nenabled=yes\n"
+                "[empty]\n") == DMINI_OK, "Failed to parse string");
+    char key[16];
+    for (int i = 0; i < 40; i++)
+    {
+        Dmod_SnPrintf(key, sizeof(key), "key%d", i);
+        dmini_set_int(ctx, "big", key, i * 10);
+    }
+
+    char expected[1024];
+    int expected_size = dmini_generate_string(ctx, expected, sizeof(expected));
+    TEST_ASSERT(expected_size > 0, "Failed to generate source");
+
+    dmini_snapshot_t snap = dmini_freeze(ctx);
+    TEST_ASSERT(snap != NULL, "Failed to freeze context");
+
+    /* The snapshot is independent of its source */
+    dmini_set_string(ctx, "net", "host", "changed");
+    dmini_destroy(ctx);
+
+    TEST_ASSERT(dmini_get_int(snap, NULL, "version", 0) == 3, "Wrong global value");
+    TEST_ASSERT(strcmp(dmini_get_string(snap, "net", "host", ""), "example") == 0, "Wrong string value");
+    TEST_ASSERT(dmini_get_int(snap, "net", "port", 0) == 80, "Wrong hex value");
+    TEST_ASSERT(dmini_get_int64(snap, "big", "key39", 0) == 390, "Wrong int64 value");
+    TEST_ASSERT(dmini_get_float(snap, "net", "ratio", 0.0f) == 2.5f, "Wrong float value");
+    TEST_ASSERT(dmini_get_bool(snap, "net", "enabled", 0) == 1, "Wrong bool value");
+    TEST_ASSERT(strcmp(dmini_get_string(snap, "net", "missing", "def"), "def") == 0, "Missing key should give default");
+    TEST_ASSERT(dmini_get_int(snap, "nosuch", "port", -1) == -1, "Missing section should give default");
+    TEST_ASSERT(dmini_has_section(snap, "empty"), "Empty section missing");
+    TEST_ASSERT(dmini_has_section(snap, NULL), "Global section missing");
+    TEST_ASSERT(!dmini_has_section(snap, "nosuch"), "Unexpected section");
+    TEST_ASSERT(dmini_has_key(snap, "big", "key0") && !dmini_has_key(snap, "net", "key0"),
+                "Keys leak between sections");
+
+    TEST_ASSERT(dmini_section_count(snap) == 4, "Wrong section count");
+    TEST_ASSERT(dmini_section_name(snap, 0) == NULL, "Global section should come first");
+    TEST_ASSERT(strcmp(dmini_section_name(snap, 3), "big") == 0, "Wrong section order");
+    TEST_ASSERT(dmini_key_count(snap, "big") == 40, "Wrong key count");
+    TEST_ASSERT(dmini_key_count(snap, "nosuch") == DMINI_ERR_NOT_FOUND, "Missing section should not be found");
+    TEST_ASSERT(strcmp(dmini_key_name(snap, "net", 1), "port") == 0, "Wrong key order");
+    TEST_ASSERT(dmini_key_name(snap, "net", 4) == NULL, "Key index past the end");
+
+    int port = 0;
+    const char* host = NULL;
+    dmini_query_t queries[] = {
+        { "host", DMINI_TYPE_STRING, { .s = "" }, &host },
+        { "port", DMINI_TYPE_INT, { .i = 0 }, &port },
+        { "none", DMINI_TYPE_INT, { .i = 7 }, NULL },
+    };
+    TEST_ASSERT(dmini_get_batch(snap, "net", queries, 3) == 2, "Wrong batch result");
+    TEST_ASSERT(strcmp(host, "example") == 0 && port == 80, "Wrong batch values");
+
+    dmini_handle_t handle = dmini_lookup(snap, "big", "key7");
+    TEST_ASSERT(dmini_handle_valid(snap, handle), "Handle should be valid");
+    TEST_ASSERT(dmini_handle_get_int(snap, handle, -1) == 70, "Wrong value through handle");
+    TEST_ASSERT(!dmini_handle_valid(snap, dmini_lookup(snap, "big", "none")), "Missing key gave a handle");
+
+    dmini_iter_t iter;
+    dmini_entry_t entry;
+    const char* name;
+    size_t name_len;
+    int count = 0;
+    TEST_ASSERT(dmini_iter_sections(snap, &iter) == DMINI_OK, "Failed to iterate sections");
+    while (dmini_next_section(&iter, &name, &name_len))
+    {
+        count++;
+    }
+    TEST_ASSERT(count == 4, "Wrong number of iterated sections");
+    count = 0;
+    TEST_ASSERT(dmini_iter_pairs(snap, "net", &iter) == DMINI_OK, "Failed to iterate pairs");
+    while (dmini_next_pair(&iter, &entry))
+    {
+        TEST_ASSERT(entry.value_len == strlen(entry.value), "Wrong value length");
+        count++;
+    }
+    TEST_ASSERT(count == 4, "Wrong number of iterated pairs");
+    TEST_ASSERT(dmini_iter_pairs(snap, "empty", &iter) == DMINI_OK && !dmini_next_pair(&iter, &entry),
+                "Empty section should have no pairs");
+
+    char generated[1024];
+    TEST_ASSERT(dmini_generate_string(snap, NULL, 0) == expected_size, "Wrong generated size");
+    TEST_ASSERT(dmini_generate_string(snap, generated, sizeof(generated)) == expected_size, "Failed to generate");
+    TEST_ASSERT(strcmp(generated, expected) == 0, "Generated text differs from the source");
+
+    /* Writes are rejected */
+    TEST_ASSERT(dmini_set_string(snap, "net", "host", "x") == DMINI_ERR_READONLY, "Set should be rejected");
+    TEST_ASSERT(dmini_set_int(snap, "net", "port", 1) == DMINI_ERR_READONLY, "Set int should be rejected");
+    TEST_ASSERT(dmini_remove_key(snap, "net", "host") == DMINI_ERR_READONLY, "Remove should be rejected");
+    TEST_ASSERT(dmini_remove_section(snap, "net") == DMINI_ERR_READONLY, "Remove should be rejected");
+    TEST_ASSERT(dmini_parse_string(snap, "a=1\n") == DMINI_ERR_READONLY, "Parse should be rejected");
+    TEST_ASSERT(dmini_set_active_section(snap, "net", 0) == DMINI_ERR_READONLY, "Restriction should be rejected");
+    TEST_ASSERT(dmini_memory_usage(snap) > 0, "Snapshot memory not reported");
+
+    /* A snapshot of a snapshot and of a restricted context */
+    dmini_snapshot_t copy = dmini_freeze(snap);
+    TEST_ASSERT(copy != NULL && dmini_get_int(copy, "big", "key3", 0) == 30, "Failed to copy snapshot");
+    dmini_destroy(copy);
+    dmini_destroy(snap);
+
+    ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    dmini_parse_string(ctx, "g=1\n[a]\nx=1\n[b]\ny=2\n");
+    dmini_set_active_section(ctx, "b", 0);
+    dmini_generate_string(ctx, expected, sizeof(expected));
+    snap = dmini_freeze(ctx);
+    dmini_destroy(ctx);
+    TEST_ASSERT(snap != NULL, "Failed to freeze restricted context");
+    TEST_ASSERT(dmini_section_count(snap) == 1, "Restricted snapshot should hold one section");
+    TEST_ASSERT(dmini_get_int(snap, NULL, "y", 0) == 2, "NULL should refer to the active section");
+    TEST_ASSERT(dmini_get_int(snap, "b", "y", 0) == 2, "Active section not found by name");
+    TEST_ASSERT(!dmini_has_section(snap, "a"), "Hidden section leaked into snapshot");
+    dmini_generate_string(snap, generated, sizeof(generated));
+    TEST_ASSERT(strcmp(generated, expected) == 0, "Restricted snapshot generated different text");
+    dmini_destroy(snap);
+
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Binary images round-trip and corrupt images are rejected
+ */
+static void test_binary_image(void)
+{
+    TEST_START("Binary image export and open");
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_string(ctx,
+                "mode=auto\n[uart]\nbaud=115200\nparity=none\n[spi]\nclock=8000000\n") == DMINI_OK,
+                "Failed to parse string");
+
+    int size = dmini_export_binary(ctx, NULL, 0);
+    TEST_ASSERT(size > 0, "Failed to query image size");
+    TEST_ASSERT(dmini_export_binary(NULL, NULL, 0) == DMINI_ERR_INVALID, "NULL context should be rejected");
+
+    /* uint32_t storage keeps the image aligned */
+    uint32_t image[128];
+    TEST_ASSERT((size_t)size <= sizeof(image), "Image larger than expected");
+    TEST_ASSERT(dmini_export_binary(ctx, image, (size_t)size - 1) == DMINI_ERR_MEMORY, "Short buffer accepted");
+    TEST_ASSERT(dmini_export_binary(ctx, (char*)image + 1, sizeof(image) - 1) == DMINI_ERR_INVALID,
+                "Unaligned buffer accepted");
+    TEST_ASSERT(dmini_export_binary(ctx, image, sizeof(image)) == size, "Failed to export image");
+
+    char expected[256];
+    dmini_generate_string(ctx, expected, sizeof(expected));
+    dmini_destroy(ctx);
+
+    dmini_snapshot_t snap = dmini_open_binary(image, (size_t)size);
+    TEST_ASSERT(snap != NULL, "Failed to open image");
+    TEST_ASSERT(dmini_get_int(snap, "uart", "baud", 0) == 115200, "Wrong value");
+    TEST_ASSERT(strcmp(dmini_get_string(snap, NULL, "mode", ""), "auto") == 0, "Wrong global value");
+    const char* parity = dmini_get_string(snap, "uart", "parity", NULL);
+    TEST_ASSERT(parity >= (const char*)image && parity < (const char*)image + size,
+                "Strings should point into the image");
+    TEST_ASSERT(dmini_set_int(snap, "uart", "baud", 9600) == DMINI_ERR_READONLY, "Set should be rejected");
+
+    /* The opened image exports identically and generates the same text */
+    uint32_t copy[128];
+    TEST_ASSERT(dmini_export_binary(snap, copy, sizeof(copy)) == size, "Failed to re-export image");
+    TEST_ASSERT(memcmp(copy, image, (size_t)size) == 0, "Re-exported image differs");
+    char generated[256];
+    dmini_generate_string(snap, generated, sizeof(generated));
+    TEST_ASSERT(strcmp(generated, expected) == 0, "Generated text differs");
+    dmini_destroy(snap);
+
+    /* A frozen snapshot exports the same bytes */
+    ctx = dmini_open_binary(image, (size_t)size);
+    snap = dmini_freeze(ctx);
+    TEST_ASSERT(snap != NULL, "Failed to freeze an opened image");
+    TEST_ASSERT(dmini_export_binary(snap, copy, sizeof(copy)) == size && memcmp(copy, image, (size_t)size) == 0,
+                "Frozen copy exports different bytes");
+    dmini_destroy(snap);
+    dmini_destroy(ctx);
+
+    /* Truncated, misaligned or damaged images are rejected */
+    TEST_ASSERT(dmini_open_binary(NULL, 0) == NULL, "NULL image accepted");
+    TEST_ASSERT(dmini_open_binary(image, (size_t)size - 1) == NULL, "Truncated image accepted");
+    TEST_ASSERT(dmini_open_binary(image, 8) == NULL, "Header-only buffer accepted");
+    memcpy(copy, image, (size_t)size);
+    copy[0] ^= 1u;
+    TEST_ASSERT(dmini_open_binary(copy, (size_t)size) == NULL, "Bad magic accepted");
+    memcpy(copy, image, (size_t)size);
+    ((char*)copy)[size - 1] = 'x';
+    TEST_ASSERT(dmini_open_binary(copy, (size_t)size) == NULL, "Unterminated string accepted");
+    memcpy(copy, image, (size_t)size);
+    copy[12] = 0xFFFFu;
+    TEST_ASSERT(dmini_open_binary(copy, (size_t)size) == NULL, "Bad table offset accepted");
+
+    TEST_PASS();
+}
+
+/**
+ * @brief Read a whole file into a NUL-terminated buffer
+ */
+static int read_text_file(const char* filename, char* buffer, size_t size)
+{
+    void* file = Dmod_FileOpen(filename, "r");
+    if (!file)
+    {
+        return -1;
+    }
+    size_t read = Dmod_FileRead(buffer, 1, size - 1, file);
+    Dmod_FileClose(file);
+    buffer[read] = '\0';
+    return (int)read;
+}
+
+/**
+ * @brief Write a NUL-terminated string to a file
+ */
+static void write_text_file(const char* filename, const char* text)
+{
+    void* file = Dmod_FileOpen(filename, "w");
+    if (file)
+    {
+        Dmod_FileWrite(text, 1, strlen(text), file);
+        Dmod_FileClose(file);
+    }
+}
+
+/**
+ * @brief Check that a file parses back to the content of a context
+ */
+static int file_matches_context(const char* filename, dmini_context_t ctx)
+{
+    char expected[512];
+    char actual[512];
+    dmini_context_t copy = dmini_create();
+    if (!copy || dmini_parse_file(copy, filename) != DMINI_OK)
+    {
+        dmini_destroy(copy);
+        return 0;
+    }
+    dmini_generate_string(ctx, expected, sizeof(expected));
+    dmini_generate_string(copy, actual, sizeof(actual));
+    dmini_destroy(copy);
+    return strcmp(expected, actual) == 0;
+}
+
+/**
+ * @brief Test: Saving only the changed sections
+ */
+static void test_save_changes(void)
+{
+    TEST_START("Incremental save");
+
+    const char* file = "/tmp/test_dmini_changes.ini";
+    const char* other = "/tmp/test_dmini_changes_other.ini";
+    const char* initial = "[a]\nx=1\n\n[b]\ny=2\nw=value_long_enough_to_leave_room_for_two_records_before_compacting\n";
+    size_t initial_len = strlen(initial);
+    char text[512];
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_string(ctx, initial) == DMINI_OK, "Failed to parse string");
+
+    /* Without a synced file the whole content is written */
+    TEST_ASSERT(dmini_save_changes(ctx, file) == DMINI_OK, "Failed to save");
+    read_text_file(file, text, sizeof(text));
+    TEST_ASSERT(strcmp(text, initial) == 0, "Wrong initial file");
+
+    /* Nothing changed, nothing written; setting the same value changes nothing */
+    dmini_set_int(ctx, "a", "x", 1);
+    TEST_ASSERT(dmini_save_changes(ctx, file) == DMINI_OK, "Failed to save without changes");
+    read_text_file(file, text, sizeof(text));
+    TEST_ASSERT(strcmp(text, initial) == 0, "Unchanged file was written");
+
+    /* One changed key appends one small record, announced with its length and CRC */
+    dmini_set_int(ctx, "b", "y", 3);
+    TEST_ASSERT(dmini_save_changes(ctx, file) == DMINI_OK, "Failed to save change");
+    read_text_file(file, text, sizeof(text));
+    TEST_ASSERT(strncmp(text, initial, initial_len) == 0 &&
+                strcmp(text + initial_len, "\n;dmini-journal 00000009 b3d83a1f\n\n[b]\ny=3\n") == 0,
+                "Change was not appended");
+    TEST_ASSERT(file_matches_context(file, ctx), "File does not read back as the context");
+
+    /* New sections are appended as well */
+    dmini_set_string(ctx, "c", "z", "9");
+    TEST_ASSERT(dmini_save_changes(ctx, file) == DMINI_OK, "Failed to save new section");
+    read_text_file(file, text, sizeof(text));
+    TEST_ASSERT(strstr(text, "\n[b]\ny=3\n\n;dmini-journal 00000009 fdf576cf\n\n[c]\nz=9\n") != NULL,
+                "New section was not appended");
+    TEST_ASSERT(file_matches_context(file, ctx), "File does not read back as the context");
+
+    /* Removals and global keys cannot be appended and rewrite the file */
+    dmini_remove_key(ctx, "b", "w");
+    TEST_ASSERT(dmini_save_changes(ctx, file) == DMINI_OK, "Failed to save removal");
+    read_text_file(file, text, sizeof(text));
+    TEST_ASSERT(strcmp(text, "[a]\nx=1\n\n[b]\ny=3\n\n[c]\nz=9\n") == 0, "Removal did not rewrite the file");
+    dmini_set_string(ctx, NULL, "g", "1");
+    TEST_ASSERT(dmini_save_changes(ctx, file) == DMINI_OK, "Failed to save global key");
+    read_text_file(file, text, sizeof(text));
+    TEST_ASSERT(strncmp(text, "g=1\n[a]\n", 8) == 0, "Global key did not rewrite the file");
+
+    /* Repeated changes are compacted into a rewrite before the journal outgrows the content */
+    for (int i = 0; i < 20; i++)
+    {
+        dmini_set_int(ctx, "c", "z", i);
+        TEST_ASSERT(dmini_save_changes(ctx, file) == DMINI_OK, "Failed to save repeated change");
+    }
+    TEST_ASSERT(read_text_file(file, text, sizeof(text)) < 2 * dmini_generate_string(ctx, NULL, 0),
+                "Journal was never compacted");
+    TEST_ASSERT(file_matches_context(file, ctx), "File does not read back as the context");
+
+    /* Saving to a different file writes all of it */
+    TEST_ASSERT(dmini_save_changes(ctx, other) == DMINI_OK, "Failed to save to another file");
+    TEST_ASSERT(file_matches_context(other, ctx), "Other file is incomplete");
+    dmini_destroy(ctx);
+
+    /* A file parsed into an empty context is the baseline */
+    ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_file(ctx, other) == DMINI_OK, "Failed to parse file");
+    int size = read_text_file(other, text, sizeof(text));
+    dmini_set_string(ctx, "a", "x", "5");
+    TEST_ASSERT(dmini_save_changes(ctx, other) == DMINI_OK, "Failed to save change");
+    TEST_ASSERT(read_text_file(other, text, sizeof(text)) == size + 34 + 9, "Change was not appended");  // announcement + record
+    TEST_ASSERT(strcmp(text + size, "\n;dmini-journal 00000009 6cd6e061\n\n[a]\nx=5\n") == 0,
+                "Wrong appended record");
+    TEST_ASSERT(file_matches_context(other, ctx), "File does not read back as the context");
+
+    TEST_ASSERT(dmini_save_changes(NULL, file) == DMINI_ERR_INVALID, "NULL context accepted");
+    TEST_ASSERT(dmini_save_changes(ctx, NULL) == DMINI_ERR_INVALID, "NULL file name accepted");
+
+    dmini_destroy(ctx);
+    Dmod_FileRemove(file);
+    Dmod_FileRemove(other);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: A torn or damaged appended record leaves the old values
+ */
+static void test_save_changes_torn(void)
+{
+    TEST_START("Torn incremental save");
+
+    const char* file = "/tmp/test_dmini_torn.ini";
+    char text[512];
+    char cut[512];
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_string(ctx, "[a]\nx=old_value\ny=2\n[b]\nz=long_enough_to_hold_a_record\n") == DMINI_OK,
+                "Failed to parse string");
+    TEST_ASSERT(dmini_save_changes(ctx, file) == DMINI_OK, "Failed to save");
+    size_t base = (size_t)read_text_file(file, text, sizeof(text));
+    dmini_set_string(ctx, "a", "x", "new_value");
+    TEST_ASSERT(dmini_save_changes(ctx, file) == DMINI_OK, "Failed to save change");
+    size_t size = (size_t)read_text_file(file, text, sizeof(text));
+    TEST_ASSERT(size > base && strstr(text + base, ";dmini-journal ") != NULL, "Change was not appended");
+    dmini_destroy(ctx);
+
+    /* Power lost at any byte of the append: the record is dropped as a whole */
+    for (size_t len = base; len <= size; len++)
+    {
+        memcpy(cut, text, len);
+        cut[len] = '\0';
+        write_text_file(file, cut);
+
+        ctx = dmini_create();
+        TEST_ASSERT(ctx != NULL, "Failed to create context");
+        TEST_ASSERT(dmini_parse_file(ctx, file) == DMINI_OK, "Failed to parse torn file");
+        TEST_ASSERT(strcmp(dmini_get_string(ctx, "a", "x", ""), len == size ? "new_value" : "old_value") == 0,
+                    "Torn record was applied");
+        TEST_ASSERT(dmini_get_int(ctx, "a", "y", 0) == 2, "Value before the record was lost");
+        dmini_destroy(ctx);
+
+        ctx = dmini_create();
+        TEST_ASSERT(ctx != NULL, "Failed to create context");
+        TEST_ASSERT(dmini_open_lazy(ctx, file) == DMINI_OK, "Failed to open torn file lazily");
+        TEST_ASSERT(strcmp(dmini_get_string(ctx, "a", "x", ""), len == size ? "new_value" : "old_value") == 0,
+                    "Torn record was applied lazily");
+        dmini_destroy(ctx);
+    }
+
+    /* A damaged record is dropped too, and the next save rewrites the file */
+    memcpy(cut, text, size + 1);
+    char* value = strstr(cut + base, "new_value");
+    TEST_ASSERT(value != NULL, "Record not found");
+    value[0] = 'N';
+    write_text_file(file, cut);
+    ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_file(ctx, file) == DMINI_OK, "Failed to parse damaged file");
+    TEST_ASSERT(strcmp(dmini_get_string(ctx, "a", "x", ""), "old_value") == 0, "Damaged record was applied");
+    dmini_set_int(ctx, "b", "z", 7);
+    TEST_ASSERT(dmini_save_changes(ctx, file) == DMINI_OK, "Failed to save after a damaged record");
+    read_text_file(file, cut, sizeof(cut));
+    TEST_ASSERT(strstr(cut, "New_value") == NULL, "Damaged record was kept");
+    dmini_destroy(ctx);
+
+    ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_file(ctx, file) == DMINI_OK, "Failed to parse rewritten file");
+    TEST_ASSERT(strcmp(dmini_get_string(ctx, "a", "x", ""), "old_value") == 0, "Wrong value after rewrite");
+    TEST_ASSERT(dmini_get_int(ctx, "b", "z", 0) == 7, "Change after a damaged record was lost");
+    dmini_destroy(ctx);
+
+    /* A kept document ends before a torn record as well */
+    text[size - 3] = '\0';
+    write_text_file(file, text);
+    ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    if (dmini_enable_format_preserving(ctx) == DMINI_OK)
+    {
+        TEST_ASSERT(dmini_parse_file(ctx, file) == DMINI_OK, "Failed to parse torn file");
+        TEST_ASSERT(strcmp(dmini_get_string(ctx, "a", "x", ""), "old_value") == 0, "Torn record was applied");
+        dmini_generate_string(ctx, cut, sizeof(cut));
+        TEST_ASSERT(strncmp(cut, text, base) == 0 && strstr(cut, "new_") == NULL, "Torn record was kept");
+    }
+    dmini_destroy(ctx);
+
+    Dmod_FileRemove(file);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Opening a file lazily and loading sections on first use
+ */
+static void test_open_lazy(void)
+{
+    TEST_START("Lazy section loading");
+
+    const char* file = "/tmp/test_dmini_lazy.ini";
+    const char* text = "g=0\n[a]\nx=1\n; comment\n[b]\r\ny=2\r\n  [a]\nz=3\n[empty]\n[c]\nk=v";
+    char expected[512];
+    char actual[512];
+    write_text_file(file, text);
+
+    dmini_context_t reference = dmini_create();
+    TEST_ASSERT(reference != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_string(reference, text) == DMINI_OK, "Failed to parse string");
+
+    /* Sections are known right after the scan, pairs are parsed on first use */
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_open_lazy(ctx, file) == DMINI_OK, "Failed to open file lazily");
+    TEST_ASSERT(dmini_section_count(ctx) == 5, "Wrong section count");
+    TEST_ASSERT(strcmp(dmini_section_name(ctx, 4), "c") == 0, "Wrong section name");
+
+    size_t before = dmini_memory_usage(ctx);
+    TEST_ASSERT(strcmp(dmini_get_string(ctx, "b", "y", ""), "2") == 0, "Wrong value in loaded section");
+    TEST_ASSERT(dmini_memory_usage(ctx) > before, "Section was loaded at open");
+    TEST_ASSERT(dmini_key_count(ctx, "a") == 2, "Repeated section was not merged");
+    TEST_ASSERT(dmini_get_int(ctx, "a", "z", 0) == 3, "Wrong value in repeated section");
+    TEST_ASSERT(dmini_get_int(ctx, NULL, "g", -1) == 0, "Wrong global value");
+    TEST_ASSERT(dmini_has_section(ctx, "empty"), "Empty section missing");
+
+    /* Loading is not a change: appending keeps the offsets of unloaded sections valid */
+    dmini_set_int(ctx, "b", "y", 5);
+    TEST_ASSERT(dmini_save_changes(ctx, file) == DMINI_OK, "Failed to save change");
+    TEST_ASSERT(read_text_file(file, actual, sizeof(actual)) == (int)strlen(text) + 34 + 9, "Change was not appended");
+    TEST_ASSERT(strcmp(dmini_get_string(ctx, "c", "k", ""), "v") == 0, "Wrong value after append");
+    dmini_set_int(reference, "b", "y", 5);
+    TEST_ASSERT(file_matches_context(file, ctx), "File does not read back as the context");
+    dmini_destroy(ctx);
+
+    /* Generating loads everything that is left */
+    ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_open_lazy(ctx, file) == DMINI_OK, "Failed to open file lazily");
+    TEST_ASSERT(dmini_remove_section(ctx, "a") == DMINI_OK, "Failed to remove unloaded section");
+    dmini_remove_section(reference, "a");
+    dmini_generate_string(reference, expected, sizeof(expected));
+    TEST_ASSERT(dmini_generate_string(ctx, NULL, 0) == (int)strlen(expected) + 1, "Wrong generated size");
+    dmini_generate_string(ctx, actual, sizeof(actual));
+    TEST_ASSERT(strcmp(expected, actual) == 0, "Generated text differs from a full parse");
+    dmini_destroy(ctx);
+
+    /* A snapshot of a lazy context holds all of it */
+    ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_open_lazy(ctx, file) == DMINI_OK, "Failed to open file lazily");
+    dmini_snapshot_t snapshot = dmini_freeze(ctx);
+    TEST_ASSERT(snapshot != NULL, "Failed to freeze lazy context");
+    TEST_ASSERT(dmini_get_int(snapshot, "a", "x", 0) == 1, "Snapshot misses unloaded section");
+    TEST_ASSERT(dmini_open_lazy(snapshot, file) == DMINI_ERR_READONLY, "Snapshot opened a file");
+    dmini_destroy(snapshot);
+
+    TEST_ASSERT(dmini_open_lazy(NULL, file) == DMINI_ERR_INVALID, "NULL context accepted");
+    TEST_ASSERT(dmini_open_lazy(ctx, NULL) == DMINI_ERR_INVALID, "NULL file name accepted");
+    TEST_ASSERT(dmini_open_lazy(ctx, "/tmp/test_dmini_missing.ini") == DMINI_ERR_FILE, "Missing file accepted");
+
+    dmini_destroy(ctx);
+    dmini_destroy(reference);
+    Dmod_FileRemove(file);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Parsing a single section of a file
+ */
+static void test_parse_file_section(void)
+{
+    TEST_START("Section-restricted file parse");
+
+    const char* file = "/tmp/test_dmini_section.ini";
+    write_text_file(file, "g=1\n[a]\nx=1\n[motor]\nspeed=100\n[b]\ny=2\n[ motor ]\nratio=3\n");
+
+    /* Only the requested section is created */
+    const unsigned int token = 0x4D4F544Fu;
+    dmini_context_t ctx = dmini_create_with_token(token);
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_file_section(ctx, file, "motor") == DMINI_OK, "Failed to parse section");
+    TEST_ASSERT(dmini_section_count(ctx) == 2, "Other sections were created");
+    TEST_ASSERT(dmini_get_int(ctx, "motor", "speed", 0) == 100, "Wrong value");
+    TEST_ASSERT(dmini_get_int(ctx, "motor", "ratio", 0) == 3, "Repeated section was not merged");
+    TEST_ASSERT(!dmini_has_key(ctx, NULL, "g"), "Global key was loaded");
+    TEST_ASSERT(!dmini_has_section(ctx, "a") && !dmini_has_section(ctx, "b"), "Other section was loaded");
+
+    /* Together with an owner token it becomes a private view */
+    TEST_ASSERT(dmini_set_active_section(ctx, "motor", token) == DMINI_OK, "Failed to restrict view");
+    TEST_ASSERT(dmini_get_int(ctx, NULL, "speed", 0) == 100, "Wrong value through the restricted view");
+    dmini_destroy(ctx);
+
+    /* NULL keeps only the global section */
+    ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_file_section(ctx, file, NULL) == DMINI_OK, "Failed to parse global section");
+    TEST_ASSERT(dmini_section_count(ctx) == 1, "Named sections were created");
+    TEST_ASSERT(dmini_get_int(ctx, NULL, "g", 0) == 1, "Global key missing");
+
+    /* A missing section is not an error */
+    TEST_ASSERT(dmini_parse_file_section(ctx, file, "none") == DMINI_OK, "Missing section reported");
+    TEST_ASSERT(dmini_section_count(ctx) == 1, "Missing section was created");
+
+    TEST_ASSERT(dmini_parse_file_section(NULL, file, "a") == DMINI_ERR_INVALID, "NULL context accepted");
+    TEST_ASSERT(dmini_parse_file_section(ctx, NULL, "a") == DMINI_ERR_INVALID, "NULL file name accepted");
+    TEST_ASSERT(dmini_parse_file_section(ctx, "/tmp/test_dmini_missing.ini", "a") == DMINI_ERR_FILE,
+                "Missing file accepted");
+
+    dmini_destroy(ctx);
+    Dmod_FileRemove(file);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Statistics counters
+ */
+static void test_stats(void)
+{
+    TEST_START("Statistics counters");
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+
+    dmini_stats_t stats;
+    int result = dmini_get_stats(ctx, &stats);
+    TEST_ASSERT(result == DMINI_OK || result == DMINI_ERR_GENERAL, "Unexpected result");
+    if (result == DMINI_OK)
+    {
+        TEST_ASSERT(dmini_parse_string(ctx, "[a]\nx=1\ny=2\n\n[b]\nz=3\n") == DMINI_OK, "Failed to parse string");
+        TEST_ASSERT(dmini_reset_stats(ctx) == DMINI_OK, "Failed to reset stats");
+        TEST_ASSERT(dmini_get_stats(ctx, &stats) == DMINI_OK, "Failed to get stats");
+        TEST_ASSERT(stats.section_lookups == 0 && stats.parse_lines == 0, "Counters were not reset");
+        TEST_ASSERT(stats.bytes_held == dmini_memory_usage(ctx), "Wrong bytes held");
+
+        /* One hit and one miss per level */
+        dmini_get_string(ctx, "a", "x", NULL);
+        dmini_get_string(ctx, "a", "none", NULL);
+        dmini_get_string(ctx, "none", "x", NULL);
+        TEST_ASSERT(dmini_get_stats(ctx, &stats) == DMINI_OK, "Failed to get stats");
+        TEST_ASSERT(stats.section_lookups == 3 && stats.section_misses == 1, "Wrong section counters");
+        TEST_ASSERT(stats.pair_lookups == 2 && stats.pair_misses == 1, "Wrong key counters");
+        TEST_ASSERT(stats.nodes_visited >= 4, "Traversal was not counted");
+
+        /* Parse, allocation and generation counters */
+        dmini_reset_stats(ctx);
+        TEST_ASSERT(dmini_parse_string(ctx, "[c]\nw=4\n; note\n") == DMINI_OK, "Failed to parse string");
+        char buffer[128];
+        int size = dmini_generate_string(ctx, buffer, sizeof(buffer));
+        TEST_ASSERT(dmini_get_stats(ctx, &stats) == DMINI_OK, "Failed to get stats");
+        TEST_ASSERT(stats.parse_calls == 1 && stats.parse_lines == 3, "Wrong parse counters");
+        TEST_ASSERT(stats.allocations > 0, "Allocations were not counted");
+        TEST_ASSERT(stats.generate_bytes == (uint32_t)size - 1, "Wrong generated byte count");
+
+        /* Accesses refused by the restriction */
+        dmini_reset_stats(ctx);
+        dmini_set_active_section(ctx, "a", 0);
+        dmini_get_string(ctx, "b", "z", NULL);
+        dmini_set_string(ctx, "b", "z", "5");
+        TEST_ASSERT(dmini_get_stats(ctx, &stats) == DMINI_OK, "Failed to get stats");
+        TEST_ASSERT(stats.active_rejections == 2, "Rejections were not counted");
+    }
+
+    TEST_ASSERT(dmini_get_stats(NULL, &stats) == DMINI_ERR_INVALID, "NULL context accepted");
+    TEST_ASSERT(dmini_get_stats(ctx, NULL) == DMINI_ERR_INVALID, "NULL stats accepted");
+    TEST_ASSERT(dmini_reset_stats(NULL) == DMINI_ERR_INVALID, "NULL context accepted");
+
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Change log filled by the watch callbacks
+ */
+typedef struct
+{
+    int calls;
+    char last[64];
+} watch_log_t;
+
+static void watch_record(dmini_context_t ctx, const char* section, const char* key, const char* value, void* user)
+{
+    watch_log_t* log = (watch_log_t*)user;
+    log->calls++;
+    Dmod_SnPrintf(log->last, sizeof(log->last), "%s/%s=%s", section ? section : "", key, value ? value : "(removed)");
+}
+
+static void watch_once(dmini_context_t ctx, const char* section, const char* key, const char* value, void* user)
+{
+    watch_record(ctx, section, key, value, user);
+    dmini_unwatch(ctx, section, key, watch_once, user);
+}
+
+/**
+ * @brief Test: Change-notification callbacks
+ */
+static void test_watch(void)
+{
+    TEST_START("Change notifications");
+
+    watch_log_t key_log = { 0 };
+    watch_log_t section_log = { 0 };
+    watch_log_t once_log = { 0 };
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_string(ctx, "[net]\nport=80\nhost=a\n[log]\nlevel=1\n") == DMINI_OK,
+                "Failed to parse string");
+    TEST_ASSERT(dmini_watch(ctx, "net", "port", watch_record, &key_log) == DMINI_OK, "Failed to watch key");
+    TEST_ASSERT(dmini_watch(ctx, "net", NULL, watch_record, &section_log) == DMINI_OK, "Failed to watch section");
+    TEST_ASSERT(dmini_watch(ctx, "log", "level", watch_once, &once_log) == DMINI_OK, "Failed to watch key");
+
+    /* Only real changes notify */
+    dmini_set_int(ctx, "net", "port", 80);
+    TEST_ASSERT(key_log.calls == 0, "Unchanged value notified");
+    dmini_set_int(ctx, "net", "port", 8080);
+    TEST_ASSERT(key_log.calls == 1 && strcmp(key_log.last, "net/port=8080") == 0, "Key change missed");
+    dmini_set_string(ctx, "net", "host", "b");
+    TEST_ASSERT(key_log.calls == 1, "Other key notified a key watch");
+    TEST_ASSERT(section_log.calls == 2 && strcmp(section_log.last, "net/host=b") == 0, "Section change missed");
+
+    /* A re-parse notifies only the values it changes */
+    TEST_ASSERT(dmini_parse_string(ctx, "[net]\nport=8080\nhost=c\n") == DMINI_OK, "Failed to parse string");
+    TEST_ASSERT(key_log.calls == 1 && section_log.calls == 3, "Re-parse notified unchanged values");
+
+    /* Removals report a NULL value */
+    dmini_remove_key(ctx, "net", "host");
+    TEST_ASSERT(strcmp(section_log.last, "net/host=(removed)") == 0, "Key removal missed");
+    dmini_remove_section(ctx, "net");
+    TEST_ASSERT(key_log.calls == 2 && strcmp(key_log.last, "net/port=(removed)") == 0, "Section removal missed");
+
+    /* A callback may unregister itself */
+    dmini_set_int(ctx, "log", "level", 2);
+    dmini_set_int(ctx, "log", "level", 3);
+    TEST_ASSERT(once_log.calls == 1 && strcmp(once_log.last, "log/level=2") == 0, "Watch was not removed");
+
+    TEST_ASSERT(dmini_unwatch(ctx, "net", "port", watch_record, &key_log) == DMINI_OK, "Failed to unwatch");
+    TEST_ASSERT(dmini_unwatch(ctx, "net", "port", watch_record, &key_log) == DMINI_ERR_NOT_FOUND,
+                "Watch removed twice");
+    dmini_set_int(ctx, "net", "port", 1);
+    TEST_ASSERT(key_log.calls == 2, "Removed watch was called");
+
+    TEST_ASSERT(dmini_watch(NULL, "a", "b", watch_record, &key_log) == DMINI_ERR_INVALID, "NULL context accepted");
+    TEST_ASSERT(dmini_watch(ctx, "a", "b", NULL, &key_log) == DMINI_ERR_INVALID, "NULL callback accepted");
+
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Difference log filled by the diff callback
+ */
+typedef struct
+{
+    int added;
+    int changed;
+    int removed;
+} diff_log_t;
+
+static void diff_record(const char* section, const char* key, const char* old_value, const char* new_value, void* user)
+{
+    diff_log_t* log = (diff_log_t*)user;
+    if (!old_value)
+    {
+        log->added++;
+    }
+    else if (!new_value)
+    {
+        log->removed++;
+    }
+    else
+    {
+        log->changed++;
+    }
+}
+
+/**
+ * @brief Test: Merging and comparing contexts
+ */
+static void test_merge_diff(void)
+{
+    TEST_START("Merge and diff");
+
+    dmini_context_t base = dmini_create();
+    dmini_context_t layer = dmini_create();
+    TEST_ASSERT(base != NULL && layer != NULL, "Failed to create contexts");
+
+    /* Overwrite: layer values win, layer is emptied */
+    dmini_parse_string(base, "name=dev\n[net]\nport=80\nhost=a\n[log]\nlevel=1\n");
+    dmini_parse_string(layer, "name=site\n[net]\nport=8080\n[extra]\nmode=auto\n");
+    TEST_ASSERT(dmini_merge(base, layer, DMINI_MERGE_OVERWRITE) == DMINI_OK, "Overwrite merge failed");
+    TEST_ASSERT(strcmp(dmini_get_string(base, NULL, "name", ""), "site") == 0, "Global value not merged");
+    TEST_ASSERT(dmini_get_int(base, "net", "port", 0) == 8080, "Value not overwritten");
+    TEST_ASSERT(strcmp(dmini_get_string(base, "net", "host", ""), "a") == 0, "Existing key lost");
+    TEST_ASSERT(strcmp(dmini_get_string(base, "extra", "mode", ""), "auto") == 0, "New section not merged");
+    TEST_ASSERT(dmini_section_count(layer) == 1 && dmini_key_count(layer, NULL) == 0, "Source not emptied");
+
+    /* Keep: only missing keys are added */
+    dmini_parse_string(layer, "[net]\nport=1\ntimeout=5\n");
+    TEST_ASSERT(dmini_merge(base, layer, DMINI_MERGE_KEEP) == DMINI_OK, "Keep merge failed");
+    TEST_ASSERT(dmini_get_int(base, "net", "port", 0) == 8080, "Existing value overwritten");
+    TEST_ASSERT(dmini_get_int(base, "net", "timeout", 0) == 5, "Missing key not added");
+
+    /* Diff reports added, changed and removed keys */
+    dmini_parse_string(layer, "name=site\n[net]\nport=9090\nhost=a\ntimeout=5\n[log]\nlevel=1\nfile=x\n");
+    diff_log_t log = { 0 };
+    TEST_ASSERT(dmini_diff(base, layer, diff_record, &log) == 3, "Wrong number of differences");
+    TEST_ASSERT(log.added == 1 && log.changed == 1 && log.removed == 1, "Differences misreported");
+
+    /* Replace applies only the delta, watches see the changes only */
+    watch_log_t watch = { 0 };
+    dmini_watch(base, "net", NULL, watch_record, &watch);
+    TEST_ASSERT(dmini_merge(base, layer, DMINI_MERGE_REPLACE) == DMINI_OK, "Replace merge failed");
+    TEST_ASSERT(watch.calls == 1 && strcmp(watch.last, "net/port=9090") == 0, "Unchanged keys notified");
+    TEST_ASSERT(!dmini_has_section(base, "extra"), "Missing section not removed");
+    TEST_ASSERT(strcmp(dmini_get_string(base, "log", "file", ""), "x") == 0, "New key not merged");
+
+    dmini_context_t copy = dmini_create();
+    dmini_parse_string(copy, "name=site\n[net]\nport=9090\nhost=a\ntimeout=5\n[log]\nlevel=1\nfile=x\n");
+    TEST_ASSERT(dmini_diff(base, copy, NULL, NULL) == 0, "Replace did not reproduce the source");
+
+    TEST_ASSERT(dmini_merge(base, base, DMINI_MERGE_OVERWRITE) == DMINI_ERR_INVALID, "Self merge accepted");
+    TEST_ASSERT(dmini_merge(base, copy, 7) == DMINI_ERR_INVALID, "Unknown policy accepted");
+    TEST_ASSERT(dmini_diff(NULL, copy, NULL, NULL) == DMINI_ERR_INVALID, "NULL context accepted");
+
+    dmini_destroy(copy);
+    dmini_destroy(layer);
+    dmini_destroy(base);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Sharing repeated keys and values
+ */
+static void test_interning(void)
+{
+    TEST_START("String interning");
+
+    char data[512];
+    size_t len = 0;
+    for (char name = 'a'; name <= 'p'; name++)
+    {
+        len += Dmod_SnPrintf(data + len, sizeof(data) - len, "[%c]\nenabled=true\nmode=automatic\n", name);
+    }
+
+    dmini_context_t plain = dmini_create();
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(plain != NULL && ctx != NULL, "Failed to create contexts");
+
+    int result = dmini_enable_interning(ctx);
+    if (result == DMINI_ERR_GENERAL)
+    {
+        /* Built without the intern pool */
+        dmini_destroy(ctx);
+        dmini_destroy(plain);
+        TEST_PASS();
+        return;
+    }
+    TEST_ASSERT(result == DMINI_OK, "Failed to enable interning");
+    TEST_ASSERT(dmini_enable_interning(ctx) == DMINI_OK, "Second enable failed");
+
+    TEST_ASSERT(dmini_parse_string(plain, data) == DMINI_OK, "Failed to parse string");
+    TEST_ASSERT(dmini_parse_string(ctx, data) == DMINI_OK, "Failed to parse string");
+    TEST_ASSERT(dmini_memory_usage(ctx) < dmini_memory_usage(plain), "Repeated strings not shared");
+    TEST_ASSERT(dmini_get_string(ctx, "a", "mode", NULL) == dmini_get_string(ctx, "d", "mode", NULL),
+                "Equal values not shared");
+
+    /* Changing one pair leaves the others alone */
+    dmini_set_string(ctx, "b", "mode", "manual");
+    TEST_ASSERT(strcmp(dmini_get_string(ctx, "a", "mode", ""), "automatic") == 0, "Shared value changed");
+    TEST_ASSERT(strcmp(dmini_get_string(ctx, "b", "mode", ""), "manual") == 0, "Value not updated");
+    dmini_remove_section(ctx, "a");
+    dmini_remove_key(ctx, "c", "enabled");
+    TEST_ASSERT(strcmp(dmini_get_string(ctx, "d", "enabled", ""), "true") == 0, "Shared key released early");
+    dmini_set_string(ctx, "b", "mode", "automatic");
+    dmini_set_int(ctx, "d", "enabled", 1);
+    TEST_ASSERT(dmini_get_int(ctx, "d", "enabled", 0) == 1, "Value not updated");
+
+    dmini_snapshot_t snapshot = dmini_freeze(ctx);
+    TEST_ASSERT(snapshot != NULL, "Failed to freeze");
+    TEST_ASSERT(dmini_enable_interning(snapshot) == DMINI_ERR_READONLY, "Snapshot accepted interning");
+    TEST_ASSERT(dmini_enable_interning(NULL) == DMINI_ERR_INVALID, "NULL context accepted");
+
+    dmini_destroy(snapshot);
+    dmini_destroy(ctx);
+    dmini_destroy(plain);
+    TEST_PASS();
+}
+
+/**
+ * @brief Allocator state used by the allocator test
+ */
+typedef struct
+{
+    int live;                       /* blocks not freed yet */
+    int calls;                      /* malloc_fn and realloc_fn calls */
+    int reallocs;                   /* realloc_fn calls */
+    int limit;                      /* calls allowed before failing (-1 = no limit) */
+} test_allocator_t;
+
+/* Each block keeps its size in front of it so test_realloc() knows how much to copy */
+#define TEST_ALLOC_HEADER 16
+
+static void* test_malloc(size_t size, void* user)
+{
+    test_allocator_t* state = (test_allocator_t*)user;
+    if (state->limit >= 0 && state->calls >= state->limit)
+    {
+        return NULL;
+    }
+    char* block = (char*)Dmod_Malloc(size + TEST_ALLOC_HEADER);
+    if (!block)
+    {
+        return NULL;
+    }
+    memcpy(block, &size, sizeof(size));
+    state->calls++;
+    state->live++;
+    return block + TEST_ALLOC_HEADER;
+}
+
+static void test_free(void* ptr, void* user)
+{
+    ((test_allocator_t*)user)->live--;
+    Dmod_Free((char*)ptr - TEST_ALLOC_HEADER);
+}
+
+static void* test_realloc(void* ptr, size_t size, void* user)
+{
+    test_allocator_t* state = (test_allocator_t*)user;
+    char* copy = (char*)test_malloc(size, user);
+    if (copy && ptr)
+    {
+        size_t old_size;
+        memcpy(&old_size, (char*)ptr - TEST_ALLOC_HEADER, sizeof(old_size));
+        memcpy(copy, ptr, old_size < size ? old_size : size);
+        test_free(ptr, user);
+    }
+    state->reallocs++;
+    return copy;
+}
+
+/**
+ * @brief Test: Contexts allocating through caller hooks
+ */
+static void test_create_ex(void)
+{
+    TEST_START("Custom allocator");
+
+    test_allocator_t state = { 0, 0, 0, -1 };
+    dmini_allocator_t allocator = { test_malloc, test_free, NULL, &state };
+
+    /* Heap mode: every node comes from the hooks and goes back to them */
+    dmini_context_t ctx = dmini_create_ex(&allocator, 0, 0);
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_string(ctx, "[a]\nk=v\n[b]\nx=1\n") == DMINI_OK, "Failed to parse string");
+    TEST_ASSERT(state.live > 2, "Nodes not taken from the allocator");
+    dmini_snapshot_t snapshot = dmini_freeze(ctx);
+    TEST_ASSERT(snapshot != NULL, "Failed to freeze");
+    dmini_destroy(ctx);
+    dmini_destroy(snapshot);
+    TEST_ASSERT(state.live == 0, "Memory not returned to the allocator");
+
+    /* Arena mode draws its blocks from the hooks */
+    state.calls = 0;
+    ctx = dmini_create_ex(&allocator, 256, 42);
+    TEST_ASSERT(ctx != NULL, "Failed to create arena context");
+    TEST_ASSERT(dmini_parse_string(ctx, "[a]\nk=v\n") == DMINI_OK, "Failed to parse string");
+    TEST_ASSERT(dmini_set_active_section(ctx, "a", 1) == DMINI_ERR_LOCKED, "Owner token not applied");
+    dmini_destroy(ctx);
+    TEST_ASSERT(state.live == 0 && state.calls > 0, "Arena blocks not taken from the allocator");
+
+    /* Long partial lines of a chunked parse are grown with realloc_fn */
+    allocator.realloc_fn = test_realloc;
+    ctx = dmini_create_ex(&allocator, 0, 0);
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    dmini_parse_begin(ctx);
+    for (int i = 0; i < 40; i++)
+    {
+        dmini_parse_feed(ctx, i == 0 ? "key=" : "0123456789", i == 0 ? 4 : 10);
+    }
+    TEST_ASSERT(dmini_parse_end(ctx) == DMINI_OK, "Chunked parse failed");
+    TEST_ASSERT(strlen(dmini_get_string(ctx, NULL, "key", "")) == 390, "Long line not parsed");
+    TEST_ASSERT(state.reallocs > 0, "realloc_fn not used");
+    dmini_destroy(ctx);
+    TEST_ASSERT(state.live == 0, "Memory not returned to the allocator");
+
+    /* A bounded pool makes the context report memory errors */
+    state.calls = 0;
+    state.limit = 4;
+    ctx = dmini_create_ex(&allocator, 0, 0);
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_string(ctx, "[a]\nk=v\n[b]\nx=1\ny=2\n") == DMINI_ERR_MEMORY, "Pool limit ignored");
+    dmini_destroy(ctx);
+    TEST_ASSERT(state.live == 0, "Memory leaked after failure");
+
+    allocator.free_fn = NULL;
+    TEST_ASSERT(dmini_create_ex(&allocator, 0, 0) == NULL, "Missing free hook accepted");
+
+    TEST_PASS();
+}
+
+/**
+ * @brief Test: Saving into the kept document
+ */
+static void test_format_preserving(void)
+{
+    TEST_START("Format-preserving mode");
+
+    const char* file = "/tmp/test_dmini_preserve.ini";
+    const char* doc =
+        "; Probe configuration\n"
+        "name = probe   ; shown on the display\n"
+        "\n"
+        "[uart]\n"
+        "# console port\n"
+        "baud=9600\n"
+        "parity = none\n"
+        "\n"
+        "[wifi]\n"
+        "ssid = lab\n";
+    write_text_file(file, doc);
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    int result = dmini_enable_format_preserving(ctx);
+    if (result == DMINI_ERR_GENERAL)
+    {
+        /* Built without the format-preserving mode */
+        dmini_destroy(ctx);
+        TEST_PASS();
+        return;
+    }
+    TEST_ASSERT(result == DMINI_OK, "Failed to enable the mode");
+    TEST_ASSERT(dmini_parse_file(ctx, file) == DMINI_OK, "Failed to parse file");
+
+    /* Nothing changed: the document comes back byte for byte */
+    char buffer[512];
+    TEST_ASSERT(dmini_generate_string(ctx, NULL, 0) == (int)strlen(doc) + 1, "Wrong size");
+    dmini_generate_string(ctx, buffer, sizeof(buffer));
+    TEST_ASSERT(strcmp(buffer, doc) == 0, "Unchanged document not reproduced");
+
+    /* Only the changed spans are replaced */
+    dmini_set_string(ctx, NULL, "name", "sensor");
+    dmini_set_int(ctx, "uart", "baud", 115200);
+    dmini_remove_key(ctx, "uart", "parity");
+    dmini_set_string(ctx, "uart", "flow", "rts");
+    dmini_remove_section(ctx, "wifi");
+    dmini_set_string(ctx, "net", "ip", "10.0.0.2");
+    const char* expected =
+        "; Probe configuration\n"
+        "name = sensor   ; shown on the display\n"
+        "\n"
+        "[uart]\n"
+        "# console port\n"
+        "baud=115200\n"
+        "flow=rts\n"
+        "\n"
+        "\n"
+        "[net]\n"
+        "ip=10.0.0.2\n";
+    TEST_ASSERT(dmini_generate_string(ctx, NULL, 0) == (int)strlen(expected) + 1, "Wrong size after edits");
+    dmini_generate_string(ctx, buffer, sizeof(buffer));
+    TEST_ASSERT(strcmp(buffer, expected) == 0, "Edits not spliced into the document");
+
+    /* Saving writes the same text, and it reads back as the context */
+    TEST_ASSERT(dmini_save_changes(ctx, file) == DMINI_OK, "Failed to save changes");
+    TEST_ASSERT(read_text_file(file, buffer, sizeof(buffer)) > 0 && strcmp(buffer, expected) == 0,
+                "Saved file differs");
+    dmini_context_t copy = dmini_create();
+    TEST_ASSERT(copy != NULL && dmini_parse_file(copy, file) == DMINI_OK, "Failed to read the saved file");
+    TEST_ASSERT(dmini_diff(ctx, copy, NULL, NULL) == 0, "Saved file does not match the context");
+    dmini_destroy(copy);
+    dmini_destroy(ctx);
+
+    /* A repeated key is spliced in its last line, the one that wins */
+    ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    dmini_enable_format_preserving(ctx);
+    dmini_parse_string(ctx, "[a]\r\nx=1\r\nx=2\r\n");
+    dmini_set_int(ctx, "a", "x", 3);
+    dmini_generate_string(ctx, buffer, sizeof(buffer));
+    TEST_ASSERT(strcmp(buffer, "[a]\r\nx=1\r\nx=3\r\n") == 0, "Repeated key not handled");
+
+    /* Only the first document is kept, later ones are changes */
+    dmini_parse_string(ctx, "[a]\ny=4\n");
+    dmini_generate_string(ctx, buffer, sizeof(buffer));
+    TEST_ASSERT(strcmp(buffer, "[a]\r\nx=1\r\nx=3\r\ny=4\r\n") == 0, "Second document not merged");
+    TEST_ASSERT(dmini_enable_format_preserving(NULL) == DMINI_ERR_INVALID, "NULL context accepted");
+    dmini_destroy(ctx);
+
+    TEST_PASS();
+}
+
+/**
+ * @brief Executor running the tasks one after another, last task first
+ */
+static void run_tasks_backwards(dmini_task_t task, void** args, unsigned int count, void* user)
+{
+    unsigned int* runs = (unsigned int*)user;
+    while (count > 0)
+    {
+        task(args[--count]);
+        (*runs)++;
+    }
+}
+
+/**
+ * @brief Append a decimal number to a buffer
+ */
+static size_t append_number(char* buffer, size_t pos, unsigned int number)
+{
+    char digits[10];
+    size_t count = 0;
+    do
+    {
+        digits[count++] = (char)('0' + number % 10);
+        number /= 10;
+    } while (number > 0);
+    while (count > 0)
+    {
+        buffer[pos++] = digits[--count];
+    }
+    return pos;
+}
+
+/**
+ * @brief Append a string to a buffer
+ */
+static size_t append_text(char* buffer, size_t pos, const char* text)
+{
+    size_t len = strlen(text);
+    memcpy(buffer + pos, text, len);
+    return pos + len;
+}
+
+/**
+ * @brief Test parsing a document in parallel chunks
+ */
+static void test_parse_parallel(void)
+{
+    TEST_START("Parallel parse");
+
+    /* Three passes over the same sections, so every section repeats in later chunks */
+    size_t capacity = 128 * 1024;
+    char* doc = (char*)Dmod_Malloc(capacity);
+    TEST_ASSERT(doc != NULL, "Failed to allocate document");
+    size_t len = append_text(doc, 0, "; generated\nname = probe\nlevel = 1\n");
+    for (unsigned int pass = 0; pass < 3; pass++)
+    {
+        for (unsigned int sec = 0; sec < 60; sec++)
+        {
+            len = append_text(doc, len, "\n[channel");
+            len = append_number(doc, len, sec);
+            len = append_text(doc, len, "]\nlast = ");
+            len = append_number(doc, len, pass);
+            len = append_text(doc, len, "\n");
+            for (unsigned int key = 0; key < 16; key++)
+            {
+                len = append_text(doc, len, "gain");
+                len = append_number(doc, len, pass * 100 + key);
+                len = append_text(doc, len, " = ");
+                len = append_number(doc, len, sec * key);
+                len = append_text(doc, len, "   ; calibrated\n");
+            }
+        }
+    }
+    TEST_ASSERT(len < capacity && len > 4 * 16384, "Document has the wrong size");
+
+    dmini_context_t serial = dmini_create();
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(serial != NULL && ctx != NULL, "Failed to create contexts");
+    TEST_ASSERT(dmini_parse_memory(serial, doc, len) == DMINI_OK, "Failed to parse serially");
+
+    unsigned int runs = 0;
+    TEST_ASSERT(dmini_parse_parallel(ctx, doc, len, 4, run_tasks_backwards, &runs) == DMINI_OK,
+                "Failed to parse in parallel");
+    TEST_ASSERT(runs == 0 || runs == 4, "Wrong number of tasks");
+    TEST_ASSERT(dmini_diff(serial, ctx, NULL, NULL) == 0, "Parallel parse differs from serial parse");
+    TEST_ASSERT(dmini_section_count(ctx) == dmini_section_count(serial), "Wrong number of sections");
+    TEST_ASSERT(dmini_get_int(ctx, "channel7", "last", -1) == 2, "Later value did not win");
+
+    /* The sections keep the order of a serial parse */
+    int size = dmini_generate_string(serial, NULL, 0);
+    char* expected = (char*)Dmod_Malloc(size);
+    char* actual = (char*)Dmod_Malloc(size);
+    TEST_ASSERT(expected != NULL && actual != NULL, "Failed to allocate buffers");
+    TEST_ASSERT(dmini_generate_string(serial, expected, size) == size, "Failed to generate string");
+    TEST_ASSERT(dmini_generate_string(ctx, actual, size) == size, "Wrong generated size");
+    TEST_ASSERT(strcmp(expected, actual) == 0, "Generated text differs from serial parse");
+    Dmod_Free(actual);
+    Dmod_Free(expected);
+
+    /* Without an executor or for a small document the parse is serial */
+    dmini_context_t small = dmini_create();
+    TEST_ASSERT(small != NULL, "Failed to create context");
+    runs = 0;
+    TEST_ASSERT(dmini_parse_parallel(small, "[a]\nb = 1\n", 10, 4, run_tasks_backwards, &runs) == DMINI_OK,
+                "Failed to parse small document");
+    TEST_ASSERT(runs == 0 && dmini_get_int(small, "a", "b", 0) == 1, "Small document not parsed serially");
+    dmini_context_t fallback = dmini_create();
+    TEST_ASSERT(fallback != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_parse_parallel(fallback, doc, len, 4, NULL, NULL) == DMINI_OK, "Failed without executor");
+    TEST_ASSERT(dmini_diff(serial, fallback, NULL, NULL) == 0, "Serial fallback differs");
+    dmini_destroy(fallback);
+
+    TEST_ASSERT(dmini_parse_parallel(NULL, doc, len, 4, run_tasks_backwards, &runs) == DMINI_ERR_INVALID,
+                "NULL context accepted");
+
+    dmini_destroy(small);
+    dmini_destroy(ctx);
+    dmini_destroy(serial);
+    Dmod_Free(doc);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test crash-safe saves to double-buffered slots
+ */
+static void test_atomic_save(void)
+{
+    TEST_START("Atomic save");
+
+    const char* base = "/tmp/test_dmini_slots.ini";
+    const char* slot0 = "/tmp/test_dmini_slots.ini.0";
+    const char* slot1 = "/tmp/test_dmini_slots.ini.1";
+    Dmod_FileRemove(slot0);
+    Dmod_FileRemove(slot1);
+    char text[256];
+
+    dmini_context_t ctx = dmini_create();
+    TEST_ASSERT(ctx != NULL, "Failed to create context");
+    dmini_set_string(ctx, NULL, "a", "1");
+    TEST_ASSERT(dmini_save_atomic(ctx, base) == DMINI_OK, "Failed to save first slot");
+
+    /* The slot is the generated text closed by a comment with sequence and CRC-32 */
+    TEST_ASSERT(read_text_file(slot0, text, sizeof(text)) > 0, "First slot not written");
+    TEST_ASSERT(strcmp(text, "a=1\n\n;dmini-slot 00000001 a8e5d715\n") == 0, "Wrong slot content");
+
+    /* The second save goes to the other slot, the first one stays intact */
+    dmini_set_int(ctx, "uart", "baud", 115200);
+    TEST_ASSERT(dmini_save_atomic(ctx, base) == DMINI_OK, "Failed to save second slot");
+    TEST_ASSERT(read_text_file(slot0, text, sizeof(text)) > 0 && find_substring(text, "baud") == NULL,
+                "Older slot was overwritten");
+
+    dmini_context_t copy = dmini_create();
+    TEST_ASSERT(copy != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_load_atomic(copy, base) == DMINI_OK, "Failed to load slots");
+    TEST_ASSERT(dmini_diff(ctx, copy, NULL, NULL) == 0, "Newest slot not loaded");
+    dmini_destroy(copy);
+
+    /* A save torn by a reset lacks its trailer and the older slot is loaded */
+    TEST_ASSERT(read_text_file(slot1, text, sizeof(text)) > 0, "Second slot not written");
+    text[12] = '\0';
+    write_text_file(slot1, text);
+    copy = dmini_create();
+    TEST_ASSERT(copy != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_load_atomic(copy, base) == DMINI_OK, "Failed to load older slot");
+    TEST_ASSERT(dmini_get_int(copy, "uart", "baud", 0) == 0 && dmini_get_int(copy, NULL, "a", 0) == 1,
+                "Torn slot was parsed");
+
+    /* A fresh context finds the torn slot and overwrites it, not the valid one */
+    dmini_set_string(copy, NULL, "a", "2");
+    TEST_ASSERT(dmini_save_atomic(copy, base) == DMINI_OK, "Failed to save over torn slot");
+    TEST_ASSERT(read_text_file(slot1, text, sizeof(text)) > 0 && find_substring(text, "00000002") != NULL,
+                "Torn slot not reused");
+    dmini_destroy(copy);
+
+    /* Damaged text behind an intact trailer fails the checksum */
+    TEST_ASSERT(read_text_file(slot1, text, sizeof(text)) > 0, "Failed to read slot");
+    text[2] = '3';
+    write_text_file(slot1, text);
+    copy = dmini_create();
+    TEST_ASSERT(copy != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_load_atomic(copy, base) == DMINI_OK, "Failed to load valid slot");
+    TEST_ASSERT(dmini_get_int(copy, NULL, "a", 0) == 1, "Damaged slot was parsed");
+    dmini_destroy(copy);
+
+    /* Without a valid slot nothing is parsed */
+    Dmod_FileRemove(slot0);
+    copy = dmini_create();
+    TEST_ASSERT(copy != NULL, "Failed to create context");
+    TEST_ASSERT(dmini_load_atomic(copy, base) == DMINI_ERR_FILE, "Invalid slots accepted");
+    TEST_ASSERT(dmini_section_count(copy) == 1 && dmini_get_string(copy, NULL, "a", NULL) == NULL,
+                "Invalid slot was parsed");
+    dmini_destroy(copy);
+
+    TEST_ASSERT(dmini_save_atomic(NULL, base) == DMINI_ERR_INVALID, "NULL context accepted");
+    TEST_ASSERT(dmini_load_atomic(ctx, NULL) == DMINI_ERR_INVALID, "NULL filename accepted");
+
+    Dmod_FileRemove(slot1);
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test a context living in storage declared at compile time
+ */
+static void test_static_context(void)
+{
+    TEST_START("Static context");
+
+    DMINI_STATIC_CONTEXT(storage, 2, 4, 512);
+    dmini_context_t ctx = dmini_create_static(&storage);
+    if (!ctx)
+    {
+        /* Built without static contexts */
+        TEST_PASS();
+        return;
+    }
+
+    TEST_ASSERT(dmini_parse_string(ctx, "[a]\nx = 1\ny = 2\n[b]\nz = 3\n") == DMINI_OK, "Failed to parse");
+    TEST_ASSERT(dmini_get_int(ctx, "b", "z", 0) == 3, "Parsed value missing");
+
+    /* Capacities are hard limits */
+    TEST_ASSERT(dmini_set_string(ctx, "c", "k", "v") == DMINI_ERR_MEMORY, "Third section accepted");
+    TEST_ASSERT(dmini_set_string(ctx, "b", "w", "4") == DMINI_OK, "Failed to add fourth key");
+    TEST_ASSERT(dmini_set_string(ctx, "b", "v", "5") == DMINI_ERR_MEMORY, "Fifth key accepted");
+    TEST_ASSERT(dmini_parse_string(ctx, "[a]\nextra = 1\n") == DMINI_ERR_MEMORY, "Parse beyond capacity accepted");
+
+    /* Removed keys and sections go back to the pools */
+    TEST_ASSERT(dmini_remove_key(ctx, "b", "w") == DMINI_OK, "Failed to remove key");
+    TEST_ASSERT(dmini_set_string(ctx, "b", "v", "5") == DMINI_OK, "Key not recycled");
+    TEST_ASSERT(dmini_remove_section(ctx, "b") == DMINI_OK, "Failed to remove section");
+    TEST_ASSERT(dmini_set_string(ctx, "c", "k", "v") == DMINI_OK, "Section not recycled");
+
+    /* Updates that fit reuse the old copy, so the footprint stays fixed */
+    size_t used = dmini_memory_usage(ctx);
+    for (int i = 0; i < 10000; i++)
+    {
+        TEST_ASSERT(dmini_set_int(ctx, "a", "x", i) == DMINI_OK, "Failed to update value");
+    }
+    TEST_ASSERT(dmini_get_int(ctx, "a", "x", 0) == 9999, "Wrong updated value");
+    TEST_ASSERT(dmini_memory_usage(ctx) == used, "Updates drained the string pool");
+    TEST_ASSERT(dmini_enable_concurrency(ctx) == DMINI_ERR_GENERAL, "Concurrent static context accepted");
+
+    /* Modes that need memory beyond the scratch area are refused */
+    TEST_ASSERT(dmini_freeze(ctx) == NULL, "Snapshot of a static context created");
+    TEST_ASSERT(dmini_enable_format_preserving(ctx) == DMINI_ERR_GENERAL, "Format-preserving static context accepted");
+    TEST_ASSERT(dmini_parse_string(ctx, "[a]\ny = 7\n") == DMINI_OK, "Parse failed after refused modes");
+    TEST_ASSERT(dmini_set_io_buffer_size(ctx, 4096) == DMINI_ERR_INVALID, "Block larger than the scratch area accepted");
+    TEST_ASSERT(dmini_set_io_buffer_size(ctx, DMINI_STATIC_SCRATCH_BYTES / 4 + 1) == DMINI_ERR_INVALID,
+                "Block larger than a quarter of the scratch area accepted");
+    TEST_ASSERT(dmini_set_io_buffer_size(ctx, 64) == DMINI_OK, "Small block refused");
+
+    /* File I/O works from the scratch area, also for lines longer than a block */
+    const char* file = "/tmp/test_dmini_static.ini";
+    char line[300];
+    memset(line, 'v', sizeof(line) - 1);
+    line[sizeof(line) - 1] = '\0';
+    TEST_ASSERT(dmini_set_string(ctx, "c", "long", line) == DMINI_OK, "Failed to set long value");
+    TEST_ASSERT(dmini_generate_file(ctx, file) == DMINI_OK, "Failed to generate file");
+    TEST_ASSERT(dmini_set_io_buffer_size(ctx, 0) == DMINI_OK, "Default block refused");
+    TEST_ASSERT(dmini_generate_file(ctx, file) == DMINI_OK, "Failed to generate file with the default block");
+    dmini_destroy(ctx);
+
+    /* The storage can hold a new context afterwards */
+    ctx = dmini_create_static(&storage);
+    TEST_ASSERT(ctx != NULL, "Failed to reuse storage");
+    TEST_ASSERT(dmini_get_string(ctx, "a", "x", NULL) == NULL, "Old content survived");
+    TEST_ASSERT(dmini_parse_file(ctx, file) == DMINI_OK, "Failed to parse file");
+    TEST_ASSERT(strcmp(dmini_get_string(ctx, "c", "long", ""), line) == 0, "Long value lost");
+    TEST_ASSERT(dmini_get_int(ctx, "a", "x", 0) == 9999, "Value lost");
+
+    /* Storage smaller than its capacities is refused */
+    dmini_static_t small = storage;
+    small.size = DMINI_STATIC_CONTEXT_BYTES;
+    TEST_ASSERT(dmini_create_static(&small) == NULL, "Too small storage accepted");
+    TEST_ASSERT(dmini_create_static(NULL) == NULL, "NULL storage accepted");
+
+    Dmod_FileRemove(file);
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Test merging between contexts with different allocator hooks
+ */
+static void test_merge_allocators(void)
+{
+    TEST_START("Merge across allocators");
+
+    test_allocator_t pool = { 0, 0, 0, -1 };
+    test_allocator_t other = { 0, 0, 0, -1 };
+    dmini_allocator_t pool_hooks = { test_malloc, test_free, NULL, &pool };
+    dmini_allocator_t other_hooks = { test_malloc, test_free, NULL, &other };
+
+    /* Heap nodes are copied into a context with its own hooks */
+    dmini_context_t dst = dmini_create_ex(&pool_hooks, 0, 0);
+    dmini_context_t src = dmini_create();
+    TEST_ASSERT(dst != NULL && src != NULL, "Failed to create contexts");
+    TEST_ASSERT(dmini_parse_string(src, "[s]\nk=v\n") == DMINI_OK, "Failed to parse string");
+    TEST_ASSERT(dmini_merge(dst, src, DMINI_MERGE_OVERWRITE) == DMINI_OK, "Failed to merge");
+    dmini_destroy(src);
+    TEST_ASSERT(strcmp(dmini_get_string(dst, "s", "k", ""), "v") == 0, "Merged value missing");
+    dmini_destroy(dst);
+    TEST_ASSERT(pool.live == 0, "Memory not returned to the allocator");
+
+    /* Nodes of the hooks are not handed to the heap, nor to other user data */
+    src = dmini_create_ex(&pool_hooks, 0, 0);
+    dst = dmini_create();
+    dmini_context_t third = dmini_create_ex(&other_hooks, 0, 0);
+    TEST_ASSERT(src != NULL && dst != NULL && third != NULL, "Failed to create contexts");
+    TEST_ASSERT(dmini_parse_string(src, "[s]\nk=v\n[t]\nx=1\n") == DMINI_OK, "Failed to parse string");
+    TEST_ASSERT(dmini_merge(third, src, DMINI_MERGE_OVERWRITE) == DMINI_OK, "Failed to merge");
+    TEST_ASSERT(dmini_merge(dst, third, DMINI_MERGE_OVERWRITE) == DMINI_OK, "Failed to merge");
+    dmini_destroy(src);
+    dmini_destroy(third);
+    TEST_ASSERT(pool.live == 0 && other.live == 0, "Nodes moved to a context with other hooks");
+    TEST_ASSERT(dmini_get_int(dst, "t", "x", 0) == 1, "Merged value missing");
+    dmini_destroy(dst);
+
+    /* Contexts sharing the hooks still move their nodes */
+    src = dmini_create_ex(&pool_hooks, 0, 0);
+    dst = dmini_create_ex(&pool_hooks, 0, 0);
+    TEST_ASSERT(src != NULL && dst != NULL, "Failed to create contexts");
+    TEST_ASSERT(dmini_parse_string(src, "[s]\nk=v\n") == DMINI_OK, "Failed to parse string");
+    int calls = pool.calls;
+    TEST_ASSERT(dmini_merge(dst, src, DMINI_MERGE_OVERWRITE) == DMINI_OK, "Failed to merge");
+    TEST_ASSERT(pool.calls - calls == 2, "Nodes copied between contexts sharing hooks");
+    dmini_destroy(src);
+    dmini_destroy(dst);
+    TEST_ASSERT(pool.live == 0, "Memory not returned to the allocator");
+
+    TEST_PASS();
+}
+
+/**
+ * @brief Test that a static context reuses the string pool across updates
+ */
+static void test_static_pool(void)
+{
+    TEST_START("Static context string pool");
+
+    DMINI_STATIC_CONTEXT(storage, 4, 8, 256);
+    dmini_context_t ctx = dmini_create_static(&storage);
+    if (!ctx)
+    {
+        /* Built without static contexts */
+        TEST_PASS();
+        return;
+    }
+
+    /* A value switching between sizes keeps reusing the freed blocks */
+    for (int i = 0; i < 1000; i++)
+    {
+        TEST_ASSERT(dmini_set_string(ctx, "s", "k", (i & 1) ? "1" : "01234567890123456789") == DMINI_OK,
+                    "Pool drained by updates");
+    }
+
+    /* Full capacity: sections and keys are removed and set again with changing lengths */
+    static const char* values[] = { "a", "0123456789", "off", "0123456789abcdefghij" };
+    static const char* sections[] = { "s", "uart", "wifi", "display" };
+    static const char* keys[] = { "k", "mode" };
+    size_t used = 0;
+    for (int round = 0; round < 500; round++)
+    {
+        for (int sec = 0; sec < 4; sec++)
+        {
+            for (int key = 0; key < 2; key++)
+            {
+                TEST_ASSERT(dmini_set_string(ctx, sections[sec], keys[key], values[(round + sec + key) & 3]) == DMINI_OK,
+                            "Failed to set at full capacity");
+            }
+        }
+        TEST_ASSERT(dmini_set_string(ctx, "extra", "k", "v") == DMINI_ERR_MEMORY, "Capacity exceeded");
+
+        TEST_ASSERT(dmini_remove_key(ctx, "uart", "mode") == DMINI_OK, "Failed to remove key");
+        TEST_ASSERT(dmini_remove_section(ctx, sections[1 + round % 3]) == DMINI_OK, "Failed to remove section");
+        /* The pattern repeats every 12 rounds; later rounds must not need more */
+        size_t now = dmini_memory_usage(ctx);
+        if (round < 48)
+        {
+            used = now > used ? now : used;
+        }
+        else
+        {
+            TEST_ASSERT(now <= used, "Pool grows with the number of updates");
+        }
+    }
+    TEST_ASSERT(dmini_get_string(ctx, "s", "k", NULL) != NULL, "Value lost");
+
+    dmini_destroy(ctx);
+    TEST_PASS();
+}
+
+/**
+ * @brief Fill a span that holds no delimiter, mixing letters with bytes >= 0x80
+ *
+ * The high bytes include each delimiter with its top bit set, which a word
+ * compare must not take for the delimiter itself.
+ */
+static void scan_filler(char* out, size_t len)
+{
+    static const unsigned char high[] = { 0x80 | '=', 0x80 | '\n', 0x80 | ']', 0x80 | ';', 0x80 | '\r',
+                                          0x80, 0xFF, 0xC3, 0xA9, 0x80 | '#' };
+    for (size_t i = 0; i < len; i++)
+    {
+        out[i] = (i % 3 == 0) ? (char)('a' + i % 26) : (char)high[i % sizeof(high)];
+    }
+    out[len] = '\0';
+}
+
+/**
+ * @brief Test: Delimiters at every offset of the word-at-a-time scanner
+ */
+static void test_scan_delimiters(void)
+{
+    TEST_START("Delimiters at every scan offset");
+
+    char fill[48];
+    char doc[256];
+
+    /* Two 16-byte blocks and a partial one, so every offset of a word and a vector is hit */
+    for (size_t k = 0; k <= 40; k++)
+    {
+        scan_filler(fill, k);
+        dmini_context_t ctx = dmini_create();
+        TEST_ASSERT(ctx != NULL, "Failed to create context");
+
+        /* Line ends at offset k: \n, \r\n and a bare \r, each followed by a pair that must be seen */
+        Dmod_SnPrintf(doc, sizeof(doc), "%s\na=1\n%s\r\nb=2\n%s\rc=3\n", fill, fill, fill);
+        TEST_ASSERT(dmini_parse_string(ctx, doc) == DMINI_OK, "Failed to parse line ends");
+        TEST_ASSERT(dmini_get_int(ctx, NULL, "a", 0) == 1, "Missed \\n");
+        TEST_ASSERT(dmini_get_int(ctx, NULL, "b", 0) == 2, "Missed \\r\\n");
+        TEST_ASSERT(dmini_get_int(ctx, NULL, "c", 0) == 3, "Missed \\r");
+
+        /* '=' and ';' at offset k of the key and the value, ']' after k + 1 name bytes */
+        Dmod_SnPrintf(doc, sizeof(doc), "[s%s]\nk%s=%s;c\nv=%s#c\n", fill, fill, fill, fill);
+        TEST_ASSERT(dmini_parse_string(ctx, doc) == DMINI_OK, "Failed to parse delimiters");
+        char name[64];
+        Dmod_SnPrintf(name, sizeof(name), "s%s", fill);
+        TEST_ASSERT(dmini_has_section(ctx, name), "Missed ]");
+        Dmod_SnPrintf(doc, sizeof(doc), "k%s", fill);
+        TEST_ASSERT(strcmp(dmini_get_string(ctx, name, doc, "-"), fill) == 0, "Missed = or ;");
+        TEST_ASSERT(strcmp(dmini_get_string(ctx, name, "v", "-"), fill) == 0, "Missed #");
+
+        /* A match in the last partial block: the delimiter and the value end the range */
+        int len = Dmod_SnPrintf(doc, sizeof(doc), "[t]\nx%s=", fill);
+        TEST_ASSERT(dmini_parse_memory(ctx, doc, (size_t)len) == DMINI_OK, "Failed to parse range");
+        Dmod_SnPrintf(name, sizeof(name), "x%s", fill);
+        TEST_ASSERT(dmini_has_key(ctx, "t", name), "Missed = ending the range");
+        len = Dmod_SnPrintf(doc, sizeof(doc), "[t]\ny=%s", fill);
+        TEST_ASSERT(dmini_parse_memory(ctx, doc, (size_t)len) == DMINI_OK, "Failed to parse range");
+        TEST_ASSERT(strcmp(dmini_get_string(ctx, "t", "y", "-"), fill) == 0, "Value read past the range");
+
+        /* A NUL at offset k of a value ends the document */
+        len = Dmod_SnPrintf(doc, sizeof(doc), "[u]\nz=%s", fill);
+        memcpy(doc + len, "\0w=1\n", 5);
+        TEST_ASSERT(dmini_parse_memory(ctx, doc, (size_t)len + 5) == DMINI_OK, "Failed to parse NUL");
+        TEST_ASSERT(strcmp(dmini_get_string(ctx, "u", "z", "-"), fill) == 0, "Missed NUL");
+        TEST_ASSERT(!dmini_has_key(ctx, "u", "w"), "Parsed past NUL");
+
+        dmini_destroy(ctx);
+    }
+
+    TEST_PASS();
+}
+
 
 int main(int argc, char** argv)
 {
@@ -538,6 +2825,38 @@ int main(int argc, char** argv)
     test_inline_comments();
     test_iteration();
     test_active_section();
+    test_many_sections_keys();
+    test_arena();
+    test_parse_inplace();
+    test_parse_memory();
+    test_parse_chunked();
+    test_file_long_lines();
+    test_generate_file_buffered();
+    test_generate_size_tracking();
+    test_append_after_remove();
+    test_handles();
+    test_typed_values();
+    test_iterators();
+    test_get_batch();
+    test_concurrency();
+    test_freeze();
+    test_binary_image();
+    test_save_changes();
+    test_save_changes_torn();
+    test_open_lazy();
+    test_parse_file_section();
+    test_stats();
+    test_watch();
+    test_merge_diff();
+    test_interning();
+    test_create_ex();
+    test_format_preserving();
+    test_parse_parallel();
+    test_atomic_save();
+    test_static_context();
+    test_merge_allocators();
+    test_static_pool();
+    test_scan_delimiters();
     
     // Print summary
     Dmod_Printf("\n=== Test Summary ===\n");
@@ -27,6 +27,23 @@
 #define DMINI_ERR_NOT_FOUND    -4
 #define DMINI_ERR_FILE         -5
 #define DMINI_ERR_LOCKED       -6
+#define DMINI_ERR_READONLY     -7
+
+/**
+ * @brief Value types for dmini_get_batch()
+ */
+#define DMINI_TYPE_STRING       0   /* out: const char*  default: .s   */
+#define DMINI_TYPE_INT          1   /* out: int          default: .i   */
+#define DMINI_TYPE_INT64        2   /* out: int64_t      default: .i64 */
+#define DMINI_TYPE_FLOAT        3   /* out: float        default: .f   */
+#define DMINI_TYPE_BOOL         4   /* out: int          default: .i   */
+
+/**
+ * @brief Policies for dmini_merge()
+ */
+#define DMINI_MERGE_OVERWRITE   0   /* values of the source replace existing ones */
+#define DMINI_MERGE_KEEP        1   /* existing values are kept, missing keys added */
+#define DMINI_MERGE_REPLACE     2   /* destination ends up with the source content */
 
 /**
  * @brief INI context type (opaque)
@@ -35,6 +52,201 @@
  */
 typedef struct dmini_context* dmini_context_t;
 
+/**
+ * @brief Read-only snapshot of a context
+ *
+ * Created by dmini_freeze(). A snapshot is an ordinary context handle, so all
+ * read, query, iteration and generation functions accept it; functions that
+ * modify a context return DMINI_ERR_READONLY.
+ */
+typedef dmini_context_t dmini_snapshot_t;
+
+/**
+ * @brief Pre-resolved key handle
+ * 
+ * Returned by dmini_lookup(). The fields are private to the module; a handle
+ * stays valid until a key or section is removed or the active section is
+ * changed, after which the handle accessors return their default values.
+ */
+typedef struct
+{
+    void* pair;
+    unsigned int generation;
+} dmini_handle_t;
+
+/**
+ * @brief Iterator over sections or over the keys of a section
+ * 
+ * Initialized by dmini_iter_sections() or dmini_iter_pairs(). The fields are
+ * private to the module.
+ */
+typedef struct
+{
+    dmini_context_t ctx;
+    void* node;
+    unsigned int generation;
+} dmini_iter_t;
+
+/**
+ * @brief Key-value pair returned by dmini_next_pair()
+ * 
+ * The strings are owned by the context and stay valid until the key is
+ * changed or removed.
+ */
+typedef struct
+{
+    const char* key;
+    const char* value;
+    size_t key_len;
+    size_t value_len;
+} dmini_entry_t;
+
+/**
+ * @brief Single key request for dmini_get_batch()
+ */
+typedef struct
+{
+    const char* key;                /* key name */
+    int type;                       /* DMINI_TYPE_* */
+    union
+    {
+        const char* s;
+        int i;
+        int64_t i64;
+        float f;
+    } default_value;                /* value stored when the key is missing */
+    void* out;                      /* output of the type selected by type */
+} dmini_query_t;
+
+/**
+ * @brief Memory hooks of a context created with dmini_create_ex()
+ *
+ * malloc_fn and free_fn are required and must return memory aligned to at
+ * least 8 bytes. realloc_fn is optional; it must accept a NULL pointer, and
+ * when it is missing buffers are grown by allocating, copying and freeing.
+ * Every hook receives the user pointer.
+ */
+typedef struct
+{
+    void* (*malloc_fn)(size_t size, void* user);
+    void (*free_fn)(void* ptr, void* user);
+    void* (*realloc_fn)(void* ptr, size_t size, void* user);
+    void* user;
+} dmini_allocator_t;
+
+/**
+ * @brief Upper bounds of the memory of a static context
+ *
+ * Bytes of the context itself, of one section and of one key, valid for every
+ * build configuration; the module checks them against the real sizes when it
+ * is compiled. DMINI_STATIC_SCRATCH_BYTES is the area temporary buffers (file
+ * I/O blocks, partial lines) are taken from instead of the heap.
+ */
+#define DMINI_STATIC_CONTEXT_BYTES  768
+#define DMINI_STATIC_SECTION_BYTES  96
+#define DMINI_STATIC_PAIR_BYTES     64
+#ifndef DMINI_STATIC_SCRATCH_BYTES
+#   define DMINI_STATIC_SCRATCH_BYTES   1024
+#endif
+
+/**
+ * @brief Bytes a static context needs for the given capacities
+ *
+ * The global section comes on top of @p max_sections.
+ */
+#define DMINI_STATIC_SIZE(max_sections, max_pairs, string_pool_bytes) \
+    (DMINI_STATIC_CONTEXT_BYTES + DMINI_STATIC_SCRATCH_BYTES + \
+     ((size_t)(max_sections) + 1) * DMINI_STATIC_SECTION_BYTES + \
+     (size_t)(max_pairs) * DMINI_STATIC_PAIR_BYTES + (size_t)(string_pool_bytes))
+
+/**
+ * @brief Storage of a static context, declared with DMINI_STATIC_CONTEXT()
+ */
+typedef struct
+{
+    void* memory;                   /* 8-byte aligned, DMINI_STATIC_SIZE() bytes */
+    size_t size;
+    unsigned int max_sections;      /* named sections, without the global section */
+    unsigned int max_pairs;         /* keys of all sections together */
+} dmini_static_t;
+
+/**
+ * @brief Declare the storage of a static context
+ *
+ * Declares a static array sized for the capacities and a dmini_static_t
+ * @p name describing it, to be passed to dmini_create_static(). The whole
+ * footprint is visible in the link map.
+ */
+#define DMINI_STATIC_CONTEXT(name, max_sections, max_pairs, string_pool_bytes) \
+    static uint64_t name##_memory[(DMINI_STATIC_SIZE(max_sections, max_pairs, string_pool_bytes) + 7) / 8]; \
+    static dmini_static_t name = { name##_memory, sizeof(name##_memory), (max_sections), (max_pairs) }
+
+/**
+ * @brief Change callback registered with dmini_watch()
+ *
+ * @param ctx     Context that changed
+ * @param section Section of the key (NULL for the global section)
+ * @param key     Key whose value changed
+ * @param value   New value, or NULL when the key was removed
+ * @param user    Pointer passed to dmini_watch()
+ */
+typedef void (*dmini_watch_callback_t)(dmini_context_t ctx, const char* section, const char* key,
+                                       const char* value, void* user);
+
+/**
+ * @brief Difference callback of dmini_diff()
+ *
+ * @param section   Section of the key (NULL for the global section)
+ * @param key       Key that differs
+ * @param old_value Value in the first context, NULL when the key was added
+ * @param new_value Value in the second context, NULL when the key was removed
+ * @param user      Pointer passed to dmini_diff()
+ */
+typedef void (*dmini_diff_callback_t)(const char* section, const char* key, const char* old_value,
+                                      const char* new_value, void* user);
+
+/**
+ * @brief Task run by dmini_parse_parallel()
+ *
+ * @param arg Argument of the task
+ */
+typedef void (*dmini_task_t)(void* arg);
+
+/**
+ * @brief Executor hook of dmini_parse_parallel()
+ *
+ * Must call task(args[i]) once for every i below count, in any order and on
+ * any threads, and return only when all calls have returned.
+ *
+ * @param task  Function to run
+ * @param args  Argument of each call
+ * @param count Number of calls
+ * @param user  Pointer passed to dmini_parse_parallel()
+ */
+typedef void (*dmini_run_tasks_t)(dmini_task_t task, void** args, unsigned int count, void* user);
+
+/**
+ * @brief Counters returned by dmini_get_stats()
+ *
+ * Collected only when the module is built with DMINI_USE_STATS (CMake option
+ * DMINI_STATS). Counters wrap around at 2^32.
+ */
+typedef struct
+{
+    uint32_t section_lookups;       /* sections looked up by name */
+    uint32_t section_misses;        /* section lookups that found nothing */
+    uint32_t pair_lookups;          /* keys looked up within a section */
+    uint32_t pair_misses;           /* key lookups that found nothing */
+    uint32_t nodes_visited;         /* list nodes and index slots examined by the lookups */
+    uint32_t allocations;           /* allocations made from context memory */
+    uint32_t parse_calls;           /* parse calls, including lazily loaded sections */
+    uint32_t parse_lines;           /* lines processed by the parser */
+    uint32_t parse_time_ms;         /* time spent in parse calls */
+    uint32_t generate_bytes;        /* bytes written by the generators */
+    uint32_t active_rejections;     /* accesses refused by the active-section restriction */
+    size_t bytes_held;              /* dmini_memory_usage() at the time of the query */
+} dmini_stats_t;
+
 /**
  * @brief Initialize INI context
  * 
@@ -64,10 +276,113 @@ dmod_dmini_api(1.0, void, _destroy, (dmini_context_t ctx));
  */
 dmod_dmini_api(1.0, int, _parse_string, (dmini_context_t ctx, const char* data));
 
+/**
+ * @brief Parse INI data from a memory range
+ *
+ * Parses @p len bytes starting at @p data. The data does not have to be
+ * NUL-terminated and is only read, never written or copied as a whole, so it
+ * can be parsed straight out of memory-mapped or XIP flash. Keys, values and
+ * section names are copied into the context. Uses the same tokenizer as
+ * dmini_parse_string(); parsing stops early at a NUL character.
+ *
+ * @param ctx  INI context
+ * @param data Start of the INI file contents
+ * @param len  Number of bytes to parse
+ * @return DMINI_OK on success, error code on failure
+ */
+dmod_dmini_api(1.0, int, _parse_memory, (dmini_context_t ctx, const char* data, size_t len));
+
+/**
+ * @brief Parse INI data in place
+ *
+ * Parses @p len bytes of @p buffer without copying them. The buffer is
+ * tokenized in place (line terminators and delimiters are overwritten with
+ * NUL characters) and keys, values and section names reference it directly.
+ * A value overwritten later with dmini_set_string() is copied into the
+ * context; the buffer itself is never written again.
+ *
+ * The buffer is borrowed, not owned: it must stay valid and unmodified until
+ * the context is destroyed. Parsing stops at the first NUL character.
+ *
+ * @param ctx    INI context
+ * @param buffer Mutable buffer with INI file contents
+ * @param len    Number of bytes in @p buffer
+ * @return DMINI_OK on success, error code on failure
+ */
+dmod_dmini_api(1.0, int, _parse_buffer_inplace, (dmini_context_t ctx, char* buffer, size_t len));
+
+/**
+ * @brief Parse a large INI document on several threads
+ *
+ * Splits the range at [section] lines into up to @p workers chunks, parses
+ * every chunk into a private context through @p run and splices the results
+ * into @p ctx in document order. Repeated sections are merged and later
+ * values win exactly as with dmini_parse_memory(), which is also used when
+ * @p run is NULL, @p workers is below 2, the document is too small to be
+ * worth splitting or the module was built without the parallel parser. The
+ * allocator of the context must be safe to call from several threads.
+ *
+ * @param ctx     INI context
+ * @param data    Start of the INI file contents
+ * @param len     Number of bytes to parse
+ * @param workers Maximum number of chunks parsed at once
+ * @param run     Executor running the chunk tasks (NULL = parse serially)
+ * @param user    Pointer passed to @p run
+ * @return DMINI_OK on success, error code on failure (the chunks before a
+ *         failing one are kept, as a serial parse would keep their lines)
+ */
+dmod_dmini_api(1.0, int, _parse_parallel, (dmini_context_t ctx, const char* data, size_t len,
+                                           unsigned int workers, dmini_run_tasks_t run, void* user));
+
+/**
+ * @brief Start chunked parsing
+ *
+ * Prepares the context for receiving INI data in arbitrary-sized chunks via
+ * dmini_parse_feed(). Only one chunked parse can be active per context.
+ * Every successful call must be matched by dmini_parse_end().
+ *
+ * @param ctx INI context
+ * @return DMINI_OK on success, DMINI_ERR_INVALID if ctx is NULL or a chunked
+ *         parse is already active, DMINI_ERR_MEMORY on allocation failure
+ */
+dmod_dmini_api(1.0, int, _parse_begin, (dmini_context_t ctx));
+
+/**
+ * @brief Feed a chunk of INI data
+ *
+ * Parses the lines completed by @p chunk. A line may be split across any
+ * number of chunks; only the unfinished part of a line is buffered, so memory
+ * use is bounded by the longest line, not by the document. The chunk can be
+ * reused by the caller as soon as the function returns.
+ *
+ * After an error, further chunks are ignored and the same error is returned.
+ *
+ * @param ctx   INI context
+ * @param chunk Chunk of INI data (does not need to be NUL-terminated)
+ * @param len   Number of bytes in @p chunk
+ * @return DMINI_OK on success, error code on failure
+ */
+dmod_dmini_api(1.0, int, _parse_feed, (dmini_context_t ctx, const char* chunk, size_t len));
+
+/**
+ * @brief Finish chunked parsing
+ *
+ * Parses the last line if it was not terminated and releases the chunked
+ * parser state.
+ *
+ * @param ctx INI context
+ * @return DMINI_OK on success, the first error reported by the chunks,
+ *         or DMINI_ERR_INVALID if no chunked parse is active
+ */
+dmod_dmini_api(1.0, int, _parse_end, (dmini_context_t ctx));
+
 /**
  * @brief Parse INI file
  * 
  * Parses an INI file from a file path using SAL file functions.
+ * The file is read in blocks of the I/O buffer size (see
+ * dmini_set_io_buffer_size()) and lines are split from the block, so lines
+ * of any length are supported.
  * 
  * @param ctx INI context
  * @param filename Path to INI file
@@ -75,12 +390,62 @@ dmod_dmini_api(1.0, int, _parse_string, (dmini_context_t ctx, const char* data))
  */
 dmod_dmini_api(1.0, int, _parse_file, (dmini_context_t ctx, const char* filename));
 
+/**
+ * @brief Parse only one section of an INI file
+ *
+ * Works like dmini_parse_file(), but lines outside @p section are skipped
+ * without being tokenized and other sections are never created, so a module
+ * that owns one section pays only for that section. Repeated occurrences of
+ * the section are merged as usual. Combined with dmini_create_with_token()
+ * and dmini_set_active_section() this gives a module a cheap private view of
+ * a shared file.
+ *
+ * A file parsed this way is not a sync baseline for dmini_save_changes(),
+ * because the context holds only part of it.
+ *
+ * @param ctx      INI context
+ * @param filename Path to INI file
+ * @param section  Section to load (NULL for the global section)
+ * @return DMINI_OK on success (also when the file has no such section),
+ *         error code on failure
+ */
+dmod_dmini_api(1.0, int, _parse_file_section, (dmini_context_t ctx, const char* filename, const char* section));
+
+/**
+ * @brief Open an INI file and parse its sections on demand
+ *
+ * A single scan of the file creates the sections and remembers where the
+ * pairs of each one are; no pairs are parsed. The first lookup of a section
+ * (any getter, setter, dmini_has_section(), dmini_key_count(), ...) parses
+ * its pairs from the file, so startup time and memory follow the sections
+ * actually used rather than the size of the file. Section names and counts
+ * are available right away.
+ *
+ * The file is reopened for every section that is loaded and must not change
+ * until everything is loaded; appending with dmini_save_changes() is fine.
+ * dmini_generate_string(), dmini_generate_file(), dmini_freeze(),
+ * dmini_export_binary() and dmini_enable_concurrency() load the remaining
+ * sections first. A context in concurrent mode parses the whole file at once.
+ * If a section fails to load, it stays incomplete and the next lookup retries.
+ *
+ * Opened into an empty context, the file becomes the synced file of
+ * dmini_save_changes(), as with dmini_parse_file().
+ *
+ * @param ctx      INI context
+ * @param filename Path to INI file
+ * @return DMINI_OK on success, DMINI_ERR_INVALID on NULL arguments,
+ *         DMINI_ERR_FILE if the file cannot be read, DMINI_ERR_MEMORY if
+ *         memory runs out, DMINI_ERR_READONLY for snapshots
+ */
+dmod_dmini_api(1.0, int, _open_lazy, (dmini_context_t ctx, const char* filename));
+
 /**
  * @brief Generate INI file to string
  * 
  * Generates an INI file string from the context.
  * If buffer is NULL, returns the required buffer size.
  * If buffer is not NULL, fills it with the INI data.
+ * The size is maintained incrementally, so the size query is O(1).
  * 
  * @param ctx INI context
  * @param buffer Buffer to write to (NULL to query size)
@@ -93,6 +458,9 @@ dmod_dmini_api(1.0, int, _generate_string, (dmini_context_t ctx, char* buffer, s
  * @brief Generate INI file
  * 
  * Generates an INI file from the context and writes it to a file.
+ * Output is collected in a buffer of the I/O buffer size (see
+ * dmini_set_io_buffer_size()) and written out only when it is full, so
+ * lines of any length are supported.
  * 
  * @param ctx INI context
  * @param filename Path to output INI file
@@ -100,6 +468,154 @@ dmod_dmini_api(1.0, int, _generate_string, (dmini_context_t ctx, char* buffer, s
  */
 dmod_dmini_api(1.0, int, _generate_file, (dmini_context_t ctx, const char* filename));
 
+/**
+ * @brief Write only what changed since the file was last loaded or saved
+ *
+ * The context remembers the file it was last synced with: a file parsed by
+ * dmini_parse_file() into an empty context, or written by
+ * dmini_generate_file() or dmini_save_changes(). Sections and keys added or
+ * changed since then are appended to that file as repeated section blocks
+ * holding only the changed keys; parsing the file merges them back, so it
+ * reads as the current content. Setting a key to its current value is not a
+ * change.
+ *
+ * Each append is one record announced by a comment line with its length and
+ * CRC-32. dmini_parse_file(), dmini_parse_file_section() and
+ * dmini_open_lazy() apply a record only if it is intact, so a write cut short
+ * by a reset leaves the previous values; the next save rewrites such a file.
+ *
+ * The whole file is rewritten instead when there is no synced file, when
+ * @p filename is a different file, after a removal, after a change to the
+ * global section, under an active-section restriction and once the appended
+ * records would outgrow the content itself.
+ *
+ * @param ctx      INI context
+ * @param filename File to update
+ * @return DMINI_OK on success, DMINI_ERR_INVALID on NULL arguments,
+ *         DMINI_ERR_FILE on I/O failure, DMINI_ERR_MEMORY if the write
+ *         buffer could not be allocated, DMINI_ERR_READONLY for snapshots
+ */
+dmod_dmini_api(1.0, int, _save_changes, (dmini_context_t ctx, const char* filename));
+
+/**
+ * @brief Save the content so that a reset during the write cannot lose it
+ *
+ * Keeps two slot files, @p filename followed by ".0" and ".1", and always
+ * overwrites the one not holding the newest valid content. The slot is
+ * generated like dmini_generate_file() and closed by a trailer comment
+ * carrying a sequence number and the CRC-32 of the text before it, so a slot
+ * is a valid INI file and a torn write is detected when loading. The write
+ * does not read the slots again when the context saved or loaded them last.
+ *
+ * @param ctx      INI context
+ * @param filename Base name of the slot files
+ * @return DMINI_OK on success, DMINI_ERR_INVALID on NULL arguments,
+ *         DMINI_ERR_FILE on I/O failure, DMINI_ERR_MEMORY if the write
+ *         buffer could not be allocated
+ */
+dmod_dmini_api(1.0, int, _save_atomic, (dmini_context_t ctx, const char* filename));
+
+/**
+ * @brief Parse the newest valid slot written by dmini_save_atomic()
+ *
+ * The checksums are verified before anything is parsed: the newest slot
+ * whose text matches its trailer is parsed like dmini_parse_file(), a slot
+ * torn by a reset is skipped without being parsed.
+ *
+ * @param ctx      INI context
+ * @param filename Base name of the slot files
+ * @return DMINI_OK on success, DMINI_ERR_INVALID on NULL arguments,
+ *         DMINI_ERR_FILE if no slot is valid, DMINI_ERR_MEMORY if memory
+ *         runs out, DMINI_ERR_READONLY for snapshots
+ */
+dmod_dmini_api(1.0, int, _load_atomic, (dmini_context_t ctx, const char* filename));
+
+/**
+ * @brief Call a function whenever a value changes
+ *
+ * @p callback runs after dmini_set_string(), dmini_set_int(), a parse or a
+ * removal changed a watched key, and only then: setting a key to its current
+ * value or parsing the same file again notifies nobody, and neither does
+ * loading a section of dmini_open_lazy(). Removing a section reports each of
+ * its keys with a NULL value. Consumers can keep their own copy of a
+ * setting and update it here instead of polling.
+ *
+ * Callbacks run in the task that made the change, with the writer lock held
+ * in concurrent mode. They may read the context and call dmini_watch() or
+ * dmini_unwatch(), but must not modify the context. The value is valid
+ * until the callback returns.
+ *
+ * @param ctx      INI context
+ * @param section  Section to watch (NULL for the global section)
+ * @param key      Key to watch (NULL for every key of the section)
+ * @param callback Function to call
+ * @param user     Pointer passed to the callback
+ * @return DMINI_OK on success, DMINI_ERR_INVALID on a NULL context or
+ *         callback, DMINI_ERR_MEMORY on allocation failure,
+ *         DMINI_ERR_READONLY for snapshots
+ */
+dmod_dmini_api(1.0, int, _watch, (dmini_context_t ctx, const char* section, const char* key,
+                                  dmini_watch_callback_t callback, void* user));
+
+/**
+ * @brief Remove a watch registered with dmini_watch()
+ *
+ * All arguments must match the registration. Safe to call from a callback.
+ *
+ * @return DMINI_OK on success, DMINI_ERR_INVALID on a NULL context or
+ *         callback, DMINI_ERR_NOT_FOUND if no such watch is registered
+ */
+dmod_dmini_api(1.0, int, _unwatch, (dmini_context_t ctx, const char* section, const char* key,
+                                    dmini_watch_callback_t callback, void* user));
+
+/**
+ * @brief Move the content of one context into another
+ *
+ * Merges every section and key of @p src into @p dst according to
+ * @p policy and leaves @p src empty. Pair nodes are moved instead of copied
+ * when neither context is an arena, both allocate through the same hooks
+ * (malloc_fn, free_fn and user of dmini_create_ex()), @p src is not in
+ * concurrent mode and the strings of a pair are not pooled or borrowed;
+ * otherwise they are copied into @p dst. Only real changes
+ * mark @p dst dirty or notify its watches, so merging a freshly parsed file
+ * with DMINI_MERGE_REPLACE applies just the delta of a hot reload.
+ *
+ * Lookups in @p dst are hashed when DMINI_USE_HASH_INDEX is enabled, so the
+ * merge is linear in the size of both contexts. When both are in
+ * concurrent mode, tasks merging in opposite directions may deadlock.
+ *
+ * @param dst    Context receiving the content
+ * @param src    Context giving up its content
+ * @param policy DMINI_MERGE_OVERWRITE, DMINI_MERGE_KEEP or DMINI_MERGE_REPLACE
+ * @return DMINI_OK on success, DMINI_ERR_INVALID on NULL or equal contexts,
+ *         an unknown policy or an active chunked parse, DMINI_ERR_LOCKED if
+ *         either context has an active-section restriction,
+ *         DMINI_ERR_MEMORY on allocation failure (the keys not merged yet
+ *         stay in @p src), DMINI_ERR_READONLY for snapshots
+ */
+dmod_dmini_api(1.0, int, _merge, (dmini_context_t dst, dmini_context_t src, int policy));
+
+/**
+ * @brief Report the keys that differ between two contexts
+ *
+ * Calls @p callback for every key that is only in @p from (removed), only
+ * in @p to (added) or has different values in both (changed). Sections
+ * without keys are not compared. Keys are looked up starting after the
+ * previous match, so contexts with the same key order are compared in one
+ * walk even without a hash index. Under an active-section restriction only
+ * the visible section of a context takes part. The callback must not
+ * modify either context.
+ *
+ * @param from     Old content
+ * @param to       New content
+ * @param callback Function to call (NULL to only count the differences)
+ * @param user     Pointer passed to the callback
+ * @return Number of differences (0 when the contents are equal),
+ *         DMINI_ERR_INVALID on NULL contexts or snapshots
+ */
+dmod_dmini_api(1.0, int, _diff, (dmini_context_t from, dmini_context_t to,
+                                 dmini_diff_callback_t callback, void* user));
+
 /**
  * @brief Get string value from INI context
  * 
@@ -119,7 +635,9 @@ dmod_dmini_api(1.0, const char*, _get_string, (dmini_context_t ctx,
 /**
  * @brief Get integer value from INI context
  * 
- * Retrieves an integer value for the given section and key.
+ * Retrieves an integer value for the given section and key. Decimal values
+ * and hex values with a 0x prefix are accepted. The converted value is
+ * cached in the key, so repeated reads do not parse the string again.
  * 
  * @param ctx INI context
  * @param section Section name (NULL for global section)
@@ -132,6 +650,128 @@ dmod_dmini_api(1.0, int, _get_int, (dmini_context_t ctx,
                                      const char* key, 
                                      int default_value));
 
+/**
+ * @brief Get 64-bit integer value from INI context
+ * 
+ * Same as dmini_get_int() for values that do not fit in an int.
+ * 
+ * @param ctx INI context
+ * @param section Section name (NULL for global section)
+ * @param key Key name
+ * @param default_value Default value if key not found
+ * @return Integer value or default_value if not found
+ */
+dmod_dmini_api(1.0, int64_t, _get_int64, (dmini_context_t ctx, 
+                                          const char* section, 
+                                          const char* key, 
+                                          int64_t default_value));
+
+/**
+ * @brief Get floating-point value from INI context
+ * 
+ * Accepts decimal values with an optional fraction and exponent
+ * (e.g. 1.5, -.25, 6e-3) and hex integers with a 0x prefix. The converted
+ * value is cached in the key.
+ * 
+ * @param ctx INI context
+ * @param section Section name (NULL for global section)
+ * @param key Key name
+ * @param default_value Default value if key not found
+ * @return Float value or default_value if not found
+ */
+dmod_dmini_api(1.0, float, _get_float, (dmini_context_t ctx, 
+                                        const char* section, 
+                                        const char* key, 
+                                        float default_value));
+
+/**
+ * @brief Get boolean value from INI context
+ * 
+ * Recognizes 1/true/yes/on and 0/false/no/off, ignoring case.
+ * 
+ * @param ctx INI context
+ * @param section Section name (NULL for global section)
+ * @param key Key name
+ * @param default_value Default value if key not found or not a boolean
+ * @return 1, 0, or default_value if the key is missing or not a boolean
+ */
+dmod_dmini_api(1.0, int, _get_bool, (dmini_context_t ctx, 
+                                      const char* section, 
+                                      const char* key, 
+                                      int default_value));
+
+/**
+ * @brief Get many values from one section at once
+ *
+ * Resolves the section once and then each query with a single probe of the
+ * key index (or, without the index, by continuing the list walk from the
+ * previous match, so queries in file order cost one pass). Every output
+ * receives either the converted value or the query default; a missing
+ * section fills all outputs with their defaults.
+ *
+ * @param ctx     INI context
+ * @param section Section name (NULL for global section)
+ * @param queries Array of queries
+ * @param count   Number of queries
+ * @return Number of keys found, or DMINI_ERR_INVALID on invalid arguments
+ */
+dmod_dmini_api(1.0, int, _get_batch, (dmini_context_t ctx,
+                                       const char* section,
+                                       const dmini_query_t* queries,
+                                       size_t count));
+
+/**
+ * @brief Resolve a key to a handle for repeated reads
+ * 
+ * Performs the section and key lookup once. The returned handle can be read
+ * with dmini_handle_get_string() / dmini_handle_get_int() without repeating
+ * the lookup, and always sees the current value of the key. The handle is
+ * invalidated by dmini_remove_key(), dmini_remove_section(),
+ * dmini_set_active_section() and dmini_clear_active_section(); resolve it
+ * again after any of these.
+ * 
+ * @param ctx INI context
+ * @param section Section name (NULL for global section)
+ * @param key Key name
+ * @return Handle to the key (invalid if the key was not found)
+ */
+dmod_dmini_api(1.0, dmini_handle_t, _lookup, (dmini_context_t ctx, 
+                                              const char* section, 
+                                              const char* key));
+
+/**
+ * @brief Check whether a handle can still be used
+ * 
+ * @param ctx INI context the handle was resolved in
+ * @param handle Handle returned by dmini_lookup()
+ * @return 1 if the handle is valid, 0 otherwise
+ */
+dmod_dmini_api(1.0, int, _handle_valid, (dmini_context_t ctx, dmini_handle_t handle));
+
+/**
+ * @brief Get string value through a handle
+ * 
+ * @param ctx INI context the handle was resolved in
+ * @param handle Handle returned by dmini_lookup()
+ * @param default_value Default value if the handle is invalid
+ * @return Value string or default_value if the handle is invalid
+ */
+dmod_dmini_api(1.0, const char*, _handle_get_string, (dmini_context_t ctx, 
+                                                      dmini_handle_t handle, 
+                                                      const char* default_value));
+
+/**
+ * @brief Get integer value through a handle
+ * 
+ * @param ctx INI context the handle was resolved in
+ * @param handle Handle returned by dmini_lookup()
+ * @param default_value Default value if the handle is invalid
+ * @return Integer value or default_value if the handle is invalid
+ */
+dmod_dmini_api(1.0, int, _handle_get_int, (dmini_context_t ctx, 
+                                           dmini_handle_t handle, 
+                                           int default_value));
+
 /**
  * @brief Set string value in INI context
  * 
@@ -262,6 +902,106 @@ dmod_dmini_api(1.0, const char*, _key_name, (dmini_context_t ctx,
                                               const char* section,
                                               int index));
 
+/**
+ * @brief Start iterating over sections
+ *
+ * Sections are returned in order by dmini_next_section(), each in O(1).
+ * Respects the active-section restriction when it is in effect.
+ * Removing a key or section, or changing the active section, ends the
+ * iteration.
+ *
+ * @param ctx  INI context
+ * @param iter Iterator to initialize
+ * @return DMINI_OK on success, DMINI_ERR_INVALID if ctx or iter is NULL
+ */
+dmod_dmini_api(1.0, int, _iter_sections, (dmini_context_t ctx, dmini_iter_t* iter));
+
+/**
+ * @brief Get the next section from an iterator
+ *
+ * @param iter     Iterator initialized by dmini_iter_sections()
+ * @param name     Receives the section name (NULL for the global section)
+ * @param name_len Receives the length of the name (may be NULL)
+ * @return 1 if a section was returned, 0 at the end of the iteration
+ */
+dmod_dmini_api(1.0, int, _next_section, (dmini_iter_t* iter,
+                                          const char** name,
+                                          size_t* name_len));
+
+/**
+ * @brief Start iterating over the keys of a section
+ *
+ * Keys are returned in order by dmini_next_pair() together with their
+ * values and lengths, each in O(1). Respects the active-section restriction
+ * when it is in effect. Removing a key or section, or changing the active
+ * section, ends the iteration.
+ *
+ * @param ctx     INI context
+ * @param section Section name (NULL for global section)
+ * @param iter    Iterator to initialize
+ * @return DMINI_OK on success, DMINI_ERR_INVALID if ctx or iter is NULL,
+ *         or DMINI_ERR_NOT_FOUND if section does not exist
+ */
+dmod_dmini_api(1.0, int, _iter_pairs, (dmini_context_t ctx,
+                                        const char* section,
+                                        dmini_iter_t* iter));
+
+/**
+ * @brief Get the next key-value pair from an iterator
+ *
+ * @param iter  Iterator initialized by dmini_iter_pairs()
+ * @param entry Receives the key, value and their lengths
+ * @return 1 if a pair was returned, 0 at the end of the iteration
+ */
+dmod_dmini_api(1.0, int, _next_pair, (dmini_iter_t* iter, dmini_entry_t* entry));
+
+/**
+ * @brief Enable the concurrent mode of a context
+ *
+ * After this call any number of tasks may read the context while one or more
+ * tasks modify it. Writers are serialized by a mutex; readers take no lock.
+ * Memory replaced or removed by a writer is reclaimed only after every reader
+ * that could still see it has called dmini_read_end(), so readers never
+ * block and never see freed memory.
+ *
+ * Every read API is safe on its own. A string returned by
+ * dmini_get_string() (or any other pointer into the context) stays valid
+ * only while the caller is inside a dmini_read_begin() / dmini_read_end()
+ * pair. Concurrent mode disables the converted-value cache and the cursors
+ * of dmini_section_name() / dmini_key_name(), because readers must not write
+ * to the context. A chunked parse (dmini_parse_begin() ... dmini_parse_end())
+ * must not be interleaved with removals from other tasks.
+ *
+ * Must be called before the context is shared. It cannot be disabled again.
+ *
+ * @param ctx INI context
+ * @return DMINI_OK on success, DMINI_ERR_MEMORY if the mutex could not be
+ *         created, DMINI_ERR_GENERAL if the module was built without
+ *         concurrency support
+ */
+dmod_dmini_api(1.0, int, _enable_concurrency, (dmini_context_t ctx));
+
+/**
+ * @brief Enter a read-side section
+ *
+ * Pointers obtained from the context between dmini_read_begin() and the
+ * matching dmini_read_end() stay valid even if a writer replaces or removes
+ * the data meanwhile. Sections may be nested and never block. Does nothing
+ * for contexts that are not in concurrent mode.
+ *
+ * @param ctx INI context
+ * @return Token to pass to dmini_read_end()
+ */
+dmod_dmini_api(1.0, unsigned int, _read_begin, (dmini_context_t ctx));
+
+/**
+ * @brief Leave a read-side section
+ *
+ * @param ctx   INI context
+ * @param token Value returned by the matching dmini_read_begin()
+ */
+dmod_dmini_api(1.0, void, _read_end, (dmini_context_t ctx, unsigned int token));
+
 /**
  * @brief Initialize INI context with owner token
  *
@@ -275,6 +1015,221 @@ dmod_dmini_api(1.0, const char*, _key_name, (dmini_context_t ctx,
  */
 dmod_dmini_api(1.0, dmini_context_t, _create_with_token, (unsigned int owner_token));
 
+/**
+ * @brief Initialize INI context backed by an arena
+ *
+ * Creates a new INI context whose nodes and strings (and the context itself)
+ * are bump-allocated from an arena instead of individual Dmod_Malloc calls.
+ *
+ * If @p buffer is not NULL, the arena is the caller-provided memory block of
+ * @p size bytes. It never grows: operations that do not fit return
+ * DMINI_ERR_MEMORY. The buffer must stay valid until dmini_destroy() and is
+ * not freed by it.
+ *
+ * If @p buffer is NULL, the arena is grown internally in blocks of @p size
+ * bytes (0 selects the default block size).
+ *
+ * Memory released by overwriting or removing entries is reused only when it
+ * was the most recent allocation; everything is released at once by
+ * dmini_destroy(), which does not walk the nodes.
+ *
+ * @param buffer Arena memory (NULL = allocate blocks internally)
+ * @param size   Size of @p buffer, or block size when @p buffer is NULL
+ * @return Pointer to INI context or NULL on error
+ */
+dmod_dmini_api(1.0, dmini_context_t, _create_with_arena, (void* buffer, size_t size));
+
+/**
+ * @brief Create INI context taking its memory from caller hooks
+ *
+ * Every allocation of the context goes through @p allocator: nodes and
+ * strings, arena blocks, temporary I/O and line buffers and snapshots made
+ * with dmini_freeze(). Configuration data can so be placed in a dedicated
+ * memory bank or a bounded pool and accounted separately. The hooks are
+ * copied, the user pointer must stay valid until dmini_destroy().
+ *
+ * @param allocator        Memory hooks (NULL for the DMOD heap)
+ * @param arena_block_size 0 to allocate every node from the hooks, otherwise
+ *                         the size of the arena blocks taken from them
+ * @param owner_token      Token protecting the active section (0 = unprotected)
+ * @return Context handle or NULL on failure or when a required hook is missing
+ */
+dmod_dmini_api(1.0, dmini_context_t, _create_ex, (const dmini_allocator_t* allocator, size_t arena_block_size,
+                                                  unsigned int owner_token));
+
+/**
+ * @brief Create a context that never allocates after creation
+ *
+ * The context lives in the storage declared with DMINI_STATIC_CONTEXT().
+ * Sections and keys are taken from fixed pools and returned to them when
+ * removed, names and values from the string pool, temporary buffers from a
+ * scratch area: nothing is taken from the heap, and parsing or setting
+ * beyond a capacity fails with DMINI_ERR_MEMORY. Lookups scan the lists
+ * without a hash index, so their cost is bounded by the capacities. The
+ * context cannot be made concurrent or format-preserving, dmini_freeze()
+ * returns NULL for it, and dmini_set_io_buffer_size() accepts at most a
+ * quarter of the scratch area; dmini_destroy() releases nothing, and the
+ * storage can be used for a new context afterwards.
+ *
+ * @param storage Storage declared with DMINI_STATIC_CONTEXT()
+ * @return New INI context or NULL if the storage is too small or the module
+ *         was built without static contexts
+ */
+dmod_dmini_api(1.0, dmini_context_t, _create_static, (dmini_static_t* storage));
+
+/**
+ * @brief Create a read-only snapshot of a context
+ *
+ * Copies the content visible in @p ctx into a single contiguous block: a
+ * header, arrays of section and key records, hash tables over both and one
+ * pool of strings. Lookups in the snapshot probe the hash tables instead of
+ * following list nodes, and the snapshot never changes, so any number of
+ * tasks may read it without dmini_enable_concurrency() or read-side
+ * sections. The order of sections and keys is preserved.
+ *
+ * If @p ctx has an active-section restriction, the snapshot contains only
+ * the active section and keeps treating NULL as a reference to it.
+ * Later changes to @p ctx do not affect the snapshot. It is released with a
+ * single dmini_destroy() call.
+ *
+ * @param ctx INI context (or another snapshot, which is copied)
+ * @return Snapshot, or NULL on allocation failure, if ctx is NULL or if it is
+ *         a static context
+ */
+dmod_dmini_api(1.0, dmini_snapshot_t, _freeze, (dmini_context_t ctx));
+
+/**
+ * @brief Export the snapshot layout as a binary image
+ *
+ * Writes the same contiguous layout that dmini_freeze() builds. References
+ * are offsets from the start of the image, so it can be stored in a file or
+ * in flash and opened at any address with dmini_open_binary(). Values are
+ * stored in the byte order of the exporting CPU, and images carry a format
+ * version, so an image from a different byte order or version is rejected
+ * when opened.
+ *
+ * @param ctx         INI context or snapshot
+ * @param buffer      Destination aligned to 4 bytes (NULL to query the size)
+ * @param buffer_size Size of @p buffer
+ * @return Size of the image in bytes, DMINI_ERR_MEMORY if the buffer is too
+ *         small, DMINI_ERR_INVALID if ctx is NULL or the buffer is not
+ *         aligned, DMINI_ERR_GENERAL if the content does not fit the format
+ */
+dmod_dmini_api(1.0, int, _export_binary, (dmini_context_t ctx, void* buffer, size_t buffer_size));
+
+/**
+ * @brief Open a binary image in place
+ *
+ * Validates the image produced by dmini_export_binary() and returns a
+ * snapshot that queries it where it is (e.g. memory-mapped or in flash).
+ * Nothing is parsed or copied; only the fixed-size context header is
+ * allocated. Strings returned by the snapshot point into @p data, which must
+ * stay valid and unchanged until dmini_destroy().
+ *
+ * @param data Image, aligned to 4 bytes
+ * @param size Number of bytes available at @p data
+ * @return Snapshot, or NULL if the image is invalid or allocation fails
+ */
+dmod_dmini_api(1.0, dmini_snapshot_t, _open_binary, (const void* data, size_t size));
+
+/**
+ * @brief Set the size of the file I/O buffer
+ *
+ * dmini_parse_file() reads files in blocks of this size and
+ * dmini_generate_file() batches its output in a buffer of this size. The
+ * buffer is allocated temporarily for the duration of the call.
+ *
+ * A static context takes the buffer from its scratch area, so it accepts at
+ * most DMINI_STATIC_SCRATCH_BYTES / 4.
+ *
+ * @param ctx  INI context
+ * @param size Buffer size in bytes (0 = default: 4096, or
+ *             DMINI_STATIC_SCRATCH_BYTES / 4 for a static context)
+ * @return DMINI_OK on success, DMINI_ERR_INVALID if ctx is NULL or the size
+ *         does not fit the scratch area of a static context
+ */
+dmod_dmini_api(1.0, int, _set_io_buffer_size, (dmini_context_t ctx, size_t size));
+
+/**
+ * @brief Share identical keys and values between the pairs of a context
+ *
+ * Keys and values stored after the call are kept once in a reference-counted
+ * pool of the context, and a string is freed when the last pair using it is
+ * changed or removed. Configurations that repeat the same key names and
+ * values in many sections then hold a single copy of each. A unique string
+ * costs 8 to 16 bytes more than a plain copy, so the pool only pays
+ * off for repetitive content; call it right after creating the context.
+ * Strings borrowed by dmini_parse_buffer_inplace() are not pooled.
+ *
+ * @param ctx INI context
+ * @return DMINI_OK on success (also when already enabled), DMINI_ERR_INVALID
+ *         if ctx is NULL, DMINI_ERR_MEMORY on allocation failure,
+ *         DMINI_ERR_READONLY for snapshots, DMINI_ERR_GENERAL if the module
+ *         was built without the pool
+ */
+dmod_dmini_api(1.0, int, _enable_interning, (dmini_context_t ctx));
+
+/**
+ * @brief Keep the parsed document and save changes into it
+ *
+ * The first document parsed after the call is kept together with the
+ * position of every header, key and value in it. Generating then copies the
+ * unchanged parts of the document and splices in only what changed: a new
+ * value replaces the old one in its line, removed keys and sections are left
+ * out, new keys are written after the last key of their section and new
+ * sections at the end. Comments, blank lines, order and line endings of the
+ * document survive, and an unchanged context reproduces it byte for byte.
+ * The document costs its size plus 32 bytes per header and key line, taken
+ * from the allocator outside the arena. dmini_open_lazy() parses the whole
+ * file in this mode, and a restricted context generates its active section
+ * as usual.
+ *
+ * @param ctx INI context
+ * @return DMINI_OK on success (also when already enabled), DMINI_ERR_INVALID
+ *         if ctx is NULL or a chunked parse is in progress, DMINI_ERR_MEMORY
+ *         on allocation failure, DMINI_ERR_READONLY for snapshots,
+ *         DMINI_ERR_GENERAL for static contexts or if the module was built
+ *         without the mode
+ */
+dmod_dmini_api(1.0, int, _enable_format_preserving, (dmini_context_t ctx));
+
+/**
+ * @brief Get memory held by the context
+ *
+ * For arena contexts this is the number of arena bytes consumed, including
+ * block headers. For heap contexts it is the number of bytes currently
+ * allocated, rounded the same way the arena rounds them, so it can be used
+ * to size the buffer passed to dmini_create_with_arena().
+ *
+ * @param ctx INI context
+ * @return Number of bytes in use, or 0 if ctx is NULL
+ */
+dmod_dmini_api(1.0, size_t, _memory_usage, (dmini_context_t ctx));
+
+/**
+ * @brief Get the statistics counters of a context
+ *
+ * Shows how much work configuration access costs: the lookup counters and
+ * nodes_visited tell whether the hash index pays off, allocations and
+ * bytes_held whether an arena would. Lookups of frozen snapshots are not
+ * counted. Counters are updated atomically in concurrent mode.
+ *
+ * @param ctx   INI context
+ * @param stats Receives the counters
+ * @return DMINI_OK on success, DMINI_ERR_INVALID on NULL arguments,
+ *         DMINI_ERR_GENERAL if the module was built without statistics
+ */
+dmod_dmini_api(1.0, int, _get_stats, (dmini_context_t ctx, dmini_stats_t* stats));
+
+/**
+ * @brief Reset the statistics counters of a context to zero
+ *
+ * @param ctx INI context
+ * @return DMINI_OK on success, DMINI_ERR_INVALID if ctx is NULL,
+ *         DMINI_ERR_GENERAL if the module was built without statistics
+ */
+dmod_dmini_api(1.0, int, _reset_stats, (dmini_context_t ctx));
+
 /**
  * @brief Set the active section restriction
  *
@@ -1,8 +1,258 @@
 #define DMOD_ENABLE_REGISTRATION    ON
 #include "dmod.h"
 #include "dmini.h"
+#include <stddef.h>
 #include <string.h>
 
+/**
+ * @brief Compile-time switch for the hashed section/key index
+ *
+ * When enabled, sections and keys are additionally tracked in open-addressing
+ * hash tables so lookups do not have to walk the linked lists. The lists are
+ * kept either way, so generation order is not affected. Tiny targets can set
+ * this to 0 to leave the index code out.
+ */
+#ifndef DMINI_USE_HASH_INDEX
+#   define DMINI_USE_HASH_INDEX         1
+#endif
+
+/**
+ * @brief Number of entries at which a hash index is built
+ *
+ * Short lists are cheaper to scan than to index, so a table is only created
+ * for a section (or for the section list) once it holds this many entries.
+ */
+#ifndef DMINI_HASH_INDEX_THRESHOLD
+#   define DMINI_HASH_INDEX_THRESHOLD   8
+#endif
+
+/**
+ * @brief Default block size of an internally grown arena
+ */
+#ifndef DMINI_ARENA_BLOCK_SIZE
+#   define DMINI_ARENA_BLOCK_SIZE       1024
+#endif
+
+/**
+ * @brief Default size of the block used for file I/O
+ *
+ * Can be changed per context with dmini_set_io_buffer_size().
+ */
+#ifndef DMINI_IO_BUFFER_SIZE
+#   define DMINI_IO_BUFFER_SIZE         4096
+#endif
+
+/**
+ * @brief Compile-time switch for caching converted values
+ *
+ * When enabled, every pair remembers the result of the last numeric or
+ * boolean conversion of its value, so repeated dmini_get_int() /
+ * dmini_get_float() / dmini_get_bool() calls do not parse the string again.
+ * Costs 8 bytes per pair; set to 0 to leave it out.
+ */
+#ifndef DMINI_CACHE_VALUES
+#   define DMINI_CACHE_VALUES           1
+#endif
+
+/**
+ * @brief Compile-time switch for the opt-in concurrent mode
+ *
+ * dmini_enable_concurrency() needs lock-free atomic operations on int-sized
+ * values, so the mode is built in by default only when the compiler
+ * provides them.
+ */
+#ifndef DMINI_USE_CONCURRENCY
+#   if defined(__GCC_ATOMIC_INT_LOCK_FREE) && __GCC_ATOMIC_INT_LOCK_FREE == 2
+#       define DMINI_USE_CONCURRENCY    1
+#   else
+#       define DMINI_USE_CONCURRENCY    0
+#   endif
+#endif
+
+/**
+ * @brief Compile-time switch for the opt-in string intern pool
+ *
+ * When enabled, dmini_enable_interning() makes a context store identical
+ * keys and values once and share them between pairs. Set to 0 to leave the
+ * pool code out.
+ */
+#ifndef DMINI_USE_INTERN
+#   define DMINI_USE_INTERN             1
+#endif
+
+/**
+ * @brief Compile-time switch for the opt-in format-preserving mode
+ *
+ * When enabled, dmini_enable_format_preserving() makes a context keep the
+ * parsed document and generate its output by splicing changes into it, so
+ * comments, blank lines and ordering survive a save. Set to 0 to leave the
+ * mode out.
+ */
+#ifndef DMINI_USE_PRESERVE
+#   define DMINI_USE_PRESERVE           1
+#endif
+
+/**
+ * @brief Compile-time switch for dmini_create_static()
+ *
+ * When disabled, dmini_create_static() returns NULL and contexts carry no
+ * node pools.
+ */
+#ifndef DMINI_USE_STATIC
+#   define DMINI_USE_STATIC             1
+#endif
+
+/**
+ * @brief Compile-time switch for dmini_parse_parallel()
+ *
+ * When disabled, dmini_parse_parallel() parses serially like
+ * dmini_parse_memory(). Set to 0 on targets without threads to leave the
+ * chunking and splicing code out.
+ */
+#ifndef DMINI_USE_PARALLEL
+#   define DMINI_USE_PARALLEL           1
+#endif
+
+/**
+ * @brief Smallest chunk dmini_parse_parallel() hands to a task
+ *
+ * Smaller documents are parsed serially, because starting a task costs more
+ * than parsing a few kilobytes.
+ */
+#ifndef DMINI_PARALLEL_MIN_CHUNK
+#   define DMINI_PARALLEL_MIN_CHUNK     16384
+#endif
+
+/**
+ * @brief Compile-time switch for word-at-a-time delimiter scanning
+ *
+ * When enabled, the tokenizer looks for line ends and delimiters a machine
+ * word at a time, or 16 bytes at a time with SSE2 or NEON when the compiler
+ * targets them, instead of testing every byte. Set to 0 to scan byte by
+ * byte.
+ */
+#ifndef DMINI_USE_FAST_SCAN
+#   define DMINI_USE_FAST_SCAN          1
+#endif
+
+/**
+ * @brief Compile-time switch for the SSE2 and NEON branches of the scanner
+ *
+ * Set to 0 to scan a machine word at a time even where vectors are
+ * available, which runs the code path of targets without them (such as
+ * Cortex-M) in host builds and their tests.
+ */
+#ifndef DMINI_USE_SIMD_SCAN
+#   define DMINI_USE_SIMD_SCAN          1
+#endif
+
+#if DMINI_USE_FAST_SCAN && DMINI_USE_SIMD_SCAN && defined(__SSE2__)
+#   include <emmintrin.h>
+#   define DMINI_SCAN_SSE2              1
+#elif DMINI_USE_FAST_SCAN && DMINI_USE_SIMD_SCAN && defined(__ARM_NEON) && defined(__aarch64__)
+#   include <arm_neon.h>
+#   define DMINI_SCAN_NEON              1
+#endif
+
+/**
+ * @brief Atomic helpers used by the concurrent mode
+ *
+ * DMINI_PUBLISH() stores a pointer with release semantics and DMINI_LOAD()
+ * reads one with acquire semantics, so a reader that follows a published
+ * pointer sees the node fully initialized.
+ */
+#if DMINI_USE_CONCURRENCY
+#   define DMINI_ATOMIC_LOAD(ptr)       __atomic_load_n((ptr), __ATOMIC_SEQ_CST)
+#   define DMINI_ATOMIC_ADD(ptr, val)   __atomic_add_fetch((ptr), (val), __ATOMIC_SEQ_CST)
+#   define DMINI_ATOMIC_SUB(ptr, val)   __atomic_sub_fetch((ptr), (val), __ATOMIC_SEQ_CST)
+#   define DMINI_PUBLISH(lvalue, val)   __atomic_store_n(&(lvalue), (val), __ATOMIC_RELEASE)
+#   define DMINI_LOAD(lvalue)           __atomic_load_n(&(lvalue), __ATOMIC_ACQUIRE)
+#else
+#   define DMINI_ATOMIC_LOAD(ptr)       (*(ptr))
+#   define DMINI_ATOMIC_ADD(ptr, val)   (*(ptr) += (val))
+#   define DMINI_ATOMIC_SUB(ptr, val)   (*(ptr) -= (val))
+#   define DMINI_PUBLISH(lvalue, val)   ((lvalue) = (val))
+#   define DMINI_LOAD(lvalue)           (lvalue)
+#endif
+
+/**
+ * @brief Compile-time switch for the statistics block
+ *
+ * When enabled, the context counts lookups, nodes traversed, allocations,
+ * parsing and generation for dmini_get_stats(). Off by default, because every
+ * lookup then updates counters.
+ */
+#ifndef DMINI_USE_STATS
+#   define DMINI_USE_STATS              0
+#endif
+
+/**
+ * @brief Statistics counters (indexes into the stats array of the context)
+ */
+#define DMINI_STAT_SECTION_LOOKUPS      0
+#define DMINI_STAT_SECTION_MISSES       1
+#define DMINI_STAT_PAIR_LOOKUPS         2
+#define DMINI_STAT_PAIR_MISSES          3
+#define DMINI_STAT_NODES_VISITED        4
+#define DMINI_STAT_ALLOCATIONS          5
+#define DMINI_STAT_PARSE_CALLS          6
+#define DMINI_STAT_PARSE_LINES          7
+#define DMINI_STAT_PARSE_TIME           8
+#define DMINI_STAT_GENERATE_BYTES       9
+#define DMINI_STAT_REJECTIONS           10
+#define DMINI_STAT_COUNT                11
+
+/**
+ * @brief Add to a statistics counter
+ *
+ * Readers of a concurrent context count at the same time, so the counters
+ * are updated atomically; relaxed order is enough, they order nothing.
+ */
+#if DMINI_USE_STATS && DMINI_USE_CONCURRENCY
+#   define DMINI_STAT_ADD(ctx, stat, n) ((void)__atomic_add_fetch(&(ctx)->stats[stat], (uint32_t)(n), __ATOMIC_RELAXED))
+#   define DMINI_STAT_GET(ctx, stat)    __atomic_load_n(&(ctx)->stats[stat], __ATOMIC_RELAXED)
+#   define DMINI_STAT_SET(ctx, stat, n) __atomic_store_n(&(ctx)->stats[stat], (uint32_t)(n), __ATOMIC_RELAXED)
+#elif DMINI_USE_STATS
+#   define DMINI_STAT_ADD(ctx, stat, n) ((void)((ctx)->stats[stat] += (uint32_t)(n)))
+#   define DMINI_STAT_GET(ctx, stat)    ((ctx)->stats[stat])
+#   define DMINI_STAT_SET(ctx, stat, n) ((ctx)->stats[stat] = (uint32_t)(n))
+#else
+#   define DMINI_STAT_ADD(ctx, stat, n) ((void)0)
+#endif
+
+/**
+ * @brief Alignment of every allocation made through the context
+ */
+#define DMINI_ALIGNMENT                 8
+#define DMINI_ALIGN_UP(size)            (((size) + (DMINI_ALIGNMENT - 1)) & ~(size_t)(DMINI_ALIGNMENT - 1))
+
+#if DMINI_USE_HASH_INDEX
+/**
+ * @brief Hash index slot
+ *
+ * The hash is kept next to the node pointer so probing does not have to
+ * dereference nodes that cannot match.
+ */
+typedef struct dmini_index_slot
+{
+    unsigned int hash;
+    void* node;                     /* NULL = empty, DMINI_INDEX_TOMBSTONE = removed */
+} dmini_index_slot_t;
+
+/**
+ * @brief Open-addressing hash index (linear probing)
+ *
+ * The header and the slots live in a single allocation.
+ */
+typedef struct dmini_index
+{
+    unsigned int capacity;          /* number of slots, always a power of two */
+    unsigned int count;             /* live entries */
+    unsigned int used;              /* live entries + tombstones */
+    dmini_index_slot_t slots[];
+} dmini_index_t;
+#endif
+
 /**
  * @brief Key-value pair structure
  */
@@ -10,97 +260,631 @@ typedef struct dmini_pair
 {
     char* key;
     char* value;
+    size_t key_len;                 /* strlen(key) */
+    size_t value_len;               /* strlen(value) */
+    unsigned int hash;              /* hash of the key */
+    unsigned int flags;             /* DMINI_PAIR_* flags */
+#if DMINI_CACHE_VALUES
+    union
+    {
+        int64_t i;                  /* DMINI_PAIR_CACHED_INT / _BOOL */
+        float f;                    /* DMINI_PAIR_CACHED_FLOAT */
+    } cache;                        /* last conversion of the value */
+#endif
     struct dmini_pair* next;
 } dmini_pair_t;
 
+/**
+ * @brief Pair flags
+ */
+#define DMINI_PAIR_KEY_BORROWED     0x01u   /* key points into an in-place parse buffer */
+#define DMINI_PAIR_VALUE_BORROWED   0x02u   /* value points into an in-place parse buffer */
+#define DMINI_PAIR_CACHED_INT       0x04u   /* cache.i holds the value as an integer */
+#define DMINI_PAIR_CACHED_FLOAT     0x08u   /* cache.f holds the value as a float */
+#define DMINI_PAIR_CACHED_BOOL      0x10u   /* cache.i holds 1, 0 or -1 (not a boolean) */
+#define DMINI_PAIR_CACHED_MASK      (DMINI_PAIR_CACHED_INT | DMINI_PAIR_CACHED_FLOAT | DMINI_PAIR_CACHED_BOOL)
+#define DMINI_PAIR_DIRTY            0x20u   /* added or changed since the file was last synced */
+#define DMINI_PAIR_KEY_INTERNED     0x40u   /* key is shared through the intern pool */
+#define DMINI_PAIR_VALUE_INTERNED   0x80u   /* value is shared through the intern pool */
+#define DMINI_PAIR_KEY_SHARED       (DMINI_PAIR_KEY_BORROWED | DMINI_PAIR_KEY_INTERNED)
+#define DMINI_PAIR_VALUE_SHARED     (DMINI_PAIR_VALUE_BORROWED | DMINI_PAIR_VALUE_INTERNED)
+#define DMINI_PAIR_SOURCED          0x100u  /* a line of the kept source sets the key */
+
 /**
  * @brief Section structure
  */
 typedef struct dmini_section
 {
     char* name;
+    size_t name_len;                /* strlen(name), 0 for the global section */
+    size_t size;                    /* serialized size of the header and pairs */
+    unsigned int hash;              /* hash of the name (NULL name hashes as "") */
+    unsigned int flags;             /* DMINI_SECTION_* flags */
+    unsigned int pair_count;        /* number of pairs in the list */
     dmini_pair_t* pairs;
+    dmini_pair_t* pairs_tail;       /* last pair in the list (O(1) append) */
+#if DMINI_USE_HASH_INDEX
+    dmini_index_t* index;           /* key index (NULL until the section grows) */
+#endif
+    struct dmini_lazy_range* lazy;  /* parts of the lazy file still to parse (NULL = loaded) */
     struct dmini_section* next;
 } dmini_section_t;
 
+/**
+ * @brief Section flags
+ */
+#define DMINI_SECTION_NAME_BORROWED 0x01u   /* name points into an in-place parse buffer */
+#define DMINI_SECTION_DIRTY         0x02u   /* created or holds dirty pairs since the last sync */
+#define DMINI_SECTION_SOURCED       0x04u   /* the kept source has a header of the section */
+
+/**
+ * @brief String ownership flags accepted by the node constructors
+ */
+#define DMINI_BORROW_KEY            0x01u   /* key/name span is NUL-terminated and outlives the node */
+#define DMINI_BORROW_VALUE          0x02u   /* value span is NUL-terminated and outlives the node */
+
+#if DMINI_USE_INTERN
+/**
+ * @brief String of the intern pool
+ *
+ * The text follows the header. Every pair using the text holds one
+ * reference; the entry is freed with the last one.
+ */
+typedef struct dmini_intern
+{
+    struct dmini_intern* next;      /* next entry of the bucket */
+    unsigned int hash;              /* hash of the text */
+    unsigned int refs;              /* pairs referencing the text */
+    char text[];
+} dmini_intern_t;
+
+#define DMINI_INTERN_BUCKETS        16u /* initial number of buckets */
+#endif
+
+#if DMINI_USE_PRESERVE
+/**
+ * @brief Line of the kept source holding a header or a pair
+ *
+ * Offsets are relative to the start of the kept text. Lines that are not
+ * recorded (comments, blank and malformed lines) are copied as they are.
+ */
+typedef struct dmini_source_line
+{
+    uint32_t start;                 /* first byte of the line */
+    uint32_t end;                   /* first byte after its terminator */
+    uint32_t key;                   /* key or section name */
+    uint32_t key_len;
+    uint32_t value;                 /* value span (pairs only) */
+    uint32_t value_len;
+    unsigned int hash;              /* hash of the key or name */
+    unsigned int kind;              /* DMINI_LINE_* flags */
+} dmini_source_line_t;
+
+#define DMINI_LINE_HEADER           0x01u   /* [section] line (pair line otherwise) */
+#define DMINI_LINE_FIRST            0x02u   /* first header of the section, new pairs go into its block */
+#define DMINI_LINE_FOREIGN          0x04u   /* header skipped by a filtered parse, its block is copied as is */
+#define DMINI_LINE_SHADOWED         0x08u   /* a later line sets the same key, so this one is not spliced */
+
+/**
+ * @brief Document kept by the format-preserving mode
+ *
+ * The text and the line table live in buffers of the allocator, not in the
+ * arena, because both grow while the document is parsed.
+ */
+typedef struct dmini_source
+{
+    char* text;                     /* the document as parsed */
+    size_t len;
+    size_t capacity;
+    size_t parsed;                  /* bytes handed to the parser so far */
+    dmini_source_line_t* lines;
+    unsigned int line_count;
+    unsigned int line_capacity;
+    int state;                      /* DMINI_SOURCE_* */
+} dmini_source_t;
+
+#define DMINI_SOURCE_EMPTY          0   /* waiting for the first document */
+#define DMINI_SOURCE_LOADING        1   /* document being parsed */
+#define DMINI_SOURCE_KEPT           2   /* document kept, output is spliced into it */
+#endif
+
+/**
+ * @brief Byte range of the lazy file holding pairs of one section
+ *
+ * A section repeated in the file has one range per occurrence, kept in file
+ * order so later values still win when they are parsed.
+ */
+typedef struct dmini_lazy_range
+{
+    struct dmini_lazy_range* next;
+    size_t offset;                  /* first byte after the section header */
+    size_t length;                  /* bytes up to the next header or the end */
+} dmini_lazy_range_t;
+
+/**
+ * @brief Arena block header
+ *
+ * Blocks are bump-allocated from; the usable memory follows the header.
+ */
+typedef struct dmini_arena_block
+{
+    struct dmini_arena_block* next;
+    size_t size;                    /* usable bytes after the header */
+    size_t used;                    /* bytes handed out so far */
+} dmini_arena_block_t;
+
+#define DMINI_ARENA_HEADER_SIZE     DMINI_ALIGN_UP(sizeof(dmini_arena_block_t))
+
+#if DMINI_USE_STATIC
+/**
+ * @brief Number of exact-size free lists of the string pool of a static context
+ *
+ * List i holds blocks of (i + 1) * DMINI_ALIGNMENT bytes; larger blocks share
+ * one more list and carry their size.
+ */
+#define DMINI_STATIC_CLASSES        16
+
+/**
+ * @brief Freed block of the string pool larger than the size-class lists
+ */
+typedef struct dmini_free_block
+{
+    struct dmini_free_block* next;
+    size_t size;
+} dmini_free_block_t;
+
+/**
+ * @brief Scratch area serving the temporary buffers of a static context
+ *
+ * Buffers are bump-allocated; freeing the newest one returns its space and
+ * the whole area is reused once no buffer is live.
+ */
+typedef struct dmini_scratch
+{
+    char* base;
+    size_t size;
+    size_t used;                    /* bytes handed out so far */
+    size_t top;                     /* offset of the newest buffer */
+    unsigned int live;              /* buffers not freed yet */
+} dmini_scratch_t;
+#endif
+
+struct dmini_stream;
+struct dmini_retired;
+
+/**
+ * @brief Position remembered by the index-based accessors
+ *
+ * dmini_section_name() and dmini_key_name() continue from the last position
+ * when called with the same or a higher index, so an index loop is linear.
+ */
+typedef struct dmini_cursor
+{
+    void* owner;                    /* section of a key cursor (unused for sections) */
+    void* node;                     /* node at index (NULL = cursor unset) */
+    int index;
+    unsigned int generation;        /* context generation the cursor is valid for */
+} dmini_cursor_t;
+
+/**
+ * @brief Change watch registered with dmini_watch()
+ */
+typedef struct dmini_watch
+{
+    struct dmini_watch* next;
+    char* section;                  /* watched section (NULL = global section) */
+    char* key;                      /* watched key (NULL = every key of the section) */
+    dmini_watch_callback_t callback;    /* NULL once removed during a notification */
+    void* user;
+} dmini_watch_t;
+
+/**
+ * @brief Frozen image format
+ *
+ * A frozen snapshot is one contiguous block: this header, the section
+ * records, the pair records, a hash table over the sections, a hash table
+ * over the pairs and a pool of NUL-terminated strings. Every reference is a
+ * 32-bit offset from the start of the image, so the block does not depend on
+ * where it is placed.
+ */
+#define DMINI_IMAGE_MAGIC           0x494E4944u /* "DINI" */
+#define DMINI_IMAGE_VERSION         1u
+#define DMINI_IMAGE_NONE            0xFFFFFFFFu /* name offset of the global section */
+#define DMINI_IMAGE_RESTRICTED      0x01u       /* frozen under an active-section restriction */
+
+typedef struct dmini_image
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;                  /* total size of the image in bytes */
+    uint32_t flags;                 /* DMINI_IMAGE_* flags */
+    uint32_t text_size;             /* size of the generated INI text, including the terminator */
+    uint32_t section_count;
+    uint32_t pair_count;
+    uint32_t section_slots;         /* capacity of the section table (power of two) */
+    uint32_t pair_slots;            /* capacity of the pair table (power of two) */
+    uint32_t sections;              /* offset of the section records */
+    uint32_t pairs;                 /* offset of the pair records */
+    uint32_t section_table;         /* offset of the section hash table */
+    uint32_t pair_table;            /* offset of the pair hash table */
+    uint32_t strings;               /* offset of the string pool */
+} dmini_image_t;
+
+typedef struct dmini_image_section
+{
+    uint32_t name;                  /* string offset, DMINI_IMAGE_NONE for the global section */
+    uint32_t name_len;
+    uint32_t hash;
+    uint32_t first_pair;            /* index of the first pair record */
+    uint32_t pair_count;
+} dmini_image_section_t;
+
+typedef struct dmini_image_pair
+{
+    uint32_t key;                   /* string offset */
+    uint32_t key_len;
+    uint32_t value;                 /* string offset */
+    uint32_t value_len;
+    uint32_t hash;                  /* hash of the key */
+    uint32_t section;               /* index of the owning section record */
+} dmini_image_pair_t;
+
+typedef struct dmini_image_slot
+{
+    uint32_t hash;
+    uint32_t index;                 /* record index + 1 (0 = empty slot) */
+} dmini_image_slot_t;
+
+#define DMINI_IMAGE_AT(image, offset, type) ((const type*)((const char*)(image) + (offset)))
+
 /**
  * @brief INI context structure
  */
 struct dmini_context
 {
+    dmini_allocator_t allocator;    /* source of node memory, arena blocks and temporary buffers */
+    dmini_arena_block_t* arena;     /* current arena block (NULL = heap allocation) */
+    size_t arena_block_size;        /* size of new blocks (0 = caller buffer, no growth) */
+    size_t memory_used;             /* bytes held by a heap context */
     dmini_section_t* sections;
+    dmini_section_t* sections_tail; /* last section in the list (O(1) append) */
+    unsigned int section_count;     /* number of sections in the list */
+    size_t content_size;            /* sum of the serialized sizes of all sections */
+#if DMINI_USE_HASH_INDEX
+    dmini_index_t* section_index;   /* section index (NULL until the list grows) */
+#endif
     unsigned int owner_token;       /* magic number protecting active-section changes (0 = unprotected) */
     char* active_section;           /* name of the currently active section (NULL = global section) */
     int active_section_locked;      /* 1 when the active-section restriction is in effect */
+    struct dmini_stream* stream;    /* chunked parser state (NULL when not parsing) */
+    unsigned int generation;        /* bumped whenever handles may become stale */
+    size_t io_buffer_size;          /* block size for file I/O */
+    dmini_cursor_t section_cursor;  /* last dmini_section_name() position */
+    dmini_cursor_t key_cursor;      /* last dmini_key_name() position */
+    const dmini_image_t* image;     /* frozen image (NULL = mutable context) */
+    int synced;                     /* 1 when a file held the content before the dirty changes */
+    int sync_rewrite;               /* 1 when the changes cannot be appended to the file */
+    unsigned int sync_file;         /* hash of the name of the synced file */
+    unsigned int dirty_sections;    /* number of sections flagged DMINI_SECTION_DIRTY */
+    size_t journal_size;            /* bytes appended since the file was last rewritten */
+    char* lazy_file;                /* file of dmini_open_lazy() (NULL when everything is loaded) */
+    size_t lazy_size;               /* bytes of the lazy file not parsed yet */
+    int lazy_busy;                  /* 1 while the lazy file is scanned or loaded */
+    unsigned int slot_file;         /* hash of the base name of the slots last saved or loaded */
+    int slot_current;               /* slot holding the newest valid content (-1 = unknown) */
+    uint32_t slot_sequence;         /* sequence number of that slot */
+#if DMINI_USE_STATIC
+    int fixed;                      /* 1 for a static context: nodes come from the pools below */
+    void* free_sections;            /* unused section nodes of a static context */
+    void* free_pairs;               /* unused pair nodes of a static context */
+    void** free_blocks;             /* freed string pool blocks of a static context, per size */
+#endif
+#if DMINI_USE_STATS
+    uint32_t stats[DMINI_STAT_COUNT];   /* DMINI_STAT_* counters */
+#endif
+#if DMINI_USE_INTERN
+    dmini_intern_t** intern_buckets;    /* intern pool (NULL = strings are not shared) */
+    unsigned int intern_capacity;   /* number of buckets, a power of two */
+    unsigned int intern_count;      /* number of distinct strings in the pool */
+#endif
+#if DMINI_USE_PRESERVE
+    dmini_source_t* source;         /* kept document (NULL = format-preserving mode off) */
+#endif
+    dmini_watch_t* watches;         /* registered change watches (newest first) */
+    unsigned int notifying;         /* nesting of watch_notify() calls */
+    int watch_removed;              /* a watch was unregistered during a notification */
+#if DMINI_USE_CONCURRENCY
+    int concurrent;                 /* 1 after dmini_enable_concurrency() */
+    void* write_mutex;              /* recursive mutex serializing writers */
+    unsigned int write_depth;       /* nesting of writer_lock() calls */
+    unsigned int epoch;             /* advanced whenever retired memory is reclaimed */
+    unsigned int readers[2];        /* active readers per epoch parity */
+    struct dmini_retired* retired[2];   /* memory retired during epochs of each parity */
+#endif
 };
 
+/**
+ * @brief Whether the context runs in concurrent mode
+ */
+#if DMINI_USE_CONCURRENCY
+#   define CTX_CONCURRENT(ctx)          ((ctx)->concurrent)
+#else
+#   define CTX_CONCURRENT(ctx)          0
+#endif
+
+/**
+ * @brief Whether the context is a static context of dmini_create_static()
+ */
+#if DMINI_USE_STATIC
+#   define CTX_STATIC(ctx)              ((ctx)->fixed)
+#else
+#   define CTX_STATIC(ctx)              0
+#endif
+
+/**
+ * @brief Whether the context runs in format-preserving mode
+ */
+#if DMINI_USE_PRESERVE
+#   define CTX_PRESERVING(ctx)          ((ctx)->source != NULL)
+#else
+#   define CTX_PRESERVING(ctx)          0
+#endif
+
+/**
+ * @brief Parser state shared by all parse entry points
+ */
+typedef struct dmini_parser
+{
+    dmini_context_t ctx;
+    dmini_section_t* current_section;   /* section receiving key=value lines (NULL = skipped) */
+    char* inplace_end;                  /* end of the in-place buffer (NULL = copy strings) */
+    int filtered;                       /* 1 = only the pairs of only_section are kept */
+    const char* only_section;           /* section kept by a filtered parse (NULL = global) */
+    size_t only_len;                    /* strlen(only_section) */
+    const char* journal;                /* file whose appended records are checked (NULL = none) */
+    size_t record_length;               /* length of the record announced by the last line */
+    uint32_t record_crc;                /* CRC-32 of that record */
+    int record;                         /* 1 when the last line announced a record */
+    int torn;                           /* 1 when a record failed its check and ended the document */
+#if DMINI_USE_PRESERVE
+    dmini_source_t* source;             /* kept document recording the lines (NULL = not kept) */
+    size_t line_next;                   /* offset after the terminator of the line being parsed */
+#endif
+} dmini_parser_t;
+
+/**
+ * @brief Chunked parser state (dmini_parse_begin / feed / end)
+ *
+ * Lines that are complete inside a chunk are parsed directly from it; only a
+ * line split across chunks is collected in the carry buffer, so memory is
+ * bounded by the longest line rather than by the document.
+ */
+typedef struct dmini_stream
+{
+    dmini_parser_t parser;
+    char* line;                     /* carry buffer for a partial line */
+    size_t line_len;                /* bytes collected in the carry buffer */
+    size_t line_capacity;           /* size of the carry buffer */
+    int skip_lf;                    /* previous chunk ended with \r */
+    int finished;                   /* a NUL character or a torn record ended the document */
+    int error;                      /* first error reported by feed */
+    size_t fed;                     /* bytes fed before the current chunk */
+} dmini_stream_t;
+
+/**
+ * @brief Header scan of dmini_open_lazy()
+ *
+ * Only lines starting with '[' are collected and parsed; every other line is
+ * skipped byte by byte, so the scan allocates nothing per pair.
+ */
+typedef struct dmini_lazy_scan
+{
+    dmini_stream_t stream;          /* parser and carry buffer for header lines */
+    size_t range_start;             /* offset where the pairs of the current section start */
+    size_t line_start;              /* offset of the current line */
+    size_t end;                     /* offset where the document ended */
+    int content;                    /* the current range holds a line that may be a pair */
+    int state;                      /* DMINI_SCAN_* */
+} dmini_lazy_scan_t;
+
+#define DMINI_SCAN_LINE_START       0   /* skipping the indentation of a line */
+#define DMINI_SCAN_HEADER           1   /* collecting a [section] line */
+#define DMINI_SCAN_SKIP             2   /* skipping the rest of a line */
+#define DMINI_SCAN_COMMENT          3   /* collecting a comment that may announce a record */
+
+/**
+ * @brief State of a slot file of dmini_save_atomic()
+ */
+typedef struct dmini_slot
+{
+    size_t length;                  /* bytes of text before the trailer */
+    uint32_t sequence;              /* advanced by every save */
+    uint32_t crc;                   /* CRC-32 of the text */
+    int valid;                      /* 1 when the trailer (and, once verified, the text) is intact */
+} dmini_slot_t;
+
+#if DMINI_USE_PARALLEL
+/**
+ * @brief Chunk of a parallel parse
+ */
+typedef struct dmini_chunk
+{
+    dmini_context_t ctx;            /* private context the chunk is parsed into */
+    const char* data;
+    size_t len;
+    int result;                     /* result of parsing the chunk */
+} dmini_chunk_t;
+#endif
+
+/**
+ * @brief Output sink used by the generators
+ *
+ * Data is collected in the buffer with memcpy. A file writer flushes the
+ * buffer with a single Dmod_FileWrite whenever it is full; a memory writer
+ * writes straight into the caller's buffer.
+ */
+typedef struct dmini_writer
+{
+    char* buffer;
+    size_t size;                    /* size of the buffer */
+    size_t pos;                     /* bytes pending in the buffer */
+    void* file;                     /* destination file (NULL = memory) */
+    size_t flushed;                 /* bytes already written to the file */
+    uint32_t* crc;                  /* CRC-32 of the written bytes (NULL = not computed) */
+    int error;                      /* first error (DMINI_OK while writing) */
+} dmini_writer_t;
+
 // ============================================================================
 //                      Helper Functions
 // ============================================================================
 
 /**
- * @brief Trim whitespace from beginning and end of string
- * 
- * @param str String to trim (modified in place)
- * @return Pointer to trimmed string
+ * @brief Check for whitespace trimmed from keys, values and section names
  */
-static char* trim_whitespace(char* str)
+static inline int is_space(char c)
 {
-    char* end;
-    
-    // Trim leading space
-    while (*str == ' ' || *str == '\t' || *str == '\r' || *str == '\n')
-    {
-        str++;
-    }
-    
-    if (*str == 0)
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+ * @brief Trim whitespace from both ends of a span
+ *
+ * @param begin In/out start of the span
+ * @param end   In/out end of the span (exclusive)
+ */
+static void trim_span(const char** begin, const char** end)
+{
+    const char* b = *begin;
+    const char* e = *end;
+
+    while (b < e && is_space(*b))
     {
-        return str;
+        b++;
     }
-    
-    // Trim trailing space
-    end = str + strlen(str) - 1;
-    while (end > str && (*end == ' ' || *end == '\t' || *end == '\r' || *end == '\n'))
+    while (e > b && is_space(e[-1]))
     {
-        end--;
+        e--;
     }
-    
-    // Write new null terminator
-    *(end + 1) = '\0';
-    
-    return str;
+
+    *begin = b;
+    *end = e;
 }
 
+#if DMINI_USE_FAST_SCAN
+/**
+ * @brief Machine word used by the word-at-a-time scanner
+ */
+typedef uintptr_t dmini_word_t;
+
+#define DMINI_WORD_ONES             ((dmini_word_t)-1 / 0xFFu)
+#define DMINI_WORD_HIGHS            (DMINI_WORD_ONES * 0x80u)
 
+/**
+ * @brief Check whether any byte of a word equals @p c
+ *
+ * Sets the high bit of matching bytes; bytes after a match may be flagged
+ * too, so the result only tells whether the word needs a closer look.
+ */
+static inline dmini_word_t word_match(dmini_word_t word, char c)
+{
+    dmini_word_t x = word ^ (DMINI_WORD_ONES * (unsigned char)c);
+    return (x - DMINI_WORD_ONES) & ~x & DMINI_WORD_HIGHS;
+}
+#endif
 
 /**
- * @brief Strip inline comment from a value string
+ * @brief Find the first byte equal to @p a, @p b or @p c
  *
- * Finds the first ';' or '#' character and null-terminates the string there,
- * effectively removing the inline comment. Note: quoted strings are not
- * supported; a ';' or '#' inside a value will also be treated as a comment
- * marker.
+ * Skips whole blocks without a match and locates the byte within the block
+ * that has one, so long lines and values are read in few steps.
  *
- * @param str Value string to modify in place
+ * @return Position of the byte, or @p end if the span has none
  */
-static void strip_inline_comment(char* str)
+static inline const char* scan_for(const char* p, const char* end, char a, char b, char c)
 {
-    if (!str)
+#if DMINI_SCAN_SSE2
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    const __m128i vc = _mm_set1_epi8(c);
+    while (end - p >= 16)
     {
-        return;
+        __m128i block = _mm_loadu_si128((const __m128i*)p);
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, va), _mm_cmpeq_epi8(block, vb)),
+                                    _mm_cmpeq_epi8(block, vc));
+        if (_mm_movemask_epi8(hits))
+        {
+            break;
+        }
+        p += 16;
     }
-
-    char* p = str;
-    while (*p)
+#elif DMINI_SCAN_NEON
+    const uint8x16_t va = vdupq_n_u8((uint8_t)a);
+    const uint8x16_t vb = vdupq_n_u8((uint8_t)b);
+    const uint8x16_t vc = vdupq_n_u8((uint8_t)c);
+    while (end - p >= 16)
+    {
+        uint8x16_t block = vld1q_u8((const uint8_t*)p);
+        uint8x16_t hits = vorrq_u8(vorrq_u8(vceqq_u8(block, va), vceqq_u8(block, vb)), vceqq_u8(block, vc));
+        if (vmaxvq_u8(hits))
+        {
+            break;
+        }
+        p += 16;
+    }
+#elif DMINI_USE_FAST_SCAN
+    while ((size_t)(end - p) >= sizeof(dmini_word_t))
     {
-        if (*p == ';' || *p == '#')
+        dmini_word_t word;
+        memcpy(&word, p, sizeof(word));     /* unaligned-safe, a single load where allowed */
+        if (word_match(word, a) | word_match(word, b) | word_match(word, c))
         {
-            *p = '\0';
             break;
         }
+        p += sizeof(word);
+    }
+#endif
+
+    while (p < end && *p != a && *p != b && *p != c)
+    {
         p++;
     }
+    return p;
+}
+
+/**
+ * @brief Find the end of a line (\n, \r or NUL, or @p end)
+ */
+static inline const char* scan_line_end(const char* p, const char* end)
+{
+    return scan_for(p, end, '\n', '\r', '\0');
+}
+
+/**
+ * @brief Compare a string of known length with a span
+ */
+static inline int span_equals(const char* str, size_t str_len, const char* data, size_t len)
+{
+    return str_len == len && memcmp(str, data, len) == 0;
+}
+
+/**
+ * @brief Compare a section name with a name span (NULL = global section)
+ */
+static int section_name_matches(const dmini_section_t* section, const char* data, size_t len)
+{
+    if (section->name == NULL || data == NULL)
+    {
+        return section->name == data;
+    }
+    return span_equals(section->name, section->name_len, data, len);
+}
+
+/**
+ * @brief Get the serialized size of a pair ("key=value\n")
+ */
+static inline size_t pair_size(const dmini_pair_t* pair)
+{
+    return pair->key_len + pair->value_len + 2;
 }
 
 /**
@@ -116,1120 +900,7373 @@ static int section_names_equal(const char* name1, const char* name2)
 }
 
 /**
- * @brief Find section by name (bypasses active-section restriction)
- *
- * Used internally where the full section list must be searched regardless of
- * any active-section restriction (e.g. during parsing and get_or_create).
+ * @brief Get the first usable byte of an arena block
  */
-static dmini_section_t* find_section_raw(dmini_context_t ctx, const char* section_name)
+static inline char* arena_data(dmini_arena_block_t* block)
 {
-    if (!ctx)
+    return (char*)block + DMINI_ARENA_HEADER_SIZE;
+}
+
+/**
+ * @brief Default allocator hooks (DMOD heap)
+ */
+static void* default_malloc(size_t size, void* user)
+{
+    return Dmod_Malloc(size);
+}
+
+static void default_free(void* ptr, void* user)
+{
+    Dmod_Free(ptr);
+}
+
+static const dmini_allocator_t default_allocator = { default_malloc, default_free, NULL, NULL };
+
+#if DMINI_USE_STATIC
+/**
+ * @brief Allocator hooks of a static context, serving its scratch area
+ */
+static void* scratch_malloc(size_t size, void* user)
+{
+    dmini_scratch_t* scratch = (dmini_scratch_t*)user;
+    size = DMINI_ALIGN_UP(size);
+    if (scratch->size - scratch->used < size)
     {
         return NULL;
     }
 
-    dmini_section_t* section = ctx->sections;
-    while (section)
+    scratch->top = scratch->used;
+    scratch->used += size;
+    scratch->live++;
+    return scratch->base + scratch->top;
+}
+
+static void scratch_free(void* ptr, void* user)
+{
+    dmini_scratch_t* scratch = (dmini_scratch_t*)user;
+    if (!ptr)
+    {
+        return;
+    }
+
+    if (--scratch->live == 0)
+    {
+        scratch->used = 0;
+        scratch->top = 0;
+    }
+    else if ((char*)ptr == scratch->base + scratch->top)
+    {
+        // The buffer below is not known, so it is only reclaimed with the rest
+        scratch->used = scratch->top;
+    }
+}
+
+static void* scratch_realloc(void* ptr, size_t size, void* user)
+{
+    dmini_scratch_t* scratch = (dmini_scratch_t*)user;
+    if (ptr && (char*)ptr == scratch->base + scratch->top && scratch->used > scratch->top)
     {
-        if (section_names_equal(section->name, section_name))
+        // The newest buffer grows in place
+        if (scratch->size - scratch->top < DMINI_ALIGN_UP(size))
         {
-            return section;
+            return NULL;
         }
-        section = section->next;
+        scratch->used = scratch->top + DMINI_ALIGN_UP(size);
+        return ptr;
     }
 
-    return NULL;
+    char* copy = (char*)scratch_malloc(size, user);
+    if (copy && ptr)
+    {
+        // An older buffer ends before the new one at the latest
+        size_t available = (size_t)(copy - (char*)ptr);
+        memcpy(copy, ptr, available < size ? available : size);
+        scratch_free(ptr, user);
+    }
+    return copy;
 }
+#endif
 
 /**
- * @brief Find section by name
- *
- * When an active-section restriction is in effect:
- *   - section_name == NULL is remapped to the active section name.
- *   - Any other name that does not match the active section returns NULL.
+ * @brief Allocate a new arena block from an allocator
  */
-static dmini_section_t* find_section(dmini_context_t ctx, const char* section_name)
+static dmini_arena_block_t* arena_block_create(const dmini_allocator_t* allocator, size_t size)
 {
-    if (!ctx)
+    dmini_arena_block_t* block = (dmini_arena_block_t*)allocator->malloc_fn(DMINI_ARENA_HEADER_SIZE + size,
+                                                                            allocator->user);
+    if (!block)
     {
         return NULL;
     }
 
-    /* Apply active-section restriction */
-    const char* effective_name = section_name;
-    if (ctx->active_section_locked)
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+/**
+ * @brief Bump-allocate from the context arena
+ *
+ * A caller-provided arena never grows. An internally grown arena adds a block
+ * when the current one is full; requests larger than the block size get a
+ * dedicated block linked behind the current one so its free space is kept.
+ */
+static void* arena_alloc(dmini_context_t ctx, size_t size)
+{
+    dmini_arena_block_t* block = ctx->arena;
+    size = DMINI_ALIGN_UP(size);
+
+    if (block->size - block->used < size)
     {
-        if (section_name == NULL)
+        if (ctx->arena_block_size == 0)
         {
-            /* NULL is remapped to the active section */
-            effective_name = ctx->active_section;
+            return NULL;
+        }
+
+        if (size > ctx->arena_block_size)
+        {
+            dmini_arena_block_t* large = arena_block_create(&ctx->allocator, size);
+            if (!large)
+            {
+                return NULL;
+            }
+            large->used = size;
+            large->next = block->next;
+            block->next = large;
+            return arena_data(large);
         }
-        else if (!section_names_equal(section_name, ctx->active_section))
+
+        block = arena_block_create(&ctx->allocator, ctx->arena_block_size);
+        if (!block)
         {
-            /* A different section is not visible */
             return NULL;
         }
+        block->next = ctx->arena;
+        ctx->arena = block;
     }
 
-    return find_section_raw(ctx, effective_name);
+    void* ptr = arena_data(block) + block->used;
+    block->used += size;
+    return ptr;
 }
 
+#if DMINI_USE_STATIC
 /**
- * @brief Find key-value pair in section
+ * @brief Get the free list of a string pool block size
+ *
+ * @param size Aligned block size
  */
-static dmini_pair_t* find_pair(dmini_section_t* section, const char* key)
+static void** pool_list(dmini_context_t ctx, size_t size)
 {
-    if (!section || !key)
-    {
-        return NULL;
-    }
-    
-    dmini_pair_t* pair = section->pairs;
-    while (pair)
+    if (size <= DMINI_STATIC_CLASSES * DMINI_ALIGNMENT)
     {
-        if (strcmp(pair->key, key) == 0)
-        {
-            return pair;
-        }
-        pair = pair->next;
+        return &ctx->free_blocks[size / DMINI_ALIGNMENT - 1];
     }
-    
-    return NULL;
+    return &ctx->free_blocks[DMINI_STATIC_CLASSES];
 }
 
 /**
- * @brief Create new section
+ * @brief Take a freed block of exactly the given size from the string pool
+ *
+ * Freed memory is reused only for the size it had, so what a static context
+ * can hold depends on its content, not on how often it was changed.
  */
-static dmini_section_t* create_section(const char* name)
+static void* pool_take(dmini_context_t ctx, size_t size)
 {
-    dmini_section_t* section = (dmini_section_t*)Dmod_Malloc(sizeof(dmini_section_t));
-    if (!section)
+    void** link = pool_list(ctx, size);
+    if (size > DMINI_STATIC_CLASSES * DMINI_ALIGNMENT)
     {
-        return NULL;
-    }
-    
-    if (name)
-    {
-        section->name = Dmod_StrDup(name);
-        if (!section->name)
+        while (*link && ((dmini_free_block_t*)*link)->size != size)
         {
-            Dmod_Free(section);
-            return NULL;
+            link = (void**)*link;
         }
     }
-    else
+
+    void* block = *link;
+    if (block)
     {
-        section->name = NULL;
+        *link = *(void**)block;
     }
-    
-    section->pairs = NULL;
-    section->next = NULL;
-    
-    return section;
+    return block;
 }
 
 /**
- * @brief Create new key-value pair
+ * @brief Return a block to the string pool
  */
-static dmini_pair_t* create_pair(const char* key, const char* value)
+static void pool_put(dmini_context_t ctx, void* block, size_t size)
 {
-    dmini_pair_t* pair = (dmini_pair_t*)Dmod_Malloc(sizeof(dmini_pair_t));
-    if (!pair)
-    {
-        return NULL;
-    }
-    
-    pair->key = Dmod_StrDup(key);
-    pair->value = Dmod_StrDup(value);
-    pair->next = NULL;
-    
-    if (!pair->key || !pair->value)
+    void** link = pool_list(ctx, size);
+    if (size > DMINI_STATIC_CLASSES * DMINI_ALIGNMENT)
     {
-        if (pair->key) Dmod_Free(pair->key);
-        if (pair->value) Dmod_Free(pair->value);
-        Dmod_Free(pair);
-        return NULL;
+        ((dmini_free_block_t*)block)->size = size;
     }
-    
-    return pair;
+    *(void**)block = *link;
+    *link = block;
 }
+#endif
 
 /**
- * @brief Free key-value pair
+ * @brief Allocate memory for the context
  */
-static void free_pair(dmini_pair_t* pair)
+static void* ctx_alloc(dmini_context_t ctx, size_t size)
 {
-    if (!pair)
-    {
-        return;
-    }
-    
-    if (pair->key)
+    DMINI_STAT_ADD(ctx, DMINI_STAT_ALLOCATIONS, 1);
+    if (ctx->arena)
     {
-        Dmod_Free(pair->key);
+#if DMINI_USE_STATIC
+        if (CTX_STATIC(ctx) && size)
+        {
+            void* block = pool_take(ctx, DMINI_ALIGN_UP(size));
+            if (block)
+            {
+                return block;
+            }
+        }
+#endif
+        return arena_alloc(ctx, size);
     }
-    if (pair->value)
+
+    void* ptr = ctx->allocator.malloc_fn(size, ctx->allocator.user);
+    if (ptr)
     {
-        Dmod_Free(pair->value);
+        ctx->memory_used += DMINI_ALIGN_UP(size);
     }
-    Dmod_Free(pair);
+    return ptr;
 }
 
 /**
- * @brief Free section and all its pairs
+ * @brief Release memory obtained with ctx_alloc()
+ *
+ * Arena memory is only reclaimed when it was the most recent allocation of
+ * the current block; everything else is released by dmini_destroy(), except
+ * in a static context, which keeps it for allocations of the same size.
  */
-static void free_section(dmini_section_t* section)
+static void ctx_free(dmini_context_t ctx, void* ptr, size_t size)
 {
-    if (!section)
+    if (!ptr)
     {
         return;
     }
-    
-    // Free all pairs
-    dmini_pair_t* pair = section->pairs;
-    while (pair)
-    {
-        dmini_pair_t* next = pair->next;
-        free_pair(pair);
-        pair = next;
-    }
-    
-    // Free section name
-    if (section->name)
+
+    if (ctx->arena)
     {
-        Dmod_Free(section->name);
+        dmini_arena_block_t* block = ctx->arena;
+        size = DMINI_ALIGN_UP(size);
+        if (block->used >= size && (char*)ptr == arena_data(block) + block->used - size)
+        {
+            block->used -= size;
+        }
+#if DMINI_USE_STATIC
+        else if (CTX_STATIC(ctx) && size)
+        {
+            pool_put(ctx, ptr, size);
+        }
+#endif
+        return;
     }
-    
-    Dmod_Free(section);
+
+    ctx->memory_used -= DMINI_ALIGN_UP(size);
+    ctx->allocator.free_fn(ptr, ctx->allocator.user);
 }
 
 /**
- * @brief Get or create section
+ * @brief Allocate a section or pair node
  *
- * When called from the public API (set_string, set_int) the active-section
- * restriction is enforced: if it is active and section_name is not the active
- * section, NULL is returned instead of creating a duplicate entry.
- * During parsing the restriction is never active, so behaviour is unchanged.
+ * A static context takes nodes only from its pool, so their number never
+ * exceeds the capacity it was declared with.
+ *
+ * @param pool Free list of the node type
  */
-static dmini_section_t* get_or_create_section(dmini_context_t ctx, const char* section_name)
+static void* ctx_alloc_node(dmini_context_t ctx, void** pool, size_t size)
 {
-    if (!ctx)
-    {
-        return NULL;
-    }
-
-    /* Resolve the effective section name the same way find_section() does */
-    const char* effective_name = section_name;
-    if (ctx->active_section_locked)
+#if DMINI_USE_STATIC
+    if (CTX_STATIC(ctx))
     {
-        if (section_name == NULL)
-        {
-            effective_name = ctx->active_section;
-        }
-        else if (!section_names_equal(section_name, ctx->active_section))
+        void* node = *pool;
+        if (node)
         {
-            /* The requested section is not visible under the restriction */
-            return NULL;
+            DMINI_STAT_ADD(ctx, DMINI_STAT_ALLOCATIONS, 1);
+            *pool = *(void**)node;
         }
+        return node;
     }
+#endif
+    return ctx_alloc(ctx, size);
+}
 
-    /* Try to find existing section (raw, to avoid duplicate creation) */
-    dmini_section_t* section = find_section_raw(ctx, effective_name);
-    if (section)
+/**
+ * @brief Release a node obtained with ctx_alloc_node()
+ */
+static void ctx_free_node(dmini_context_t ctx, void** pool, void* node, size_t size)
+{
+#if DMINI_USE_STATIC
+    if (CTX_STATIC(ctx))
     {
-        return section;
+        *(void**)node = *pool;
+        *pool = node;
+        return;
     }
+#endif
+    ctx_free(ctx, node, size);
+}
 
-    /* Create new section using the effective name */
-    section = create_section(effective_name);
-    if (!section)
-    {
-        return NULL;
-    }
+#if DMINI_USE_STATIC
+#   define DMINI_SECTION_POOL(ctx)  (&(ctx)->free_sections)
+#   define DMINI_PAIR_POOL(ctx)     (&(ctx)->free_pairs)
+#else
+#   define DMINI_SECTION_POOL(ctx)  NULL
+#   define DMINI_PAIR_POOL(ctx)     NULL
+#endif
 
-    /* Add to list */
-    if (!ctx->sections)
-    {
-        ctx->sections = section;
-    }
-    else
+/**
+ * @brief Copy a span into context memory as a NUL-terminated string
+ */
+static char* ctx_strndup(dmini_context_t ctx, const char* data, size_t len)
+{
+    char* copy = (char*)ctx_alloc(ctx, len + 1);
+    if (copy)
     {
-        dmini_section_t* last = ctx->sections;
-        while (last->next)
-        {
-            last = last->next;
-        }
-        last->next = section;
+        memcpy(copy, data, len);
+        copy[len] = '\0';
     }
+    return copy;
+}
 
-    return section;
+/**
+ * @brief Allocate a temporary buffer
+ *
+ * Temporary buffers (I/O blocks, partial lines) are released before the
+ * operation returns, so they are taken from the allocator even for arena
+ * contexts, where freed memory could not be reused.
+ */
+static void* ctx_alloc_temp(dmini_context_t ctx, size_t size)
+{
+    return ctx->allocator.malloc_fn(size, ctx->allocator.user);
 }
 
 /**
- * @brief Set key-value pair in section
+ * @brief Release a buffer obtained with ctx_alloc_temp()
  */
-static int set_pair_in_section(dmini_section_t* section, const char* key, const char* value)
+static void ctx_free_temp(dmini_context_t ctx, void* ptr, size_t size)
 {
-    if (!section || !key)
-    {
-        return DMINI_ERR_INVALID;
-    }
-    
-    // Try to find existing pair
-    dmini_pair_t* pair = find_pair(section, key);
-    if (pair)
-    {
-        // Update value
-        if (pair->value)
-        {
-            Dmod_Free(pair->value);
-        }
-        pair->value = Dmod_StrDup(value);
-        if (!pair->value)
-        {
-            return DMINI_ERR_MEMORY;
-        }
-        return DMINI_OK;
-    }
-    
-    // Create new pair
-    pair = create_pair(key, value);
-    if (!pair)
+    if (ptr)
     {
-        return DMINI_ERR_MEMORY;
+        ctx->allocator.free_fn(ptr, ctx->allocator.user);
     }
-    
-    // Add to list
-    if (!section->pairs)
+}
+
+/**
+ * @brief Resize a buffer obtained with ctx_alloc_temp()
+ *
+ * Falls back to allocate, copy and free when the allocator has no realloc
+ * hook. The old buffer is kept on failure.
+ */
+static void* ctx_realloc_temp(dmini_context_t ctx, void* ptr, size_t old_size, size_t size)
+{
+    if (ctx->allocator.realloc_fn)
     {
-        section->pairs = pair;
+        return ctx->allocator.realloc_fn(ptr, size, ctx->allocator.user);
     }
-    else
+
+    void* copy = ctx_alloc_temp(ctx, size);
+    if (copy && ptr)
     {
-        dmini_pair_t* last = section->pairs;
-        while (last->next)
-        {
-            last = last->next;
-        }
-        last->next = pair;
+        memcpy(copy, ptr, old_size < size ? old_size : size);
+        ctx_free_temp(ctx, ptr, old_size);
     }
-    
-    return DMINI_OK;
+    return copy;
 }
 
-// ============================================================================
-//                      Module Interface Implementation
-// ============================================================================
-
 /**
- * @brief Module initialization (optional)
+ * @brief Check whether nodes of one context may be handed to another
+ *
+ * Both must allocate from the same allocator outside an arena, so the
+ * receiving context releases the nodes to the hooks they came from.
  */
-void dmod_preinit(void)
+static inline int ctx_shares_heap(dmini_context_t a, dmini_context_t b)
 {
-    // Nothing to do
+    return !a->arena && !b->arena &&
+           a->allocator.malloc_fn == b->allocator.malloc_fn &&
+           a->allocator.free_fn == b->allocator.free_fn &&
+           a->allocator.user == b->allocator.user;
 }
 
 /**
- * @brief Module initialization
+ * @brief Duplicate a string into context memory
  */
-int dmod_init(const Dmod_Config_t *Config)
+static char* ctx_strdup(dmini_context_t ctx, const char* str)
 {
-    // Nothing to do
-    return 0;
+    return ctx_strndup(ctx, str, strlen(str));
 }
 
 /**
- * @brief Module deinitialization
+ * @brief Free a string obtained with ctx_strdup()
  */
-void dmod_deinit(void)
+static void ctx_free_string(dmini_context_t ctx, char* str)
 {
-    // Nothing to do
+    if (str)
+    {
+        ctx_free(ctx, str, strlen(str) + 1);
+    }
 }
 
-// ============================================================================
-//                      Public API Implementation
-// ============================================================================
-
-dmini_context_t dmini_create(void)
+/**
+ * @brief Free a string of known length obtained with ctx_strndup()
+ */
+static inline void ctx_free_span(dmini_context_t ctx, char* str, size_t len)
 {
-    return dmini_create_with_token(0);
+    if (str)
+    {
+        ctx_free(ctx, str, len + 1);
+    }
 }
 
-dmini_context_t dmini_create_with_token(unsigned int owner_token)
+/**
+ * @brief Compute hash of a span (32-bit FNV-1a)
+ */
+static unsigned int hash_bytes(const char* data, size_t len)
 {
-    dmini_context_t ctx = (dmini_context_t)Dmod_Malloc(sizeof(struct dmini_context));
-    if (!ctx)
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < len; i++)
     {
-        return NULL;
+        hash ^= (unsigned char)data[i];
+        hash *= 16777619u;
     }
+    return hash;
+}
 
+/**
+ * @brief Compute hash of a string
+ *
+ * A NULL string (global section) hashes the same as an empty string.
+ */
+static unsigned int hash_string(const char* str)
+{
+    return str ? hash_bytes(str, strlen(str)) : hash_bytes("", 0);
+}
+
+/**
+ * @brief Extend a CRC-32 (IEEE 802.3, as zlib) over more data
+ *
+ * Works a nibble at a time from a 64-byte table.
+ *
+ * @param crc  CRC of the preceding data (0 for none)
+ * @return CRC of the preceding data followed by @p data
+ */
+static uint32_t crc32_update(uint32_t crc, const void* data, size_t len)
+{
+    static const uint32_t table[16] =
+    {
+        0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu, 0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+        0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu, 0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu
+    };
+    const unsigned char* p = (const unsigned char*)data;
+    crc = ~crc;
+    while (len--)
+    {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ table[crc & 15];
+        crc = (crc >> 4) ^ table[crc & 15];
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Format a value as 8 hex digits
+ */
+static void hex_put(char* out, uint32_t value)
+{
+    for (int i = 7; i >= 0; i--)
+    {
+        out[i] = "0123456789abcdef"[value & 15];
+        value >>= 4;
+    }
+}
+
+/**
+ * @brief Read 8 hex digits
+ *
+ * @return 1 on success, 0 if a character is no hex digit
+ */
+static int hex_get(const char* in, uint32_t* value)
+{
+    uint32_t result = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        char c = in[i];
+        unsigned int digit = c >= '0' && c <= '9' ? (unsigned int)(c - '0')
+                           : c >= 'a' && c <= 'f' ? (unsigned int)(c - 'a' + 10) : 16u;
+        if (digit > 15)
+        {
+            return 0;
+        }
+        result = (result << 4) | digit;
+    }
+    *value = result;
+    return 1;
+}
+
+#if DMINI_USE_INTERN
+/**
+ * @brief Get the allocation size of an intern entry
+ */
+static inline size_t intern_size(size_t len)
+{
+    return sizeof(dmini_intern_t) + len + 1;
+}
+
+/**
+ * @brief Double the number of buckets of the intern pool
+ *
+ * On allocation failure the pool keeps its buckets and only gets slower.
+ */
+static void intern_grow(dmini_context_t ctx)
+{
+    unsigned int capacity = ctx->intern_capacity * 2;
+    dmini_intern_t** buckets = (dmini_intern_t**)ctx_alloc(ctx, capacity * sizeof(dmini_intern_t*));
+    if (!buckets)
+    {
+        return;
+    }
+    memset(buckets, 0, capacity * sizeof(dmini_intern_t*));
+
+    for (unsigned int i = 0; i < ctx->intern_capacity; i++)
+    {
+        dmini_intern_t* entry = ctx->intern_buckets[i];
+        while (entry)
+        {
+            dmini_intern_t* next = entry->next;
+            entry->next = buckets[entry->hash & (capacity - 1)];
+            buckets[entry->hash & (capacity - 1)] = entry;
+            entry = next;
+        }
+    }
+
+    ctx_free(ctx, ctx->intern_buckets, ctx->intern_capacity * sizeof(dmini_intern_t*));
+    ctx->intern_buckets = buckets;
+    ctx->intern_capacity = capacity;
+}
+
+/**
+ * @brief Get a reference to the pooled copy of a span, adding it if needed
+ */
+static char* intern_get(dmini_context_t ctx, const char* data, size_t len)
+{
+    unsigned int hash = hash_bytes(data, len);
+    for (dmini_intern_t* entry = ctx->intern_buckets[hash & (ctx->intern_capacity - 1)]; entry; entry = entry->next)
+    {
+        if (entry->hash == hash && strncmp(entry->text, data, len) == 0 && entry->text[len] == '\0')
+        {
+            entry->refs++;
+            return entry->text;
+        }
+    }
+
+    dmini_intern_t* entry = (dmini_intern_t*)ctx_alloc(ctx, intern_size(len));
+    if (!entry)
+    {
+        return NULL;
+    }
+    if (ctx->intern_count >= ctx->intern_capacity)
+    {
+        intern_grow(ctx);
+    }
+
+    entry->hash = hash;
+    entry->refs = 1;
+    memcpy(entry->text, data, len);
+    entry->text[len] = '\0';
+    entry->next = ctx->intern_buckets[hash & (ctx->intern_capacity - 1)];
+    ctx->intern_buckets[hash & (ctx->intern_capacity - 1)] = entry;
+    ctx->intern_count++;
+    return entry->text;
+}
+
+/**
+ * @brief Drop a reference obtained with intern_get()
+ */
+static void intern_release(dmini_context_t ctx, char* text)
+{
+    dmini_intern_t* entry = (dmini_intern_t*)(text - offsetof(dmini_intern_t, text));
+    if (--entry->refs)
+    {
+        return;
+    }
+
+    dmini_intern_t** link = &ctx->intern_buckets[entry->hash & (ctx->intern_capacity - 1)];
+    while (*link != entry)
+    {
+        link = &(*link)->next;
+    }
+    *link = entry->next;
+    ctx->intern_count--;
+    ctx_free(ctx, entry, intern_size(strlen(entry->text)));
+}
+#endif /* DMINI_USE_INTERN */
+
+/**
+ * @brief Copy a key or value of a pair into context memory
+ *
+ * With the intern pool enabled the copy is shared with equal strings and
+ * @p interned is added to @p flags.
+ */
+static char* pair_strndup(dmini_context_t ctx, const char* data, size_t len,
+                          unsigned int interned, unsigned int* flags)
+{
+#if DMINI_USE_INTERN
+    if (ctx->intern_buckets)
+    {
+        char* text = intern_get(ctx, data, len);
+        if (text)
+        {
+            *flags |= interned;
+        }
+        return text;
+    }
+#endif
+    return ctx_strndup(ctx, data, len);
+}
+
+/**
+ * @brief Release a key or value of a pair unless it is borrowed
+ *
+ * @param flags DMINI_PAIR_* flags describing the string (KEY or VALUE bits)
+ */
+static void pair_free_string(dmini_context_t ctx, char* str, size_t len, unsigned int flags)
+{
+    if (flags & (DMINI_PAIR_KEY_BORROWED | DMINI_PAIR_VALUE_BORROWED))
+    {
+        return;
+    }
+#if DMINI_USE_INTERN
+    if (str && (flags & (DMINI_PAIR_KEY_INTERNED | DMINI_PAIR_VALUE_INTERNED)))
+    {
+        intern_release(ctx, str);
+        return;
+    }
+#endif
+    ctx_free_span(ctx, str, len);
+}
+
+/**
+ * @brief Kinds of memory handed to ctx_retire()
+ */
+#define DMINI_RETIRE_BLOCK          0u  /* ctx_free(ptr, size) */
+#define DMINI_RETIRE_SPAN           1u  /* ctx_free_span(ptr, size) */
+#define DMINI_RETIRE_PAIR           2u  /* free_pair(ptr) */
+#define DMINI_RETIRE_SECTION        3u  /* free_section(ptr) */
+#define DMINI_RETIRE_INTERNED       4u  /* intern_release(ptr) */
+
+static void ctx_retire(dmini_context_t ctx, unsigned int kind, void* ptr, size_t size);
+
+#if DMINI_USE_HASH_INDEX
+
+/**
+ * @brief Marker stored in slots whose entry has been removed
+ */
+static char index_tombstone;
+#define DMINI_INDEX_TOMBSTONE   ((void*)&index_tombstone)
+
+/**
+ * @brief Get the allocation size of an index with the given number of slots
+ */
+static size_t index_size(unsigned int capacity)
+{
+    return sizeof(dmini_index_t) + capacity * sizeof(dmini_index_slot_t);
+}
+
+/**
+ * @brief Allocate an empty index with the given number of slots
+ */
+static dmini_index_t* index_create(dmini_context_t ctx, unsigned int capacity)
+{
+    size_t size = index_size(capacity);
+    dmini_index_t* index = (dmini_index_t*)ctx_alloc(ctx, size);
+    if (!index)
+    {
+        return NULL;
+    }
+
+    memset(index, 0, size);
+    index->capacity = capacity;
+    return index;
+}
+
+/**
+ * @brief Place an entry into a free slot (no growth)
+ */
+static void index_place(dmini_index_t* index, unsigned int hash, void* node)
+{
+    unsigned int mask = index->capacity - 1;
+    unsigned int i = hash & mask;
+    while (index->slots[i].node != NULL && index->slots[i].node != DMINI_INDEX_TOMBSTONE)
+    {
+        i = (i + 1) & mask;
+    }
+    if (index->slots[i].node == NULL)
+    {
+        index->used++;
+    }
+    index->slots[i].hash = hash;
+    DMINI_PUBLISH(index->slots[i].node, node);
+    index->count++;
+}
+
+/**
+ * @brief Insert an entry, growing (and dropping tombstones) when needed
+ *
+ * @return Updated index pointer, or NULL when memory for growth is missing.
+ *         The old index is retired in both cases.
+ */
+static dmini_index_t* index_insert(dmini_context_t ctx, dmini_index_t* index, unsigned int hash, void* node)
+{
+    /* Keep the load factor (including tombstones) below 3/4 */
+    if ((index->used + 1) * 4 > index->capacity * 3)
+    {
+        unsigned int capacity = index->capacity;
+        if ((index->count + 1) * 2 > capacity)
+        {
+            capacity *= 2;
+        }
+
+        dmini_index_t* grown = index_create(ctx, capacity);
+        if (grown)
+        {
+            for (unsigned int i = 0; i < index->capacity; i++)
+            {
+                void* entry = index->slots[i].node;
+                if (entry != NULL && entry != DMINI_INDEX_TOMBSTONE)
+                {
+                    index_place(grown, index->slots[i].hash, entry);
+                }
+            }
+        }
+        ctx_retire(ctx, DMINI_RETIRE_BLOCK, index, index_size(index->capacity));
+        if (!grown)
+        {
+            return NULL;
+        }
+        index = grown;
+    }
+
+    index_place(index, hash, node);
+    return index;
+}
+
+/**
+ * @brief Replace the slot holding the given node with a tombstone
+ */
+static void index_remove(dmini_index_t* index, unsigned int hash, void* node)
+{
+    unsigned int mask = index->capacity - 1;
+    unsigned int i = hash & mask;
+    while (index->slots[i].node != NULL)
+    {
+        if (index->slots[i].node == node)
+        {
+            DMINI_PUBLISH(index->slots[i].node, DMINI_INDEX_TOMBSTONE);
+            index->count--;
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+/**
+ * @brief Add a section to the context index, building it when the list grows
+ *
+ * If memory for the index runs out the index is dropped and lookups fall back
+ * to scanning the list; it is rebuilt on a later insertion.
+ */
+static void index_add_section(dmini_context_t ctx, dmini_section_t* section)
+{
+    if (ctx->section_index)
+    {
+        DMINI_PUBLISH(ctx->section_index, index_insert(ctx, ctx->section_index, section->hash, section));
+        return;
+    }
+
+    // A static context has no memory to grow an index; its lists are bounded
+    if (ctx->section_count < DMINI_HASH_INDEX_THRESHOLD || CTX_STATIC(ctx))
+    {
+        return;
+    }
+
+    unsigned int capacity = DMINI_HASH_INDEX_THRESHOLD * 2;
+    while (capacity < ctx->section_count * 2)
+    {
+        capacity *= 2;
+    }
+
+    dmini_index_t* index = index_create(ctx, capacity);
+    if (index)
+    {
+        for (dmini_section_t* s = ctx->sections; s; s = s->next)
+        {
+            index_place(index, s->hash, s);
+        }
+        DMINI_PUBLISH(ctx->section_index, index);
+    }
+}
+
+/**
+ * @brief Add a pair to the section index, building it when the section grows
+ */
+static void index_add_pair(dmini_context_t ctx, dmini_section_t* section, dmini_pair_t* pair)
+{
+    if (section->index)
+    {
+        DMINI_PUBLISH(section->index, index_insert(ctx, section->index, pair->hash, pair));
+        return;
+    }
+
+    if (section->pair_count < DMINI_HASH_INDEX_THRESHOLD || CTX_STATIC(ctx))
+    {
+        return;
+    }
+
+    unsigned int capacity = DMINI_HASH_INDEX_THRESHOLD * 2;
+    while (capacity < section->pair_count * 2)
+    {
+        capacity *= 2;
+    }
+
+    dmini_index_t* index = index_create(ctx, capacity);
+    if (index)
+    {
+        for (dmini_pair_t* p = section->pairs; p; p = p->next)
+        {
+            index_place(index, p->hash, p);
+        }
+        DMINI_PUBLISH(section->index, index);
+    }
+}
+
+#endif /* DMINI_USE_HASH_INDEX */
+
+static int section_load(dmini_context_t ctx, dmini_section_t* section);
+
+/**
+ * @brief Parse the pairs of a lazily opened section on its first lookup
+ *
+ * A failed load keeps the remaining ranges, so the next lookup retries it.
+ */
+static inline dmini_section_t* section_touch(dmini_context_t ctx, dmini_section_t* section)
+{
+    if (section->lazy && !ctx->lazy_busy)
+    {
+        section_load(ctx, section);
+    }
+    return section;
+}
+
+/**
+ * @brief Count a section lookup and finish it
+ *
+ * @param visited Index slots or list nodes examined
+ */
+static inline dmini_section_t* section_found(dmini_context_t ctx, dmini_section_t* section, unsigned int visited)
+{
+    DMINI_STAT_ADD(ctx, DMINI_STAT_SECTION_LOOKUPS, 1);
+    DMINI_STAT_ADD(ctx, DMINI_STAT_SECTION_MISSES, section ? 0 : 1);
+    DMINI_STAT_ADD(ctx, DMINI_STAT_NODES_VISITED, visited);
+    return section ? section_touch(ctx, section) : NULL;
+}
+
+/**
+ * @brief Find section by name span (bypasses active-section restriction)
+ *
+ * @param name Name span (NULL for the global section)
+ * @param len  Length of the span
+ * @param hash Hash of the span
+ */
+static dmini_section_t* lookup_section(dmini_context_t ctx, const char* name, size_t len, unsigned int hash)
+{
+    unsigned int visited = 0;
+#if DMINI_USE_HASH_INDEX
+    dmini_index_t* index = DMINI_LOAD(ctx->section_index);
+    if (index)
+    {
+        unsigned int mask = index->capacity - 1;
+        unsigned int i = hash & mask;
+        dmini_section_t* section;
+        while ((section = (dmini_section_t*)DMINI_LOAD(index->slots[i].node)) != NULL)
+        {
+            visited++;
+            if (section != DMINI_INDEX_TOMBSTONE && index->slots[i].hash == hash &&
+                section_name_matches(section, name, len))
+            {
+                return section_found(ctx, section, visited);
+            }
+            i = (i + 1) & mask;
+        }
+        return section_found(ctx, NULL, visited);
+    }
+#endif
+
+    dmini_section_t* section = DMINI_LOAD(ctx->sections);
+    while (section)
+    {
+        visited++;
+        if (section->hash == hash && section_name_matches(section, name, len))
+        {
+            return section_found(ctx, section, visited);
+        }
+        section = DMINI_LOAD(section->next);
+    }
+
+    return section_found(ctx, NULL, visited);
+}
+
+/**
+ * @brief Find section by name (bypasses active-section restriction)
+ *
+ * Used internally where the full section list must be searched regardless of
+ * any active-section restriction (e.g. during parsing and get_or_create).
+ */
+static dmini_section_t* find_section_raw(dmini_context_t ctx, const char* section_name)
+{
+    if (!ctx)
+    {
+        return NULL;
+    }
+
+    size_t len = section_name ? strlen(section_name) : 0;
+    return lookup_section(ctx, section_name, len, hash_bytes(section_name ? section_name : "", len));
+}
+
+/**
+ * @brief Find section by name
+ *
+ * When an active-section restriction is in effect:
+ *   - section_name == NULL is remapped to the active section name.
+ *   - Any other name that does not match the active section returns NULL.
+ */
+static dmini_section_t* find_section(dmini_context_t ctx, const char* section_name)
+{
+    if (!ctx)
+    {
+        return NULL;
+    }
+
+    /* Apply active-section restriction */
+    const char* effective_name = section_name;
+    if (DMINI_LOAD(ctx->active_section_locked))
+    {
+        if (section_name == NULL)
+        {
+            /* NULL is remapped to the active section */
+            effective_name = DMINI_LOAD(ctx->active_section);
+        }
+        else if (!section_names_equal(section_name, DMINI_LOAD(ctx->active_section)))
+        {
+            /* A different section is not visible */
+            DMINI_STAT_ADD(ctx, DMINI_STAT_REJECTIONS, 1);
+            return NULL;
+        }
+    }
+
+    return find_section_raw(ctx, effective_name);
+}
+
+/**
+ * @brief Count a key lookup and return its result
+ *
+ * @param visited Index slots or list nodes examined
+ */
+static inline dmini_pair_t* pair_found(dmini_context_t ctx, dmini_pair_t* pair, unsigned int visited)
+{
+    DMINI_STAT_ADD(ctx, DMINI_STAT_PAIR_LOOKUPS, 1);
+    DMINI_STAT_ADD(ctx, DMINI_STAT_PAIR_MISSES, pair ? 0 : 1);
+    DMINI_STAT_ADD(ctx, DMINI_STAT_NODES_VISITED, visited);
+    return pair;
+}
+
+/**
+ * @brief Find key-value pair in section by key span and its hash
+ */
+static dmini_pair_t* find_pair_hashed(dmini_context_t ctx, dmini_section_t* section,
+                                      const char* key, size_t len, unsigned int hash)
+{
+    unsigned int visited = 0;
+#if DMINI_USE_HASH_INDEX
+    dmini_index_t* index = DMINI_LOAD(section->index);
+    if (index)
+    {
+        unsigned int mask = index->capacity - 1;
+        unsigned int i = hash & mask;
+        dmini_pair_t* pair;
+        while ((pair = (dmini_pair_t*)DMINI_LOAD(index->slots[i].node)) != NULL)
+        {
+            visited++;
+            if (pair != DMINI_INDEX_TOMBSTONE && index->slots[i].hash == hash &&
+                span_equals(pair->key, pair->key_len, key, len))
+            {
+                return pair_found(ctx, pair, visited);
+            }
+            i = (i + 1) & mask;
+        }
+        return pair_found(ctx, NULL, visited);
+    }
+#endif
+
+    dmini_pair_t* pair = DMINI_LOAD(section->pairs);
+    while (pair)
+    {
+        visited++;
+        if (pair->hash == hash && span_equals(pair->key, pair->key_len, key, len))
+        {
+            return pair_found(ctx, pair, visited);
+        }
+        pair = DMINI_LOAD(pair->next);
+    }
+
+    return pair_found(ctx, NULL, visited);
+}
+
+/**
+ * @brief Find key-value pair in section
+ */
+static dmini_pair_t* find_pair(dmini_context_t ctx, dmini_section_t* section, const char* key)
+{
+    if (!section || !key)
+    {
+        return NULL;
+    }
+
+    size_t len = strlen(key);
+    return find_pair_hashed(ctx, section, key, len, hash_bytes(key, len));
+}
+
+/**
+ * @brief Create new section
+ *
+ * @param name  Name span (NULL for the global section)
+ * @param len   Length of the span
+ * @param hash  Hash of the span
+ * @param flags DMINI_BORROW_KEY to reference the name instead of copying it
+ */
+static dmini_section_t* create_section(dmini_context_t ctx, const char* name, size_t len,
+                                       unsigned int hash, unsigned int flags)
+{
+    dmini_section_t* section = (dmini_section_t*)ctx_alloc_node(ctx, DMINI_SECTION_POOL(ctx), sizeof(dmini_section_t));
+    if (!section)
+    {
+        return NULL;
+    }
+    
+    section->flags = 0;
+    if (!name)
+    {
+        section->name = NULL;
+    }
+    else if (flags & DMINI_BORROW_KEY)
+    {
+        section->name = (char*)name;
+        section->flags |= DMINI_SECTION_NAME_BORROWED;
+    }
+    else
+    {
+        section->name = ctx_strndup(ctx, name, len);
+        if (!section->name)
+        {
+            ctx_free_node(ctx, DMINI_SECTION_POOL(ctx), section, sizeof(dmini_section_t));
+            return NULL;
+        }
+    }
+    
+    section->name_len = name ? len : 0;
+    section->size = name ? len + 3 : 0; // [name]\n
+    section->hash = hash;
+    section->pair_count = 0;
+    section->pairs = NULL;
+    section->pairs_tail = NULL;
+#if DMINI_USE_HASH_INDEX
+    section->index = NULL;
+#endif
+    section->lazy = NULL;
+    section->next = NULL;
+    
+    return section;
+}
+
+/**
+ * @brief Create new key-value pair
+ *
+ * @param flags DMINI_BORROW_KEY / DMINI_BORROW_VALUE to reference the spans
+ *              instead of copying them
+ */
+static dmini_pair_t* create_pair(dmini_context_t ctx, const char* key, size_t key_len,
+                                 const char* value, size_t value_len,
+                                 unsigned int hash, unsigned int flags)
+{
+    dmini_pair_t* pair = (dmini_pair_t*)ctx_alloc_node(ctx, DMINI_PAIR_POOL(ctx), sizeof(dmini_pair_t));
+    if (!pair)
+    {
+        return NULL;
+    }
+    
+    pair->key_len = key_len;
+    pair->value_len = value_len;
+    pair->hash = hash;
+    pair->flags = 0;
+    pair->next = NULL;
+
+    if (flags & DMINI_BORROW_KEY)
+    {
+        pair->key = (char*)key;
+        pair->flags |= DMINI_PAIR_KEY_BORROWED;
+    }
+    else
+    {
+        pair->key = pair_strndup(ctx, key, key_len, DMINI_PAIR_KEY_INTERNED, &pair->flags);
+    }
+
+    if (flags & DMINI_BORROW_VALUE)
+    {
+        pair->value = (char*)value;
+        pair->flags |= DMINI_PAIR_VALUE_BORROWED;
+    }
+    else
+    {
+        pair->value = pair->key ? pair_strndup(ctx, value, value_len, DMINI_PAIR_VALUE_INTERNED, &pair->flags)
+                                : NULL;
+    }
+    
+    if (!pair->key || !pair->value)
+    {
+        pair_free_string(ctx, pair->value, value_len, pair->flags & DMINI_PAIR_VALUE_SHARED);
+        pair_free_string(ctx, pair->key, key_len, pair->flags & DMINI_PAIR_KEY_SHARED);
+        ctx_free_node(ctx, DMINI_PAIR_POOL(ctx), pair, sizeof(dmini_pair_t));
+        return NULL;
+    }
+    
+    return pair;
+}
+
+/**
+ * @brief Free key-value pair
+ */
+static void free_pair(dmini_context_t ctx, dmini_pair_t* pair)
+{
+    if (!pair)
+    {
+        return;
+    }
+    
+    pair_free_string(ctx, pair->value, pair->value_len, pair->flags & DMINI_PAIR_VALUE_SHARED);
+    pair_free_string(ctx, pair->key, pair->key_len, pair->flags & DMINI_PAIR_KEY_SHARED);
+    ctx_free_node(ctx, DMINI_PAIR_POOL(ctx), pair, sizeof(dmini_pair_t));
+}
+
+/**
+ * @brief Free section and all its pairs
+ */
+static void free_section(dmini_context_t ctx, dmini_section_t* section)
+{
+    if (!section)
+    {
+        return;
+    }
+    
+    // Free all pairs
+    dmini_pair_t* pair = section->pairs;
+    while (pair)
+    {
+        dmini_pair_t* next = pair->next;
+        free_pair(ctx, pair);
+        pair = next;
+    }
+
+#if DMINI_USE_HASH_INDEX
+    if (section->index)
+    {
+        ctx_free(ctx, section->index, index_size(section->index->capacity));
+    }
+#endif
+
+    // Free the ranges that were never loaded
+    dmini_lazy_range_t* range = section->lazy;
+    while (range)
+    {
+        dmini_lazy_range_t* next = range->next;
+        ctx_free(ctx, range, sizeof(dmini_lazy_range_t));
+        range = next;
+    }
+    
+    // Free section name
+    if (!(section->flags & DMINI_SECTION_NAME_BORROWED))
+    {
+        ctx_free_span(ctx, section->name, section->name_len);
+    }
+    
+    ctx_free_node(ctx, DMINI_SECTION_POOL(ctx), section, sizeof(dmini_section_t));
+}
+
+/**
+ * @brief Release memory of the given kind immediately
+ */
+static void retire_free(dmini_context_t ctx, unsigned int kind, void* ptr, size_t size)
+{
+    switch (kind)
+    {
+        case DMINI_RETIRE_SPAN:
+            ctx_free_span(ctx, (char*)ptr, size);
+            break;
+        case DMINI_RETIRE_PAIR:
+            free_pair(ctx, (dmini_pair_t*)ptr);
+            break;
+        case DMINI_RETIRE_SECTION:
+            free_section(ctx, (dmini_section_t*)ptr);
+            break;
+#if DMINI_USE_INTERN
+        case DMINI_RETIRE_INTERNED:
+            intern_release(ctx, (char*)ptr);
+            break;
+#endif
+        default:
+            ctx_free(ctx, ptr, size);
+            break;
+    }
+}
+
+#if DMINI_USE_CONCURRENCY
+/**
+ * @brief Memory unlinked by a writer that readers may still be using
+ */
+typedef struct dmini_retired
+{
+    struct dmini_retired* next;
+    void* ptr;
+    size_t size;
+    unsigned int kind;              /* DMINI_RETIRE_* */
+} dmini_retired_t;
+
+/**
+ * @brief Release a list of retired memory
+ */
+static void retire_reclaim(dmini_context_t ctx, dmini_retired_t* list)
+{
+    while (list)
+    {
+        dmini_retired_t* next = list->next;
+        retire_free(ctx, list->kind, list->ptr, list->size);
+        ctx_free(ctx, list, sizeof(dmini_retired_t));
+        list = next;
+    }
+}
+#endif
+
+/**
+ * @brief Release memory that has been unlinked from the context
+ *
+ * In concurrent mode the memory is only queued, because lock-free readers
+ * may still hold pointers into it; writer_unlock() frees it once every
+ * reader that could have seen it has left. If the queue entry cannot be
+ * allocated the memory is leaked rather than freed under a reader.
+ */
+static void ctx_retire(dmini_context_t ctx, unsigned int kind, void* ptr, size_t size)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+#if DMINI_USE_CONCURRENCY
+    if (ctx->concurrent)
+    {
+        dmini_retired_t* entry = (dmini_retired_t*)ctx_alloc(ctx, sizeof(dmini_retired_t));
+        if (entry)
+        {
+            unsigned int parity = ctx->epoch & 1u;
+            entry->ptr = ptr;
+            entry->size = size;
+            entry->kind = kind;
+            entry->next = ctx->retired[parity];
+            ctx->retired[parity] = entry;
+        }
+        return;
+    }
+#endif
+
+    retire_free(ctx, kind, ptr, size);
+}
+
+/**
+ * @brief Take the writer side of the context
+ *
+ * Does nothing unless concurrent mode is enabled. Writers are serialized by
+ * a recursive mutex, so public writers may call each other.
+ */
+static void writer_lock(dmini_context_t ctx)
+{
+#if DMINI_USE_CONCURRENCY
+    if (ctx && ctx->concurrent)
+    {
+        Dmod_Mutex_Lock(ctx->write_mutex);
+        ctx->write_depth++;
+    }
+#endif
+}
+
+/**
+ * @brief Leave the writer side and reclaim memory no reader can still see
+ *
+ * Memory retired during an epoch is freed once no reader registered in that
+ * epoch remains; the epoch is then advanced so the current retirements can be
+ * reclaimed by a later writer. Readers are never waited for.
+ */
+static void writer_unlock(dmini_context_t ctx)
+{
+#if DMINI_USE_CONCURRENCY
+    if (ctx && ctx->concurrent)
+    {
+        if (--ctx->write_depth == 0)
+        {
+            unsigned int previous = (ctx->epoch & 1u) ^ 1u;
+            if (DMINI_ATOMIC_LOAD(&ctx->readers[previous]) == 0)
+            {
+                dmini_retired_t* list = ctx->retired[previous];
+                ctx->retired[previous] = NULL;
+                retire_reclaim(ctx, list);
+                DMINI_ATOMIC_ADD(&ctx->epoch, 1u);
+            }
+        }
+        Dmod_Mutex_Unlock(ctx->write_mutex);
+    }
+#endif
+}
+
+/**
+ * @brief Record that a section (and optionally one of its pairs) changed
+ *
+ * Appending to a file cannot reopen the global section, so a change there
+ * forces the next dmini_save_changes() to rewrite the file.
+ */
+static void mark_dirty(dmini_context_t ctx, dmini_section_t* section, dmini_pair_t* pair)
+{
+    if (pair)
+    {
+        pair->flags |= DMINI_PAIR_DIRTY;
+    }
+    if (!(section->flags & DMINI_SECTION_DIRTY))
+    {
+        section->flags |= DMINI_SECTION_DIRTY;
+        ctx->dirty_sections++;
+    }
+    if (section->name == NULL)
+    {
+        ctx->sync_rewrite = 1;
+    }
+}
+
+/**
+ * @brief Free a change watch
+ */
+static void watch_free(dmini_context_t ctx, dmini_watch_t* watch)
+{
+    ctx_free_string(ctx, watch->section);
+    ctx_free_string(ctx, watch->key);
+    ctx_free(ctx, watch, sizeof(dmini_watch_t));
+}
+
+/**
+ * @brief Free the watches unregistered while notifications were running
+ */
+static void watch_sweep(dmini_context_t ctx)
+{
+    dmini_watch_t** link = &ctx->watches;
+    while (*link)
+    {
+        dmini_watch_t* watch = *link;
+        if (watch->callback)
+        {
+            link = &watch->next;
+            continue;
+        }
+        *link = watch->next;
+        watch_free(ctx, watch);
+    }
+    ctx->watch_removed = 0;
+}
+
+/**
+ * @brief Call the watches of a key whose value changed
+ *
+ * Loading a lazy section is not a change and notifies nobody.
+ *
+ * @param value New value, or NULL when the key was removed
+ */
+static void watch_notify(dmini_context_t ctx, dmini_section_t* section, const char* key, const char* value)
+{
+    if (!ctx->watches || ctx->lazy_busy)
+    {
+        return;
+    }
+
+    ctx->notifying++;
+    for (dmini_watch_t* watch = ctx->watches; watch; watch = watch->next)
+    {
+        if (watch->callback && section_names_equal(watch->section, section->name) &&
+            (!watch->key || strcmp(watch->key, key) == 0))
+        {
+            watch->callback(ctx, section->name, key, value, watch->user);
+        }
+    }
+    if (--ctx->notifying == 0 && ctx->watch_removed)
+    {
+        watch_sweep(ctx);
+    }
+}
+
+/**
+ * @brief Get or create section from a name span
+ *
+ * When called from the public API (set_string, set_int) the active-section
+ * restriction is enforced: if it is active and the name is not the active
+ * section, NULL is returned instead of creating a duplicate entry.
+ * During parsing the restriction is never active, so behaviour is unchanged.
+ *
+ * @param name  Name span (NULL for the global section)
+ * @param len   Length of the span
+ * @param flags DMINI_BORROW_KEY to reference the name instead of copying it
+ */
+static dmini_section_t* get_or_create_section_span(dmini_context_t ctx, const char* name,
+                                                   size_t len, unsigned int flags)
+{
+    if (!ctx)
+    {
+        return NULL;
+    }
+
+    /* Resolve the effective section name the same way find_section() does */
+    if (ctx->active_section_locked)
+    {
+        if (name == NULL)
+        {
+            name = ctx->active_section;
+            len = name ? strlen(name) : 0;
+            flags &= ~DMINI_BORROW_KEY;
+        }
+        else if (ctx->active_section == NULL || !span_equals(ctx->active_section, strlen(ctx->active_section), name, len))
+        {
+            /* The requested section is not visible under the restriction */
+            DMINI_STAT_ADD(ctx, DMINI_STAT_REJECTIONS, 1);
+            return NULL;
+        }
+    }
+
+    /* Try to find existing section (raw, to avoid duplicate creation) */
+    unsigned int hash = hash_bytes(name ? name : "", len);
+    dmini_section_t* section = lookup_section(ctx, name, len, hash);
+    if (section)
+    {
+        return section;
+    }
+
+    /* Create new section using the effective name */
+    section = create_section(ctx, name, len, hash, flags);
+    if (!section)
+    {
+        return NULL;
+    }
+
+    /* Add to list */
+    if (!ctx->sections)
+    {
+        ctx->sections = section;
+    }
+    else
+    {
+        DMINI_PUBLISH(ctx->sections_tail->next, section);
+    }
+    ctx->sections_tail = section;
+    ctx->section_count++;
+    ctx->content_size += section->size;
+
+#if DMINI_USE_HASH_INDEX
+    index_add_section(ctx, section);
+#endif
+    mark_dirty(ctx, section, NULL);
+
+    return section;
+}
+
+/**
+ * @brief Get or create section
+ */
+static dmini_section_t* get_or_create_section(dmini_context_t ctx, const char* section_name)
+{
+    return get_or_create_section_span(ctx, section_name, section_name ? strlen(section_name) : 0, 0);
+}
+
+/**
+ * @brief Append a new pair to a section and announce it
+ */
+static void section_append_pair(dmini_context_t ctx, dmini_section_t* section, dmini_pair_t* pair)
+{
+    if (!section->pairs)
+    {
+        DMINI_PUBLISH(section->pairs, pair);
+    }
+    else
+    {
+        DMINI_PUBLISH(section->pairs_tail->next, pair);
+    }
+    section->pairs_tail = pair;
+    section->pair_count++;
+    section->size += pair_size(pair);
+    ctx->content_size += pair_size(pair);
+
+#if DMINI_USE_HASH_INDEX
+    index_add_pair(ctx, section, pair);
+#endif
+    mark_dirty(ctx, section, pair);
+    watch_notify(ctx, section, pair->key, pair->value);
+}
+
+/**
+ * @brief Unlink a pair from its section
+ *
+ * The caller notifies the watches and retires the pair.
+ *
+ * @param prev Pair before @p pair in the list (NULL for the first one)
+ */
+static void section_unlink_pair(dmini_context_t ctx, dmini_section_t* section,
+                                dmini_pair_t* prev, dmini_pair_t* pair)
+{
+    if (prev)
+    {
+        DMINI_PUBLISH(prev->next, pair->next);
+    }
+    else
+    {
+        DMINI_PUBLISH(section->pairs, pair->next);
+    }
+    if (section->pairs_tail == pair)
+    {
+        section->pairs_tail = prev;
+    }
+    section->pair_count--;
+    section->size -= pair_size(pair);
+    ctx->content_size -= pair_size(pair);
+
+#if DMINI_USE_HASH_INDEX
+    if (section->index)
+    {
+        index_remove(section->index, pair->hash, pair);
+    }
+#endif
+    ctx->sync_rewrite = 1;
+}
+
+/**
+ * @brief Unlink a section from the context
+ *
+ * The caller notifies the watches and retires the section.
+ *
+ * @param prev Section before @p section in the list
+ */
+static void context_unlink_section(dmini_context_t ctx, dmini_section_t* prev, dmini_section_t* section)
+{
+    if (prev)
+    {
+        DMINI_PUBLISH(prev->next, section->next);
+    }
+    else
+    {
+        DMINI_PUBLISH(ctx->sections, section->next);
+    }
+    if (ctx->sections_tail == section)
+    {
+        ctx->sections_tail = prev;
+    }
+    ctx->section_count--;
+    ctx->content_size -= section->size;
+
+#if DMINI_USE_HASH_INDEX
+    if (ctx->section_index)
+    {
+        index_remove(ctx->section_index, section->hash, section);
+    }
+#endif
+
+    if (section->flags & DMINI_SECTION_DIRTY)
+    {
+        ctx->dirty_sections--;
+    }
+    ctx->sync_rewrite = 1;
+}
+
+/**
+ * @brief Set key-value pair in section from key and value spans
+ *
+ * @param flags    DMINI_BORROW_KEY / DMINI_BORROW_VALUE to reference the spans
+ *                 instead of copying them
+ * @param out_pair Receives the updated or created pair (may be NULL)
+ */
+static int set_pair_span(dmini_context_t ctx, dmini_section_t* section,
+                         const char* key, size_t key_len,
+                         const char* value, size_t value_len, unsigned int flags,
+                         dmini_pair_t** out_pair)
+{
+    if (!section || !key)
+    {
+        return DMINI_ERR_INVALID;
+    }
+    
+    // Try to find existing pair
+    unsigned int hash = hash_bytes(key, key_len);
+    dmini_pair_t* pair = find_pair_hashed(ctx, section, key, key_len, hash);
+    if (pair)
+    {
+        // Nothing to do when the value does not change
+        if (span_equals(pair->value, pair->value_len, value, value_len))
+        {
+            if (out_pair)
+            {
+                *out_pair = pair;
+            }
+            return DMINI_OK;
+        }
+
+        // Update value (the old one is kept if the copy fails)
+        char* copy = (char*)value;
+        unsigned int value_flags = (flags & DMINI_BORROW_VALUE) ? DMINI_PAIR_VALUE_BORROWED : 0;
+        size_t old_len = pair->value_len;
+        if (!value_flags && CTX_STATIC(ctx) && !(pair->flags & DMINI_PAIR_VALUE_SHARED) &&
+            DMINI_ALIGN_UP(value_len + 1) == DMINI_ALIGN_UP(old_len + 1))
+        {
+            // A static context overwrites its own copy when the block size stays the same,
+            // so the size of every string block follows from its length
+            memmove(pair->value, value, value_len);
+            pair->value[value_len] = '\0';
+        }
+        else
+        {
+            if (!value_flags)
+            {
+                copy = pair_strndup(ctx, value, value_len, DMINI_PAIR_VALUE_INTERNED, &value_flags);
+                if (!copy)
+                {
+                    return DMINI_ERR_MEMORY;
+                }
+            }
+            char* old = pair->value;
+            DMINI_PUBLISH(pair->value, copy);
+            if (pair->flags & DMINI_PAIR_VALUE_INTERNED)
+            {
+                ctx_retire(ctx, DMINI_RETIRE_INTERNED, old, 0);
+            }
+            else if (!(pair->flags & DMINI_PAIR_VALUE_BORROWED))
+            {
+                ctx_retire(ctx, DMINI_RETIRE_SPAN, old, old_len);
+            }
+        }
+        section->size = section->size - old_len + value_len;
+        ctx->content_size = ctx->content_size - old_len + value_len;
+        pair->value_len = value_len;
+        pair->flags = (pair->flags & ~(DMINI_PAIR_VALUE_SHARED | DMINI_PAIR_CACHED_MASK)) | value_flags;
+        mark_dirty(ctx, section, pair);
+        watch_notify(ctx, section, pair->key, pair->value);
+        if (out_pair)
+        {
+            *out_pair = pair;
+        }
+        return DMINI_OK;
+    }
+    
+    // Create new pair
+    pair = create_pair(ctx, key, key_len, value, value_len, hash, flags);
+    if (!pair)
+    {
+        return DMINI_ERR_MEMORY;
+    }
+    section_append_pair(ctx, section, pair);
+    
+    if (out_pair)
+    {
+        *out_pair = pair;
+    }
+    return DMINI_OK;
+}
+
+/**
+ * @brief Set key-value pair in section
+ */
+static int set_pair_in_section(dmini_context_t ctx, dmini_section_t* section, const char* key, const char* value)
+{
+    if (!key || !value)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    return set_pair_span(ctx, section, key, strlen(key), value, strlen(value), 0, NULL);
+}
+
+/**
+ * @brief Terminate a span taken from the in-place buffer
+ *
+ * @return DMINI_BORROW_* flag to use for the span, or 0 if it must be copied
+ *         (its end is the end of the buffer, so there is no room for a NUL).
+ */
+static unsigned int borrow_span(dmini_parser_t* parser, const char* end, unsigned int flag)
+{
+    if (!parser->inplace_end || end >= parser->inplace_end)
+    {
+        return 0;
+    }
+
+    *(char*)end = '\0';
+    return flag;
+}
+
+#if DMINI_USE_PRESERVE
+/**
+ * @brief Record a header or pair line of the document being kept
+ *
+ * @param kind  DMINI_LINE_* flags
+ * @param line  Start of the line
+ * @param value Value span (NULL for a header)
+ */
+static int source_record(dmini_parser_t* parser, unsigned int kind, const char* line,
+                         const char* key, const char* key_end, const char* value, const char* value_end)
+{
+    dmini_source_t* source = parser->source;
+    if (source->line_count == source->line_capacity)
+    {
+        unsigned int capacity = source->line_capacity ? source->line_capacity * 2 : 32;
+        dmini_source_line_t* lines = (dmini_source_line_t*)ctx_realloc_temp(
+            parser->ctx, source->lines, source->line_capacity * sizeof(dmini_source_line_t),
+            capacity * sizeof(dmini_source_line_t));
+        if (!lines)
+        {
+            return DMINI_ERR_MEMORY;
+        }
+        source->lines = lines;
+        source->line_capacity = capacity;
+    }
+
+    const char* text = source->text;
+    dmini_source_line_t* entry = &source->lines[source->line_count++];
+    entry->start = (uint32_t)(line - text);
+    entry->end = (uint32_t)parser->line_next;
+    entry->key = (uint32_t)(key - text);
+    entry->key_len = (uint32_t)(key_end - key);
+    entry->value = value ? (uint32_t)(value - text) : entry->end;
+    entry->value_len = value ? (uint32_t)(value_end - value) : 0;
+    entry->hash = hash_bytes(key, (size_t)(key_end - key));
+    entry->kind = kind;
+    return DMINI_OK;
+}
+
+/**
+ * @brief Mark the line that set a key before a repeated one
+ *
+ * Only the last line of a key is spliced when its value changes; earlier
+ * ones are kept as they are and lose to it again when the output is parsed.
+ */
+static void source_shadow(dmini_parser_t* parser, const dmini_pair_t* pair)
+{
+    dmini_source_t* source = parser->source;
+    const char* text = source->text;
+
+    for (unsigned int i = source->line_count; i-- > 0;)
+    {
+        dmini_source_line_t* line = &source->lines[i];
+        if ((line->kind & (DMINI_LINE_HEADER | DMINI_LINE_SHADOWED)) || line->hash != pair->hash ||
+            !span_equals(pair->key, pair->key_len, text + line->key, line->key_len))
+        {
+            continue;
+        }
+
+        // The same key may also be set in a block of another section
+        unsigned int h = i;
+        while (h > 0 && !(source->lines[h - 1].kind & DMINI_LINE_HEADER))
+        {
+            h--;
+        }
+        const dmini_source_line_t* header = h > 0 ? &source->lines[h - 1] : NULL;
+        if (section_name_matches(parser->current_section, header ? text + header->key : NULL,
+                                 header ? header->key_len : 0))
+        {
+            line->kind |= DMINI_LINE_SHADOWED;
+            return;
+        }
+    }
+}
+#endif
+
+/**
+ * @brief Start of the line announcing a record appended by dmini_save_changes()
+ *
+ * The line is ";dmini-journal LLLLLLLL CCCCCCCC" with the length and the
+ * CRC-32 of the record following its terminator, as 8 hex digits. A record
+ * is applied only once all of it is found intact in the file, so a torn
+ * append leaves the values it would have changed as they were.
+ */
+#define DMINI_JOURNAL_TAG           ";dmini-journal "
+#define DMINI_JOURNAL_TAG_SIZE      15
+#define DMINI_JOURNAL_LINE_SIZE     (DMINI_JOURNAL_TAG_SIZE + 17)
+
+/**
+ * @brief Origin argument of Dmod_FileSeek() (SEEK_SET)
+ */
+#define DMINI_SEEK_SET              0
+
+/**
+ * @brief Check whether a line announces an appended record
+ *
+ * @return 1 and the length and CRC of the record, or 0 for any other line
+ */
+static int journal_header(const char* line, size_t len, size_t* length, uint32_t* crc)
+{
+    uint32_t value;
+    if (len != DMINI_JOURNAL_LINE_SIZE || memcmp(line, DMINI_JOURNAL_TAG, DMINI_JOURNAL_TAG_SIZE) != 0 ||
+        !hex_get(line + DMINI_JOURNAL_TAG_SIZE, &value) || line[DMINI_JOURNAL_TAG_SIZE + 8] != ' ' ||
+        !hex_get(line + DMINI_JOURNAL_TAG_SIZE + 9, crc))
+    {
+        return 0;
+    }
+    *length = value;
+    return 1;
+}
+
+/**
+ * @brief Check the next @p length bytes of an open file against a CRC-32
+ */
+static int file_crc_matches(dmini_context_t ctx, void* file, size_t length, uint32_t crc)
+{
+    size_t block_size = ctx->io_buffer_size;
+    char* block = (char*)ctx_alloc_temp(ctx, block_size);
+    size_t left = length;
+    uint32_t actual = 0;
+    size_t read;
+    while (block && left > 0 && (read = Dmod_FileRead(block, 1, left < block_size ? left : block_size, file)) > 0)
+    {
+        actual = crc32_update(actual, block, read);
+        left -= read;
+    }
+    int valid = block && left == 0 && actual == crc;
+
+    ctx_free_temp(ctx, block, block_size);
+    return valid;
+}
+
+/**
+ * @brief Check the record announced by the last parsed line
+ *
+ * The record is read through a handle of its own, so the parse goes on from
+ * where it is. A record that is cut short or fails its CRC ends the document
+ * before it: records are appended in order, so nothing after it is trusted.
+ *
+ * @param offset Offset of the record in the file
+ * @return 1 if the record is intact and may be parsed
+ */
+static int journal_check(dmini_parser_t* parser, size_t offset)
+{
+    parser->record = 0;
+    int valid = 0;
+    void* file = Dmod_FileOpen(parser->journal, "r");
+    if (file)
+    {
+        valid = Dmod_FileSeek(file, (long)offset, DMINI_SEEK_SET) == 0 &&
+                file_crc_matches(parser->ctx, file, parser->record_length, parser->record_crc);
+        Dmod_FileClose(file);
+    }
+    if (!valid)
+    {
+        parser->torn = 1;
+    }
+    return valid;
+}
+
+/**
+ * @brief Parse a single line (without its line terminator)
+ *
+ * Recognizes comments, [section] headers and key=value pairs. Strings are
+ * copied into the context, or borrowed from the input in in-place mode.
+ * Every delimiter is located with scan_for() and only whitespace is
+ * trimmed afterwards, so the line is not scanned again as a whole.
+ */
+static int parse_line(dmini_parser_t* parser, const char* line, size_t len)
+{
+    DMINI_STAT_ADD(parser->ctx, DMINI_STAT_PARSE_LINES, 1);
+
+    const char* begin = line;
+    const char* end = line + len;
+    while (begin < end && is_space(*begin))
+    {
+        begin++;
+    }
+
+    // Skip empty lines and comments; the caller checks an announced record
+    if (begin == end || *begin == ';' || *begin == '#')
+    {
+        if (parser->journal && begin == line)
+        {
+            parser->record = journal_header(line, len, &parser->record_length, &parser->record_crc);
+        }
+        return DMINI_OK;
+    }
+
+    // Check for section header
+    if (*begin == '[')
+    {
+        const char* name = begin + 1;
+        const char* name_end = scan_for(name, end, ']', ']', ']');
+
+        if (name_end < end)
+        {
+            trim_span(&name, &name_end);
+            if (parser->filtered &&
+                (!parser->only_section ||
+                 !span_equals(parser->only_section, parser->only_len, name, (size_t)(name_end - name))))
+            {
+                // Other sections are skipped without being created
+                parser->current_section = NULL;
+#if DMINI_USE_PRESERVE
+                if (parser->source)
+                {
+                    return source_record(parser, DMINI_LINE_HEADER | DMINI_LINE_FOREIGN, line,
+                                         name, name_end, NULL, NULL);
+                }
+#endif
+                return DMINI_OK;
+            }
+
+            unsigned int flags = borrow_span(parser, name_end, DMINI_BORROW_KEY);
+
+            dmini_section_t* section = get_or_create_section_span(parser->ctx, name,
+                                                                  (size_t)(name_end - name), flags);
+            if (!section)
+            {
+                return DMINI_ERR_MEMORY;
+            }
+            parser->current_section = section;
+#if DMINI_USE_PRESERVE
+            if (parser->source)
+            {
+                unsigned int kind = (section->flags & DMINI_SECTION_SOURCED) ? 0 : DMINI_LINE_FIRST;
+                section->flags |= DMINI_SECTION_SOURCED;
+                return source_record(parser, DMINI_LINE_HEADER | kind, line, name, name_end, NULL, NULL);
+            }
+#endif
+        }
+
+        return DMINI_OK;
+    }
+
+    // Lines of a skipped section are not tokenized
+    if (!parser->current_section)
+    {
+        return DMINI_OK;
+    }
+
+    // Parse key=value
+    const char* equals = scan_for(begin, end, '=', '=', '=');
+    if (equals == end)
+    {
+        return DMINI_OK;
+    }
+
+    const char* key = begin;
+    const char* key_end = equals;
+    while (key_end > key && is_space(key_end[-1]))
+    {
+        key_end--;
+    }
+    if (key == key_end)
+    {
+        return DMINI_OK;
+    }
+
+    // Inline comments end the value
+    const char* value = equals + 1;
+    const char* value_end = scan_for(value, end, ';', '#', '#');
+    trim_span(&value, &value_end);
+
+    unsigned int flags = borrow_span(parser, key_end, DMINI_BORROW_KEY) |
+                         borrow_span(parser, value_end, DMINI_BORROW_VALUE);
+
+    dmini_pair_t* pair = NULL;
+    int result = set_pair_span(parser->ctx, parser->current_section,
+                               key, (size_t)(key_end - key),
+                               value, (size_t)(value_end - value), flags, &pair);
+#if DMINI_USE_PRESERVE
+    if (result == DMINI_OK && parser->source)
+    {
+        if (pair->flags & DMINI_PAIR_SOURCED)
+        {
+            source_shadow(parser, pair);
+        }
+        pair->flags |= DMINI_PAIR_SOURCED;
+        result = source_record(parser, 0, line, key, key_end, value, value_end);
+    }
+#endif
+    return result;
+}
+
+/**
+ * @brief Parse a bounded buffer line by line
+ *
+ * Stops at the end of the range or at the first NUL character.
+ */
+static int parse_buffer(dmini_parser_t* parser, const char* data, size_t len)
+{
+    const char* p = data;
+    const char* end = data + len;
+
+    while (p < end && *p)
+    {
+        // Find end of line
+        const char* line = p;
+        p = scan_line_end(p, end);
+        size_t line_len = (size_t)(p - line);
+
+        // Skip the terminator (\r\n counts as a single one)
+        if (p < end && *p == '\r')
+        {
+            p++;
+            if (p < end && *p == '\n')
+            {
+                p++;
+            }
+        }
+        else if (p < end && *p == '\n')
+        {
+            p++;
+        }
+
+        int result = parse_line(parser, line, line_len);
+        if (result != DMINI_OK)
+        {
+            return result;
+        }
+    }
+
+    return DMINI_OK;
+}
+
+#if DMINI_USE_PRESERVE
+/**
+ * @brief Let a parser keep its document if the context is waiting for one
+ *
+ * Only the first document parsed after dmini_enable_format_preserving() is
+ * kept. A restricted context maps the global section to the active one, so
+ * the lines could not be placed back and nothing is kept.
+ */
+static void source_claim(dmini_parser_t* parser)
+{
+    dmini_context_t ctx = parser->ctx;
+    if (ctx->source && ctx->source->state == DMINI_SOURCE_EMPTY && !ctx->active_section_locked)
+    {
+        ctx->source->state = DMINI_SOURCE_LOADING;
+        parser->source = ctx->source;
+        parser->inplace_end = NULL;     /* strings are copied, the kept text still grows */
+    }
+}
+
+/**
+ * @brief Append data to the kept document and parse its complete lines
+ *
+ * Lines are parsed from the kept text, so the recorded spans are offsets
+ * into it. A line is complete once its terminator is known; a \r at the end
+ * of the data waits for a possible \n. A NUL character ends the document.
+ *
+ * @param last     1 when no more data follows (the last line needs no terminator)
+ * @param finished Set to 1 when a NUL character or a torn record ended the
+ *                 document (may be NULL)
+ */
+static int source_parse(dmini_parser_t* parser, const char* data, size_t len, int last, int* finished)
+{
+    dmini_source_t* source = parser->source;
+    const char* nul = len ? (const char*)memchr(data, '\0', len) : NULL;
+    if (nul)
+    {
+        len = (size_t)(nul - data);
+        last = 1;
+        if (finished)
+        {
+            *finished = 1;
+        }
+    }
+
+    if (source->len + len > source->capacity)
+    {
+        if (len > 0xFFFFFFFFu - source->len)
+        {
+            return DMINI_ERR_MEMORY;
+        }
+        size_t capacity = source->capacity ? source->capacity : 256;
+        while (capacity < source->len + len)
+        {
+            capacity *= 2;
+        }
+        char* text = (char*)ctx_realloc_temp(parser->ctx, source->text, source->capacity, capacity);
+        if (!text)
+        {
+            return DMINI_ERR_MEMORY;
+        }
+        source->text = text;
+        source->capacity = capacity;
+    }
+    if (len)
+    {
+        memcpy(source->text + source->len, data, len);
+        source->len += len;
+    }
+
+    const char* text = source->text;
+    const char* end = text + source->len;
+    const char* p = text + source->parsed;
+    while (p < end)
+    {
+        const char* line = p;
+        const char* line_end = scan_line_end(p, end);
+        if (!last && (line_end == end || (*line_end == '\r' && line_end + 1 == end)))
+        {
+            break;
+        }
+
+        // Skip the terminator (\r\n counts as a single one)
+        p = line_end;
+        if (p < end && *p++ == '\r' && p < end && *p == '\n')
+        {
+            p++;
+        }
+
+        parser->line_next = (size_t)(p - text);
+        source->parsed = parser->line_next;
+        int result = parse_line(parser, line, (size_t)(line_end - line));
+        if (result != DMINI_OK)
+        {
+            return result;
+        }
+
+        // The text of a torn record is not kept either
+        if (parser->record && !journal_check(parser, parser->line_next))
+        {
+            source->len = source->parsed;
+            if (finished)
+            {
+                *finished = 1;
+            }
+            break;
+        }
+    }
+
+    return DMINI_OK;
+}
+
+/**
+ * @brief Finish the document of a parser, keeping it if it was claimed
+ */
+static int source_finish(dmini_parser_t* parser, int result)
+{
+    if (parser->source)
+    {
+        if (result == DMINI_OK)
+        {
+            result = source_parse(parser, NULL, 0, 1, NULL);
+        }
+        parser->source->state = DMINI_SOURCE_KEPT;
+        parser->source = NULL;
+    }
+    return result;
+}
+#endif
+
+/**
+ * @brief Parse a whole document held in memory
+ *
+ * In format-preserving mode the document is copied into the kept source
+ * first; otherwise the lines are parsed straight from @p data.
+ */
+static int parse_document(dmini_parser_t* parser, const char* data, size_t len)
+{
+#if DMINI_USE_PRESERVE
+    source_claim(parser);
+    if (parser->source)
+    {
+        return source_finish(parser, source_parse(parser, data, len, 1, NULL));
+    }
+#endif
+    return parse_buffer(parser, data, len);
+}
+
+/**
+ * @brief Start parsing into a context
+ */
+static void parser_init(dmini_parser_t* parser, dmini_context_t ctx)
+{
+    parser->ctx = ctx;
+    parser->current_section = ctx->sections; // Start with global section
+    parser->inplace_end = NULL;
+    parser->filtered = 0;
+    parser->only_section = NULL;
+    parser->only_len = 0;
+    parser->journal = NULL;
+    parser->record_length = 0;
+    parser->record_crc = 0;
+    parser->record = 0;
+    parser->torn = 0;
+#if DMINI_USE_PRESERVE
+    parser->source = NULL;
+    parser->line_next = 0;
+#endif
+}
+
+/**
+ * @brief Keep only the pairs of one section (NULL = the global section)
+ */
+static void parser_filter(dmini_parser_t* parser, const char* section)
+{
+    parser->filtered = 1;
+    parser->only_section = section;
+    parser->only_len = section ? strlen(section) : 0;
+    if (section)
+    {
+        parser->current_section = NULL;
+    }
+}
+
+/**
+ * @brief Append data to the carry buffer of a stream, growing it as needed
+ */
+static int stream_append(dmini_context_t ctx, dmini_stream_t* stream, const char* data, size_t len)
+{
+    if (stream->line_len + len > stream->line_capacity)
+    {
+        size_t capacity = stream->line_capacity ? stream->line_capacity : 64;
+        while (capacity < stream->line_len + len)
+        {
+            capacity *= 2;
+        }
+
+        char* line = (char*)ctx_realloc_temp(ctx, stream->line, stream->line_capacity, capacity);
+        if (!line)
+        {
+            return DMINI_ERR_MEMORY;
+        }
+        stream->line = line;
+        stream->line_capacity = capacity;
+    }
+
+    memcpy(stream->line + stream->line_len, data, len);
+    stream->line_len += len;
+    return DMINI_OK;
+}
+
+/**
+ * @brief Feed a chunk of data to a stream
+ */
+static int stream_feed(dmini_context_t ctx, dmini_stream_t* stream, const char* data, size_t len)
+{
+#if DMINI_USE_PRESERVE
+    if (stream->parser.source)
+    {
+        return source_parse(&stream->parser, data, len, 0, &stream->finished);
+    }
+#endif
+
+    const char* p = data;
+    const char* end = data + len;
+    size_t base = stream->fed;
+    stream->fed += len;
+
+    if (stream->skip_lf && p < end)
+    {
+        // \r\n split across chunks
+        stream->skip_lf = 0;
+        if (*p == '\n')
+        {
+            p++;
+        }
+    }
+
+    while (p < end && !stream->finished)
+    {
+        const char* line = p;
+        p = scan_line_end(p, end);
+
+        if (p == end)
+        {
+            // Partial line, wait for the rest
+            return stream_append(ctx, stream, line, (size_t)(p - line));
+        }
+
+        int result;
+        if (stream->line_len)
+        {
+            result = stream_append(ctx, stream, line, (size_t)(p - line));
+            if (result == DMINI_OK)
+            {
+                result = parse_line(&stream->parser, stream->line, stream->line_len);
+            }
+            stream->line_len = 0;
+        }
+        else
+        {
+            result = parse_line(&stream->parser, line, (size_t)(p - line));
+        }
+        if (result != DMINI_OK)
+        {
+            return result;
+        }
+
+        // Skip the terminator (\r\n counts as a single one)
+        if (*p == '\0')
+        {
+            stream->finished = 1;
+        }
+        else if (*p++ == '\r')
+        {
+            if (p == end)
+            {
+                stream->skip_lf = 1;
+            }
+            else if (*p == '\n')
+            {
+                p++;
+            }
+        }
+
+        if (stream->parser.record && !journal_check(&stream->parser, base + (size_t)(p - data)))
+        {
+            stream->finished = 1;
+        }
+    }
+
+    return DMINI_OK;
+}
+
+/**
+ * @brief Prepare a stream for parsing into a context
+ */
+static void stream_init(dmini_stream_t* stream, dmini_context_t ctx)
+{
+    parser_init(&stream->parser, ctx);
+    stream->line = NULL;
+    stream->line_len = 0;
+    stream->line_capacity = 0;
+    stream->skip_lf = 0;
+    stream->finished = 0;
+    stream->error = DMINI_OK;
+    stream->fed = 0;
+}
+
+/**
+ * @brief Parse the unterminated last line and release the carry buffer
+ */
+static int stream_finish(dmini_context_t ctx, dmini_stream_t* stream, int result)
+{
+#if DMINI_USE_PRESERVE
+    result = source_finish(&stream->parser, result);
+#endif
+
+    // The last line does not need a terminator, but a record announced by it is missing
+    if (result == DMINI_OK && stream->line_len)
+    {
+        result = parse_line(&stream->parser, stream->line, stream->line_len);
+        if (stream->parser.record)
+        {
+            stream->parser.record = 0;
+            stream->parser.torn = 1;
+        }
+    }
+
+    ctx_free_temp(ctx, stream->line, stream->line_capacity);
+    stream->line = NULL;
+    stream->line_len = 0;
+    stream->line_capacity = 0;
+    return result;
+}
+
+/**
+ * @brief Release the chunked parser of a context
+ */
+static void stream_free(dmini_context_t ctx)
+{
+    dmini_stream_t* stream = ctx->stream;
+    if (stream)
+    {
+        stream_finish(ctx, stream, DMINI_ERR_GENERAL);
+        ctx_free_temp(ctx, stream, sizeof(dmini_stream_t));
+        ctx->stream = NULL;
+    }
+}
+
+/**
+ * @brief Write out the pending part of a file writer buffer
+ */
+static void writer_flush(dmini_writer_t* writer)
+{
+    if ((writer->file || writer->crc) && writer->pos && writer->error == DMINI_OK)
+    {
+        // Without a file the output is only checksummed
+        size_t written = writer->file ? Dmod_FileWrite(writer->buffer, 1, writer->pos, writer->file) : writer->pos;
+        if (writer->crc)
+        {
+            *writer->crc = crc32_update(*writer->crc, writer->buffer, written);
+        }
+        writer->flushed += written;
+        if (written != writer->pos)
+        {
+            writer->error = DMINI_ERR_FILE;
+        }
+        writer->pos = 0;
+    }
+}
+
+/**
+ * @brief Append data to a writer
+ *
+ * A writer without a buffer only counts the bytes, to measure the output.
+ */
+static void writer_put(dmini_writer_t* writer, const char* data, size_t len)
+{
+    if (!writer->buffer)
+    {
+        writer->pos += len;
+        return;
+    }
+
+    while (len > 0 && writer->error == DMINI_OK)
+    {
+        if (writer->pos == writer->size)
+        {
+            if (!writer->file)
+            {
+                writer->error = DMINI_ERR_MEMORY;
+                return;
+            }
+            writer_flush(writer);
+        }
+
+        size_t n = writer->size - writer->pos;
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(writer->buffer + writer->pos, data, n);
+        writer->pos += n;
+        data += n;
+        len -= n;
+    }
+}
+
+/**
+ * @brief Append a single character to a writer
+ */
+static inline void writer_putc(dmini_writer_t* writer, char c)
+{
+    if (writer->pos < writer->size)
+    {
+        writer->buffer[writer->pos++] = c;
+    }
+    else
+    {
+        writer_put(writer, &c, 1);
+    }
+}
+
+/**
+ * @brief Check whether a section is visible under the active-section restriction
+ */
+static inline int section_visible(dmini_context_t ctx, dmini_section_t* section)
+{
+    return !DMINI_LOAD(ctx->active_section_locked) || section_names_equal(section->name, DMINI_LOAD(ctx->active_section));
+}
+
+/**
+ * @brief Get the size of the generated INI text, including the terminator
+ *
+ * Computed from the sizes maintained by every modification, so no pass over
+ * the pairs is needed.
+ */
+static size_t serialized_size(dmini_context_t ctx)
+{
+    if (DMINI_LOAD(ctx->active_section_locked))
+    {
+        dmini_section_t* section = find_section_raw(ctx, DMINI_LOAD(ctx->active_section));
+        if (!section)
+        {
+            return 1;
+        }
+        return section->size + ((section->name && section->next) ? 1 : 0) + 1;
+    }
+
+    /* 
+     * The global section always comes first, so every named section except
+     * the last one is followed by an empty line.
+     */
+    size_t named = ctx->section_count - 1;
+    return ctx->content_size + (named ? named - 1 : 0) + 1;
+}
+
+/**
+ * @brief Emit the INI representation of the context
+ */
+static int emit_context(dmini_context_t ctx, dmini_writer_t* writer)
+{
+    for (dmini_section_t* section = ctx->sections; section; section = section->next)
+    {
+        /* Skip sections not visible under the active-section restriction */
+        if (!section_visible(ctx, section))
+        {
+            continue;
+        }
+
+        // Section header (skip global section)
+        if (section->name)
+        {
+            writer_putc(writer, '[');
+            writer_put(writer, section->name, section->name_len);
+            writer_putc(writer, ']');
+            writer_putc(writer, '\n');
+        }
+
+        // Key-value pairs
+        for (dmini_pair_t* pair = section->pairs; pair; pair = pair->next)
+        {
+            writer_put(writer, pair->key, pair->key_len);
+            writer_putc(writer, '=');
+            writer_put(writer, pair->value, pair->value_len);
+            writer_putc(writer, '\n');
+        }
+
+        // Empty line after section
+        if (section->name && section->next)
+        {
+            writer_putc(writer, '\n');
+        }
+    }
+
+    return writer->error;
+}
+
+/**
+ * @brief Clear the dirty flags of every section and pair
+ */
+static void clear_changes(dmini_context_t ctx)
+{
+    for (dmini_section_t* section = ctx->sections; section; section = section->next)
+    {
+        if (!(section->flags & DMINI_SECTION_DIRTY))
+        {
+            continue;
+        }
+        section->flags &= ~DMINI_SECTION_DIRTY;
+        for (dmini_pair_t* pair = section->pairs; pair; pair = pair->next)
+        {
+            pair->flags &= ~DMINI_PAIR_DIRTY;
+        }
+    }
+    ctx->dirty_sections = 0;
+}
+
+/**
+ * @brief Record that the content now matches a file
+ *
+ * Clears every dirty flag. Called after the file was parsed into an empty
+ * context or fully rewritten from the context.
+ */
+static void mark_synced(dmini_context_t ctx, const char* filename)
+{
+    clear_changes(ctx);
+    ctx->synced = 1;
+    ctx->sync_rewrite = 0;
+    ctx->sync_file = hash_string(filename);
+    ctx->journal_size = 0;
+}
+
+/**
+ * @brief Get the number of bytes emit_changes() writes
+ */
+static size_t changes_size(dmini_context_t ctx)
+{
+    size_t size = 0;
+    for (dmini_section_t* section = ctx->sections; section; section = section->next)
+    {
+        if (!(section->flags & DMINI_SECTION_DIRTY))
+        {
+            continue;
+        }
+        size += section->name_len + 4;
+        for (dmini_pair_t* pair = section->pairs; pair; pair = pair->next)
+        {
+            if (pair->flags & DMINI_PAIR_DIRTY)
+            {
+                size += pair_size(pair);
+            }
+        }
+    }
+    return size;
+}
+
+/**
+ * @brief Emit the dirty pairs of every dirty named section
+ *
+ * Each section is reopened with its header. Parsing merges a repeated
+ * section into the first one and lets later values win, so the file reads
+ * back as the current content. The flags are left for clear_changes().
+ */
+static int emit_changes(dmini_context_t ctx, dmini_writer_t* writer)
+{
+    for (dmini_section_t* section = ctx->sections; section; section = section->next)
+    {
+        if (!(section->flags & DMINI_SECTION_DIRTY))
+        {
+            continue;
+        }
+
+        writer_putc(writer, '\n');
+        writer_putc(writer, '[');
+        writer_put(writer, section->name, section->name_len);
+        writer_putc(writer, ']');
+        writer_putc(writer, '\n');
+
+        for (dmini_pair_t* pair = section->pairs; pair; pair = pair->next)
+        {
+            if (pair->flags & DMINI_PAIR_DIRTY)
+            {
+                writer_put(writer, pair->key, pair->key_len);
+                writer_putc(writer, '=');
+                writer_put(writer, pair->value, pair->value_len);
+                writer_putc(writer, '\n');
+            }
+        }
+    }
+
+    return writer->error;
+}
+
+#if DMINI_USE_PRESERVE
+/**
+ * @brief Whether the output is spliced into a kept document
+ *
+ * A restricted context emits only its active section, which is generated
+ * from the pairs as usual.
+ */
+static inline int source_kept(dmini_context_t ctx)
+{
+    return ctx->source && ctx->source->state == DMINI_SOURCE_KEPT && !ctx->active_section_locked;
+}
+
+/**
+ * @brief Check whether the kept document has a line for a key of a section
+ */
+static int source_has_key(const dmini_source_t* source, const dmini_section_t* section, const dmini_pair_t* pair)
+{
+    const char* text = source->text;
+    int in_section = section->name == NULL;
+    for (unsigned int i = 0; i < source->line_count; i++)
+    {
+        const dmini_source_line_t* line = &source->lines[i];
+        if (line->kind & DMINI_LINE_HEADER)
+        {
+            in_section = !(line->kind & DMINI_LINE_FOREIGN) && line->hash == section->hash &&
+                         section_name_matches(section, text + line->key, line->key_len);
+        }
+        else if (in_section && line->hash == pair->hash &&
+                 span_equals(pair->key, pair->key_len, text + line->key, line->key_len))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Check whether the kept document has a header of a section
+ */
+static int source_has_section(const dmini_source_t* source, const dmini_section_t* section)
+{
+    const char* text = source->text;
+    for (unsigned int i = 0; i < source->line_count; i++)
+    {
+        const dmini_source_line_t* line = &source->lines[i];
+        if ((line->kind & (DMINI_LINE_HEADER | DMINI_LINE_FOREIGN)) == DMINI_LINE_HEADER &&
+            line->hash == section->hash && section_name_matches(section, text + line->key, line->key_len))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Emit the pairs of a section that the kept document does not have
+ *
+ * @param newline   Line terminator of the document
+ * @param terminate 1 when the output does not end with a line terminator yet
+ * @return 1 if a pair was written
+ */
+static int source_emit_added(const dmini_source_t* source, const dmini_section_t* section,
+                              dmini_writer_t* writer, const char* newline, int terminate)
+{
+    int written = 0;
+    for (dmini_pair_t* pair = section->pairs; pair; pair = pair->next)
+    {
+        if ((pair->flags & DMINI_PAIR_SOURCED) || source_has_key(source, section, pair))
+        {
+            continue;
+        }
+        if (terminate)
+        {
+            writer_put(writer, newline, strlen(newline));
+        }
+        writer_put(writer, pair->key, pair->key_len);
+        writer_putc(writer, '=');
+        writer_put(writer, pair->value, pair->value_len);
+        writer_put(writer, newline, strlen(newline));
+        written = 1;
+        terminate = 0;
+    }
+    return written;
+}
+
+/**
+ * @brief Check whether the kept text ends a line right before an offset
+ */
+static inline int source_line_done(const dmini_source_t* source, size_t offset)
+{
+    return offset == 0 || source->text[offset - 1] == '\n' || source->text[offset - 1] == '\r';
+}
+
+/**
+ * @brief Emit the kept document with the current content spliced into it
+ *
+ * Runs of unchanged lines are copied from the kept text in one piece. A
+ * changed value replaces only its span, so the rest of the line, including
+ * an inline comment, stays. Lines of removed keys and the blocks of removed
+ * sections are left out. Keys the document does not have are written after
+ * the last recorded line of the first block of their section, and sections
+ * it does not have are appended at the end.
+ */
+static int emit_source(dmini_context_t ctx, dmini_writer_t* writer)
+{
+    const dmini_source_t* source = ctx->source;
+    const char* text = source->text;
+    const char* lf = source->len ? (const char*)memchr(text, '\n', source->len) : NULL;
+    const char* newline = (lf && lf > text && lf[-1] == '\r') ? "\r\n" : "\n";
+
+    size_t copied = 0;                  /* kept text written so far */
+    size_t insert = 0;                  /* where added keys of the block go (0 = before the next header) */
+    dmini_section_t* section = ctx->sections;   /* section of the block (NULL = copied or left out as is) */
+    int first = 1;                      /* the block receives the added keys of its section */
+    int dropped = 0;                    /* the section of the block was removed */
+    int terminated = 1;                 /* the output ends with a line terminator (or is empty) */
+
+    for (unsigned int i = 0; i <= source->line_count; i++)
+    {
+        const dmini_source_line_t* line = i < source->line_count ? &source->lines[i] : NULL;
+        if (line && !(line->kind & DMINI_LINE_HEADER))
+        {
+            if (!section)
+            {
+                continue;
+            }
+
+            dmini_pair_t* pair = find_pair_hashed(ctx, section, text + line->key, line->key_len, line->hash);
+            if (!pair)
+            {
+                writer_put(writer, text + copied, line->start - copied);
+                copied = line->end;
+                terminated = 1;
+            }
+            else if (!(line->kind & DMINI_LINE_SHADOWED) &&
+                     !span_equals(pair->value, pair->value_len, text + line->value, line->value_len))
+            {
+                writer_put(writer, text + copied, line->value - copied);
+                writer_put(writer, pair->value, pair->value_len);
+                copied = line->value + line->value_len;
+            }
+            insert = line->end;
+            continue;
+        }
+
+        // A header or the end of the text closes the block
+        size_t block_end = line ? line->start : source->len;
+        if (section && first)
+        {
+            size_t at = insert ? insert : block_end;
+            writer_put(writer, text + copied, at - copied);
+            copied = at;
+            terminated = source_line_done(source, at);
+            if (source_emit_added(source, section, writer, newline, !terminated))
+            {
+                terminated = 1;
+            }
+        }
+        else if (dropped)
+        {
+            copied = block_end;
+        }
+        if (!line)
+        {
+            break;
+        }
+
+        section = NULL;
+        first = 0;
+        dropped = 0;
+        insert = line->end;
+        if (!(line->kind & DMINI_LINE_FOREIGN))
+        {
+            section = lookup_section(ctx, text + line->key, line->key_len, line->hash);
+            if (section)
+            {
+                first = (line->kind & DMINI_LINE_FIRST) != 0;
+            }
+            else
+            {
+                writer_put(writer, text + copied, line->start - copied);
+                copied = line->start;
+                dropped = 1;
+                terminated = 1;
+            }
+        }
+    }
+    if (copied < source->len)
+    {
+        writer_put(writer, text + copied, source->len - copied);
+        terminated = source_line_done(source, source->len);
+    }
+
+    // Sections the document does not have follow it in the usual layout
+    for (dmini_section_t* added = ctx->sections->next; added; added = added->next)
+    {
+        if ((added->flags & DMINI_SECTION_SOURCED) || source_has_section(source, added))
+        {
+            continue;
+        }
+        if (!terminated)
+        {
+            writer_put(writer, newline, strlen(newline));
+            terminated = 1;
+        }
+        if (writer->pos + writer->flushed)
+        {
+            writer_put(writer, newline, strlen(newline));
+        }
+        writer_putc(writer, '[');
+        writer_put(writer, added->name, added->name_len);
+        writer_putc(writer, ']');
+        writer_put(writer, newline, strlen(newline));
+        for (dmini_pair_t* pair = added->pairs; pair; pair = pair->next)
+        {
+            writer_put(writer, pair->key, pair->key_len);
+            writer_putc(writer, '=');
+            writer_put(writer, pair->value, pair->value_len);
+            writer_put(writer, newline, strlen(newline));
+        }
+    }
+
+    return writer->error;
+}
+
+/**
+ * @brief Get the size of the spliced output, including the terminator
+ */
+static size_t source_size(dmini_context_t ctx)
+{
+    dmini_writer_t writer;
+    writer.buffer = NULL;
+    writer.size = 0;
+    writer.pos = 0;
+    writer.file = NULL;
+    writer.flushed = 0;
+    writer.crc = NULL;
+    writer.error = DMINI_OK;
+    emit_source(ctx, &writer);
+    return writer.pos + 1;
+}
+
+/**
+ * @brief Release the kept document
+ */
+static void source_free(dmini_context_t ctx)
+{
+    dmini_source_t* source = ctx->source;
+    if (source)
+    {
+        ctx_free_temp(ctx, source->text, source->capacity);
+        ctx_free_temp(ctx, source->lines, source->line_capacity * sizeof(dmini_source_line_t));
+        ctx_free_temp(ctx, source, sizeof(dmini_source_t));
+        ctx->source = NULL;
+    }
+}
+#endif
+
+// ============================================================================
+//                      Statistics
+// ============================================================================
+
+/**
+ * @brief Read the clock for timing a parse call
+ */
+static inline unsigned int stats_clock(void)
+{
+#if DMINI_USE_STATS
+    return (unsigned int)Dmod_GetTickCount();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Count a parse call that started at a stats_clock() time
+ */
+static inline void stats_parsed(dmini_context_t ctx, unsigned int started)
+{
+#if DMINI_USE_STATS
+    if (ctx)
+    {
+        DMINI_STAT_ADD(ctx, DMINI_STAT_PARSE_CALLS, 1);
+        DMINI_STAT_ADD(ctx, DMINI_STAT_PARSE_TIME, (unsigned int)Dmod_GetTickCount() - started);
+    }
+#endif
+}
+
+// ============================================================================
+//                      Lazy Loading
+// ============================================================================
+
+/**
+ * @brief Append a range to the pending ranges of a section
+ */
+static int lazy_add_range(dmini_context_t ctx, dmini_section_t* section, size_t offset, size_t length)
+{
+    dmini_lazy_range_t* range = (dmini_lazy_range_t*)ctx_alloc(ctx, sizeof(dmini_lazy_range_t));
+    if (!range)
+    {
+        return DMINI_ERR_MEMORY;
+    }
+
+    range->next = NULL;
+    range->offset = offset;
+    range->length = length;
+
+    dmini_lazy_range_t** tail = &section->lazy;
+    while (*tail)
+    {
+        tail = &(*tail)->next;
+    }
+    *tail = range;
+    ctx->lazy_size += length;
+    return DMINI_OK;
+}
+
+/**
+ * @brief Drop the pending ranges of a section
+ *
+ * The file name is released together with the last range.
+ */
+static void lazy_release(dmini_context_t ctx, dmini_section_t* section)
+{
+    while (section->lazy)
+    {
+        dmini_lazy_range_t* range = section->lazy;
+        section->lazy = range->next;
+        ctx->lazy_size -= range->length;
+        ctx_free(ctx, range, sizeof(dmini_lazy_range_t));
+    }
+
+    if (ctx->lazy_size == 0 && ctx->lazy_file)
+    {
+        ctx_free_string(ctx, ctx->lazy_file);
+        ctx->lazy_file = NULL;
+    }
+}
+
+/**
+ * @brief Parse the pending ranges of a section from the lazy file
+ *
+ * The loaded pairs are file content rather than changes, so the dirty state
+ * of the section is restored afterwards.
+ */
+static int section_load(dmini_context_t ctx, dmini_section_t* section)
+{
+    void* file = Dmod_FileOpen(ctx->lazy_file, "r");
+    if (!file)
+    {
+        return DMINI_ERR_FILE;
+    }
+
+    size_t block_size = ctx->io_buffer_size;
+    char* block = (char*)ctx_alloc_temp(ctx, block_size);
+    if (!block)
+    {
+        Dmod_FileClose(file);
+        return DMINI_ERR_MEMORY;
+    }
+
+    unsigned int dirty = section->flags & DMINI_SECTION_DIRTY;
+    int rewrite = ctx->sync_rewrite;
+    unsigned int started = stats_clock();
+    ctx->lazy_busy = 1;
+
+    int result = DMINI_OK;
+    for (dmini_lazy_range_t* range = section->lazy; range && result == DMINI_OK; range = range->next)
+    {
+        // Each range ends at a line boundary, so it is parsed as a document of its own
+        dmini_stream_t stream;
+        stream_init(&stream, ctx);
+        stream.parser.current_section = section;
+
+        if (Dmod_FileSeek(file, (long)range->offset, DMINI_SEEK_SET) != 0)
+        {
+            result = DMINI_ERR_FILE;
+        }
+
+        size_t left = range->length;
+        while (result == DMINI_OK && left > 0 && !stream.finished)
+        {
+            size_t read = Dmod_FileRead(block, 1, left < block_size ? left : block_size, file);
+            if (read == 0)
+            {
+                result = DMINI_ERR_FILE;
+                break;
+            }
+            result = stream_feed(ctx, &stream, block, read);
+            left -= read;
+        }
+        result = stream_finish(ctx, &stream, result);
+    }
+
+    ctx->lazy_busy = 0;
+    ctx_free_temp(ctx, block, block_size);
+    Dmod_FileClose(file);
+    stats_parsed(ctx, started);
+
+    if (!dirty && (section->flags & DMINI_SECTION_DIRTY))
+    {
+        section->flags &= ~DMINI_SECTION_DIRTY;
+        ctx->dirty_sections--;
+        for (dmini_pair_t* pair = section->pairs; pair; pair = pair->next)
+        {
+            pair->flags &= ~DMINI_PAIR_DIRTY;
+        }
+    }
+    ctx->sync_rewrite = rewrite;
+
+    if (result == DMINI_OK)
+    {
+        lazy_release(ctx, section);
+    }
+    return result;
+}
+
+/**
+ * @brief Parse every section that has not been loaded yet
+ *
+ * Called before anything that needs the whole content at once.
+ */
+static int lazy_load_all(dmini_context_t ctx)
+{
+    for (dmini_section_t* section = ctx->sections; section && ctx->lazy_file; section = section->next)
+    {
+        if (section->lazy)
+        {
+            int result = section_load(ctx, section);
+            if (result != DMINI_OK)
+            {
+                return result;
+            }
+        }
+    }
+    return DMINI_OK;
+}
+
+/**
+ * @brief Record the range of the current section that ends at a given offset
+ */
+static int lazy_scan_close(dmini_context_t ctx, dmini_lazy_scan_t* scan, dmini_section_t* section, size_t end)
+{
+    int result = DMINI_OK;
+    if (scan->content && end > scan->range_start)
+    {
+        result = lazy_add_range(ctx, section, scan->range_start, end - scan->range_start);
+    }
+    scan->content = 0;
+    return result;
+}
+
+/**
+ * @brief Parse a collected header line
+ *
+ * @param line_end Offset of the line terminator
+ */
+static int lazy_scan_header(dmini_context_t ctx, dmini_lazy_scan_t* scan, size_t line_end)
+{
+    dmini_stream_t* stream = &scan->stream;
+    dmini_section_t* previous = stream->parser.current_section;
+
+    int result = parse_line(&stream->parser, stream->line, stream->line_len);
+    stream->line_len = 0;
+    if (result == DMINI_OK && stream->parser.current_section != previous)
+    {
+        result = lazy_scan_close(ctx, scan, previous, scan->line_start);
+        scan->range_start = line_end + 1;
+    }
+    return result;
+}
+
+/**
+ * @brief Scan a block of the file for section headers
+ *
+ * @param base Offset of the block in the file
+ */
+static int lazy_scan_feed(dmini_context_t ctx, dmini_lazy_scan_t* scan, const char* data, size_t len, size_t base)
+{
+    const char* p = data;
+    const char* end = data + len;
+
+    while (p < end)
+    {
+        char c = *p;
+        if (c == '\n' || c == '\r' || c == '\0')
+        {
+            size_t offset = base + (size_t)(p - data);
+            if (scan->state == DMINI_SCAN_HEADER)
+            {
+                int result = lazy_scan_header(ctx, scan, offset);
+                if (result != DMINI_OK)
+                {
+                    return result;
+                }
+            }
+            else if (scan->state == DMINI_SCAN_COMMENT)
+            {
+                dmini_parser_t* parser = &scan->stream.parser;
+                parser->record = journal_header(scan->stream.line, scan->stream.line_len,
+                                                &parser->record_length, &parser->record_crc);
+                scan->stream.line_len = 0;
+                if (parser->record && (c != '\n' || !journal_check(parser, offset + 1)))
+                {
+                    // The document ends before the announcement of a torn record
+                    parser->torn = 1;
+                    scan->stream.finished = 1;
+                    scan->end = scan->line_start;
+                    return DMINI_OK;
+                }
+            }
+            if (c == '\0')
+            {
+                scan->stream.finished = 1;
+                scan->end = offset;
+                return DMINI_OK;
+            }
+
+            // \r\n leaves an empty line behind, which parses to nothing
+            scan->state = DMINI_SCAN_LINE_START;
+            scan->line_start = offset + 1;
+            p++;
+            continue;
+        }
+
+        const char* run = p;
+        switch (scan->state)
+        {
+            case DMINI_SCAN_LINE_START:
+                if (c == ' ' || c == '\t')
+                {
+                    p++;
+                }
+                else if (c == '[')
+                {
+                    scan->state = DMINI_SCAN_HEADER;
+                }
+                else if (c == ';' && scan->stream.parser.journal && base + (size_t)(p - data) == scan->line_start)
+                {
+                    scan->state = DMINI_SCAN_COMMENT;
+                }
+                else
+                {
+                    scan->state = DMINI_SCAN_SKIP;
+                    if (c != ';' && c != '#')
+                    {
+                        scan->content = 1;
+                    }
+                }
+                break;
+
+            case DMINI_SCAN_HEADER:
+            case DMINI_SCAN_COMMENT:
+                p = scan_line_end(p, end);
+                if (stream_append(ctx, &scan->stream, run, (size_t)(p - run)) != DMINI_OK)
+                {
+                    return DMINI_ERR_MEMORY;
+                }
+                break;
+
+            default:
+                p = scan_line_end(p, end);
+                break;
+        }
+    }
+
+    return DMINI_OK;
+}
+
+/**
+ * @brief Finish the scan at the end of the document and release the carry buffer
+ */
+static int lazy_scan_finish(dmini_context_t ctx, dmini_lazy_scan_t* scan, int result)
+{
+    if (result == DMINI_OK && scan->state == DMINI_SCAN_HEADER)
+    {
+        result = lazy_scan_header(ctx, scan, scan->end);
+    }
+    else if (scan->state == DMINI_SCAN_COMMENT)
+    {
+        // A record announced by the last line is missing
+        dmini_parser_t* parser = &scan->stream.parser;
+        if (journal_header(scan->stream.line, scan->stream.line_len, &parser->record_length, &parser->record_crc))
+        {
+            parser->torn = 1;
+            scan->end = scan->line_start;
+        }
+    }
+    if (result == DMINI_OK)
+    {
+        result = lazy_scan_close(ctx, scan, scan->stream.parser.current_section, scan->end);
+    }
+
+    ctx_free_temp(ctx, scan->stream.line, scan->stream.line_capacity);
+    scan->stream.line = NULL;
+    scan->stream.line_capacity = 0;
+    return result;
+}
+
+// ============================================================================
+//                      Frozen Snapshots
+// ============================================================================
+
+/**
+ * @brief Check whether a context is a read-only snapshot
+ */
+static inline int ctx_frozen(dmini_context_t ctx)
+{
+    return ctx && ctx->image;
+}
+
+/**
+ * @brief Get a string of the image (NULL for DMINI_IMAGE_NONE)
+ */
+static inline const char* image_string(const dmini_image_t* image, uint32_t offset)
+{
+    return offset == DMINI_IMAGE_NONE ? NULL : DMINI_IMAGE_AT(image, image->strings + offset, char);
+}
+
+static inline const dmini_image_section_t* image_sections(const dmini_image_t* image)
+{
+    return DMINI_IMAGE_AT(image, image->sections, dmini_image_section_t);
+}
+
+static inline const dmini_image_pair_t* image_pairs(const dmini_image_t* image)
+{
+    return DMINI_IMAGE_AT(image, image->pairs, dmini_image_pair_t);
+}
+
+/**
+ * @brief Start slot of a pair in the pair table
+ *
+ * Keys of all sections share one table, so the section index is mixed in.
+ */
+static inline uint32_t image_pair_slot(uint32_t section, uint32_t hash)
+{
+    return hash ^ (section * 0x9E3779B1u);
+}
+
+/**
+ * @brief Compare the name of a section record with a name span
+ */
+static int image_section_matches(const dmini_image_t* image, const dmini_image_section_t* section,
+                                 const char* name, size_t len)
+{
+    const char* section_name = image_string(image, section->name);
+    if (section_name == NULL || name == NULL)
+    {
+        return section_name == name;
+    }
+    return span_equals(section_name, section->name_len, name, len);
+}
+
+/**
+ * @brief Find a section record, applying the restriction frozen into the image
+ */
+static const dmini_image_section_t* image_find_section(const dmini_image_t* image, const char* name)
+{
+    size_t len = name ? strlen(name) : 0;
+    const dmini_image_section_t* sections = image_sections(image);
+
+    /* A restricted image holds only the active section, which NULL refers to */
+    if (image->flags & DMINI_IMAGE_RESTRICTED)
+    {
+        if (image->section_count == 0)
+        {
+            return NULL;
+        }
+        return (name == NULL || image_section_matches(image, &sections[0], name, len)) ? &sections[0] : NULL;
+    }
+
+    unsigned int hash = hash_bytes(name ? name : "", len);
+    const dmini_image_slot_t* table = DMINI_IMAGE_AT(image, image->section_table, dmini_image_slot_t);
+    uint32_t mask = image->section_slots - 1;
+    for (uint32_t i = hash & mask; table[i].index; i = (i + 1) & mask)
+    {
+        const dmini_image_section_t* section = &sections[table[i].index - 1];
+        if (table[i].hash == hash && image_section_matches(image, section, name, len))
+        {
+            return section;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Find a pair record in a section record
+ */
+static const dmini_image_pair_t* image_find_pair(const dmini_image_t* image,
+                                                 const dmini_image_section_t* section, const char* key)
+{
+    if (!section || !key)
+    {
+        return NULL;
+    }
+
+    size_t len = strlen(key);
+    unsigned int hash = hash_bytes(key, len);
+    uint32_t index = (uint32_t)(section - image_sections(image));
+    const dmini_image_pair_t* pairs = image_pairs(image);
+    const dmini_image_slot_t* table = DMINI_IMAGE_AT(image, image->pair_table, dmini_image_slot_t);
+    uint32_t mask = image->pair_slots - 1;
+    for (uint32_t i = image_pair_slot(index, hash) & mask; table[i].index; i = (i + 1) & mask)
+    {
+        const dmini_image_pair_t* pair = &pairs[table[i].index - 1];
+        if (table[i].hash == hash && pair->section == index &&
+            span_equals(image_string(image, pair->key), pair->key_len, key, len))
+        {
+            return pair;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Get the value of a key in a snapshot (NULL if not found)
+ */
+static const char* frozen_value(dmini_context_t ctx, const char* section, const char* key)
+{
+    const dmini_image_t* image = ctx->image;
+    const dmini_image_pair_t* pair = image_find_pair(image, image_find_section(image, section), key);
+    return pair ? image_string(image, pair->value) : NULL;
+}
+
+/**
+ * @brief Get the capacity of a hash table holding @p count entries
+ *
+ * The load factor stays at or below one half, so probes always end at an
+ * empty slot.
+ */
+static uint32_t image_slots(uint32_t count)
+{
+    uint32_t slots = 1;
+    while (slots < count * 2u)
+    {
+        slots <<= 1;
+    }
+    return slots;
+}
+
+/**
+ * @brief Compute the layout of the image of a context
+ *
+ * Only the sections visible under the active-section restriction are
+ * included; a restricted context yields a restricted image.
+ *
+ * @param header Filled with the counts and offsets of the image
+ * @return Size of the image in bytes, or 0 if it does not fit 32-bit offsets
+ */
+static size_t image_measure(dmini_context_t ctx, dmini_image_t* header)
+{
+    size_t sections = 0;
+    size_t pairs = 0;
+    size_t strings = 0;
+    size_t named = 0;
+    size_t text = 1;
+
+    for (dmini_section_t* section = ctx->sections; section; section = section->next)
+    {
+        if (!section_visible(ctx, section))
+        {
+            continue;
+        }
+        sections++;
+        pairs += section->pair_count;
+        if (section->name)
+        {
+            strings += section->name_len + 1;
+            named++;
+        }
+        text += section->size;
+        for (dmini_pair_t* pair = section->pairs; pair; pair = pair->next)
+        {
+            strings += pair->key_len + pair->value_len + 2;
+        }
+    }
+
+    /* Named sections come last, and each one but the last is followed by an empty line */
+    text += named ? named - 1 : 0;
+
+    if (sections > 0x3FFFFFFFu || pairs > 0x3FFFFFFFu)
+    {
+        return 0;
+    }
+
+    header->magic = DMINI_IMAGE_MAGIC;
+    header->version = DMINI_IMAGE_VERSION;
+    header->flags = ctx->active_section_locked ? DMINI_IMAGE_RESTRICTED : 0;
+    header->text_size = (uint32_t)text;
+    header->section_count = (uint32_t)sections;
+    header->pair_count = (uint32_t)pairs;
+    header->section_slots = image_slots(header->section_count);
+    header->pair_slots = image_slots(header->pair_count);
+    header->sections = sizeof(dmini_image_t);
+
+    size_t offset = header->sections + sections * sizeof(dmini_image_section_t);
+    header->pairs = (uint32_t)offset;
+    offset += pairs * sizeof(dmini_image_pair_t);
+    header->section_table = (uint32_t)offset;
+    offset += header->section_slots * sizeof(dmini_image_slot_t);
+    header->pair_table = (uint32_t)offset;
+    offset += header->pair_slots * sizeof(dmini_image_slot_t);
+    header->strings = (uint32_t)offset;
+    offset += strings;
+
+    if (offset > 0xFFFFFFFFu)
+    {
+        return 0;
+    }
+    header->size = (uint32_t)offset;
+    return offset;
+}
+
+/**
+ * @brief Append a string to the pool of an image under construction
+ */
+static uint32_t image_put_string(char* base, const dmini_image_t* header, uint32_t* pool_used,
+                                 const char* str, size_t len)
+{
+    uint32_t offset = *pool_used;
+    memcpy(base + header->strings + offset, str, len);
+    base[header->strings + offset + len] = '\0';
+    *pool_used += (uint32_t)len + 1;
+    return offset;
+}
+
+/**
+ * @brief Write the image of a context laid out by image_measure()
+ *
+ * @param out Destination of header->size bytes, aligned to 4 bytes
+ */
+static void image_write(dmini_context_t ctx, const dmini_image_t* header, void* out)
+{
+    char* base = (char*)out;
+    dmini_image_section_t* sections = (dmini_image_section_t*)(base + header->sections);
+    dmini_image_pair_t* pairs = (dmini_image_pair_t*)(base + header->pairs);
+    dmini_image_slot_t* section_table = (dmini_image_slot_t*)(base + header->section_table);
+    dmini_image_slot_t* pair_table = (dmini_image_slot_t*)(base + header->pair_table);
+    uint32_t pool_used = 0;
+    uint32_t section_index = 0;
+    uint32_t pair_index = 0;
+
+    memcpy(base, header, sizeof(dmini_image_t));
+    memset(section_table, 0, header->section_slots * sizeof(dmini_image_slot_t));
+    memset(pair_table, 0, header->pair_slots * sizeof(dmini_image_slot_t));
+
+    for (dmini_section_t* section = ctx->sections; section; section = section->next)
+    {
+        if (!section_visible(ctx, section))
+        {
+            continue;
+        }
+
+        dmini_image_section_t* record = &sections[section_index];
+        record->name = section->name ? image_put_string(base, header, &pool_used, section->name, section->name_len)
+                                     : DMINI_IMAGE_NONE;
+        record->name_len = (uint32_t)section->name_len;
+        record->hash = section->hash;
+        record->first_pair = pair_index;
+        record->pair_count = section->pair_count;
+
+        uint32_t mask = header->section_slots - 1;
+        uint32_t slot = section->hash & mask;
+        while (section_table[slot].index)
+        {
+            slot = (slot + 1) & mask;
+        }
+        section_table[slot].hash = section->hash;
+        section_table[slot].index = section_index + 1;
+
+        for (dmini_pair_t* pair = section->pairs; pair; pair = pair->next)
+        {
+            dmini_image_pair_t* entry = &pairs[pair_index];
+            entry->key = image_put_string(base, header, &pool_used, pair->key, pair->key_len);
+            entry->key_len = (uint32_t)pair->key_len;
+            entry->value = image_put_string(base, header, &pool_used, pair->value, pair->value_len);
+            entry->value_len = (uint32_t)pair->value_len;
+            entry->hash = pair->hash;
+            entry->section = section_index;
+
+            mask = header->pair_slots - 1;
+            slot = image_pair_slot(section_index, pair->hash) & mask;
+            while (pair_table[slot].index)
+            {
+                slot = (slot + 1) & mask;
+            }
+            pair_table[slot].hash = pair->hash;
+            pair_table[slot].index = pair_index + 1;
+            pair_index++;
+        }
+        section_index++;
+    }
+}
+
+/**
+ * @brief Check that a table region lies inside the image
+ */
+static inline int image_region_valid(const dmini_image_t* image, uint32_t offset, uint32_t count, size_t record)
+{
+    return offset >= sizeof(dmini_image_t) && (offset & 3u) == 0 && offset <= image->size &&
+           (uint64_t)count * record <= image->size - offset;
+}
+
+/**
+ * @brief Check that a string of the pool is in bounds and NUL-terminated
+ */
+static inline int image_string_valid(const dmini_image_t* image, uint32_t offset, uint32_t len)
+{
+    uint64_t end = (uint64_t)image->strings + offset + len;
+    return end < image->size && ((const char*)image)[end] == '\0';
+}
+
+/**
+ * @brief Validate an image before it is queried in place
+ *
+ * Checks the header and every reference, so a corrupt or foreign image is
+ * rejected instead of being read out of bounds. One linear pass over the
+ * records; nothing is copied.
+ */
+static int image_valid(const dmini_image_t* image, size_t size)
+{
+    if (((uintptr_t)image & 3u) != 0 || size < sizeof(dmini_image_t) ||
+        image->magic != DMINI_IMAGE_MAGIC || image->version != DMINI_IMAGE_VERSION ||
+        image->size < sizeof(dmini_image_t) || image->size > size)
+    {
+        return 0;
+    }
+
+    if (image->section_slots == 0 || (image->section_slots & (image->section_slots - 1)) != 0 ||
+        image->pair_slots == 0 || (image->pair_slots & (image->pair_slots - 1)) != 0 ||
+        image->section_slots < 2u * image->section_count || image->pair_slots < 2u * image->pair_count ||
+        !image_region_valid(image, image->sections, image->section_count, sizeof(dmini_image_section_t)) ||
+        !image_region_valid(image, image->pairs, image->pair_count, sizeof(dmini_image_pair_t)) ||
+        !image_region_valid(image, image->section_table, image->section_slots, sizeof(dmini_image_slot_t)) ||
+        !image_region_valid(image, image->pair_table, image->pair_slots, sizeof(dmini_image_slot_t)) ||
+        image->strings < sizeof(dmini_image_t) || image->strings > image->size)
+    {
+        return 0;
+    }
+
+    /* The generated text size is recomputed, since generation trusts it */
+    const dmini_image_section_t* sections = image_sections(image);
+    uint32_t next_pair = 0;
+    uint64_t text = 1;
+    for (uint32_t i = 0; i < image->section_count; i++)
+    {
+        const dmini_image_section_t* section = &sections[i];
+        if ((section->name != DMINI_IMAGE_NONE && !image_string_valid(image, section->name, section->name_len)) ||
+            section->first_pair != next_pair || section->pair_count > image->pair_count - next_pair)
+        {
+            return 0;
+        }
+        if (section->name != DMINI_IMAGE_NONE)
+        {
+            /* Header line, plus an empty line unless it is the last section */
+            text += (uint64_t)section->name_len + 3 + (i + 1 < image->section_count ? 1 : 0);
+        }
+        next_pair += section->pair_count;
+    }
+    if (next_pair != image->pair_count)
+    {
+        return 0;
+    }
+
+    const dmini_image_pair_t* pairs = image_pairs(image);
+    for (uint32_t i = 0; i < image->pair_count; i++)
+    {
+        const dmini_image_pair_t* pair = &pairs[i];
+        if (pair->section >= image->section_count ||
+            i - sections[pair->section].first_pair >= sections[pair->section].pair_count ||
+            !image_string_valid(image, pair->key, pair->key_len) ||
+            !image_string_valid(image, pair->value, pair->value_len))
+        {
+            return 0;
+        }
+        text += (uint64_t)pair->key_len + pair->value_len + 2;
+    }
+    if (text != image->text_size)
+    {
+        return 0;
+    }
+
+    const dmini_image_slot_t* tables[2] = {
+        DMINI_IMAGE_AT(image, image->section_table, dmini_image_slot_t),
+        DMINI_IMAGE_AT(image, image->pair_table, dmini_image_slot_t)
+    };
+    const uint32_t slots[2] = { image->section_slots, image->pair_slots };
+    const uint32_t counts[2] = { image->section_count, image->pair_count };
+    for (int t = 0; t < 2; t++)
+    {
+        uint32_t used = 0;
+        for (uint32_t i = 0; i < slots[t]; i++)
+        {
+            if (tables[t][i].index > counts[t])
+            {
+                return 0;
+            }
+            used += tables[t][i].index ? 1u : 0u;
+        }
+        /* At least one empty slot keeps every probe finite */
+        if (used != counts[t])
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Emit the INI representation of a snapshot
+ */
+static int image_emit(const dmini_image_t* image, dmini_writer_t* writer)
+{
+    const dmini_image_section_t* sections = image_sections(image);
+    const dmini_image_pair_t* pairs = image_pairs(image);
+
+    for (uint32_t i = 0; i < image->section_count; i++)
+    {
+        const dmini_image_section_t* section = &sections[i];
+        const char* name = image_string(image, section->name);
+
+        if (name)
+        {
+            writer_putc(writer, '[');
+            writer_put(writer, name, section->name_len);
+            writer_putc(writer, ']');
+            writer_putc(writer, '\n');
+        }
+
+        for (uint32_t j = 0; j < section->pair_count; j++)
+        {
+            const dmini_image_pair_t* pair = &pairs[section->first_pair + j];
+            writer_put(writer, image_string(image, pair->key), pair->key_len);
+            writer_putc(writer, '=');
+            writer_put(writer, image_string(image, pair->value), pair->value_len);
+            writer_putc(writer, '\n');
+        }
+
+        if (name && i + 1 < image->section_count)
+        {
+            writer_putc(writer, '\n');
+        }
+    }
+
+    return writer->error;
+}
+
+// ============================================================================
+//                      Atomic Saves
+// ============================================================================
+
+/**
+ * @brief Start of the trailer closing a slot file
+ *
+ * The trailer is "\n;dmini-slot SSSSSSSS CCCCCCCC\n" with the sequence number
+ * and the CRC-32 of the text as 8 hex digits. Being a comment, it keeps the
+ * slot a valid INI file; being written last, it is missing after a torn write.
+ */
+#define DMINI_SLOT_TAG              "\n;dmini-slot "
+#define DMINI_SLOT_TAG_SIZE         13
+#define DMINI_SLOT_TRAILER_SIZE     (DMINI_SLOT_TAG_SIZE + 18)
+
+/**
+ * @brief Build the name of a slot file ("<filename>.0" or "<filename>.1")
+ *
+ * @param size Out size of the temporary buffer, for ctx_free_temp()
+ */
+static char* slot_name(dmini_context_t ctx, const char* filename, int slot, size_t* size)
+{
+    size_t len = strlen(filename);
+    *size = len + 3;
+    char* name = (char*)ctx_alloc_temp(ctx, *size);
+    if (name)
+    {
+        memcpy(name, filename, len);
+        name[len] = '.';
+        name[len + 1] = (char)('0' + slot);
+        name[len + 2] = '\0';
+    }
+    return name;
+}
+
+/**
+ * @brief Open a slot file
+ */
+static void* slot_open(dmini_context_t ctx, const char* filename, int slot, const char* mode)
+{
+    size_t size;
+    char* name = slot_name(ctx, filename, slot, &size);
+    if (!name)
+    {
+        return NULL;
+    }
+    void* file = Dmod_FileOpen(name, mode);
+    ctx_free_temp(ctx, name, size);
+    return file;
+}
+
+/**
+ * @brief Read the trailer of a slot file
+ *
+ * Only the end of the file is read; the text is checked by slot_verify().
+ */
+static void slot_read_trailer(dmini_context_t ctx, const char* filename, int slot, dmini_slot_t* state)
+{
+    state->valid = 0;
+    void* file = slot_open(ctx, filename, slot, "r");
+    if (!file)
+    {
+        return;
+    }
+
+    char trailer[DMINI_SLOT_TRAILER_SIZE];
+    size_t size = Dmod_FileSize(file);
+    if (size >= DMINI_SLOT_TRAILER_SIZE &&
+        Dmod_FileSeek(file, (long)(size - DMINI_SLOT_TRAILER_SIZE), DMINI_SEEK_SET) == 0 &&
+        Dmod_FileRead(trailer, 1, sizeof(trailer), file) == sizeof(trailer) &&
+        memcmp(trailer, DMINI_SLOT_TAG, DMINI_SLOT_TAG_SIZE) == 0 &&
+        hex_get(trailer + DMINI_SLOT_TAG_SIZE, &state->sequence) &&
+        trailer[DMINI_SLOT_TAG_SIZE + 8] == ' ' &&
+        hex_get(trailer + DMINI_SLOT_TAG_SIZE + 9, &state->crc) &&
+        trailer[DMINI_SLOT_TRAILER_SIZE - 1] == '\n')
+    {
+        state->length = size - DMINI_SLOT_TRAILER_SIZE;
+        state->valid = 1;
+    }
+    Dmod_FileClose(file);
+}
+
+/**
+ * @brief Check the text of a slot file against the CRC of its trailer
+ */
+static int slot_verify(dmini_context_t ctx, const char* filename, int slot, const dmini_slot_t* state)
+{
+    void* file = slot_open(ctx, filename, slot, "r");
+    if (!file)
+    {
+        return 0;
+    }
+
+    int valid = file_crc_matches(ctx, file, state->length, state->crc);
+    Dmod_FileClose(file);
+    return valid;
+}
+
+/**
+ * @brief Find the slot holding the newest valid content
+ *
+ * The newer slot by sequence number (with wrap-around) is verified first;
+ * the older one is only read when the newer one is torn.
+ *
+ * @param slots Out state of both slots
+ * @return Index of the slot, or -1 if none is valid
+ */
+static int slot_newest(dmini_context_t ctx, const char* filename, dmini_slot_t slots[2])
+{
+    slot_read_trailer(ctx, filename, 0, &slots[0]);
+    slot_read_trailer(ctx, filename, 1, &slots[1]);
+
+    int first = 0;
+    if (slots[1].valid && (!slots[0].valid || (int32_t)(slots[1].sequence - slots[0].sequence) > 0))
+    {
+        first = 1;
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        int slot = first ^ i;
+        if (slots[slot].valid && slot_verify(ctx, filename, slot, &slots[slot]))
+        {
+            return slot;
+        }
+        slots[slot].valid = 0;
+    }
+    return -1;
+}
+
+// ============================================================================
+//                      Module Interface Implementation
+// ============================================================================
+
+/**
+ * @brief Module initialization (optional)
+ */
+void dmod_preinit(void)
+{
+    // Nothing to do
+}
+
+/**
+ * @brief Module initialization
+ */
+int dmod_init(const Dmod_Config_t *Config)
+{
+    // Nothing to do
+    return 0;
+}
+
+/**
+ * @brief Module deinitialization
+ */
+void dmod_deinit(void)
+{
+    // Nothing to do
+}
+
+// ============================================================================
+//                      Public API Implementation
+// ============================================================================
+
+dmini_context_t dmini_create(void)
+{
+    return dmini_create_with_token(0);
+}
+
+/**
+ * @brief Set the fields of a freshly allocated context to an empty state
+ */
+static void context_reset(dmini_context_t ctx, unsigned int owner_token)
+{
     ctx->sections = NULL;
+    ctx->sections_tail = NULL;
+    ctx->section_count = 0;
+    ctx->content_size = 0;
+#if DMINI_USE_HASH_INDEX
+    ctx->section_index = NULL;
+#endif
     ctx->owner_token = owner_token;
     ctx->active_section = NULL;
     ctx->active_section_locked = 0;
+    ctx->stream = NULL;
+    ctx->io_buffer_size = DMINI_IO_BUFFER_SIZE;
+    ctx->generation = 1;
+    ctx->section_cursor.node = NULL;
+    ctx->key_cursor.node = NULL;
+#if DMINI_USE_CONCURRENCY
+    ctx->concurrent = 0;
+    ctx->write_mutex = NULL;
+    ctx->write_depth = 0;
+    ctx->epoch = 0;
+    ctx->readers[0] = ctx->readers[1] = 0;
+    ctx->retired[0] = ctx->retired[1] = NULL;
+#endif
+    ctx->image = NULL;
+    ctx->synced = 0;
+    ctx->sync_rewrite = 0;
+    ctx->sync_file = 0;
+    ctx->dirty_sections = 0;
+    ctx->journal_size = 0;
+    ctx->lazy_file = NULL;
+    ctx->lazy_size = 0;
+    ctx->lazy_busy = 0;
+    ctx->slot_file = 0;
+    ctx->slot_current = -1;
+    ctx->slot_sequence = 0;
+#if DMINI_USE_STATIC
+    ctx->fixed = 0;
+    ctx->free_sections = NULL;
+    ctx->free_pairs = NULL;
+    ctx->free_blocks = NULL;
+#endif
+#if DMINI_USE_STATS
+    memset(ctx->stats, 0, sizeof(ctx->stats));
+#endif
+#if DMINI_USE_INTERN
+    ctx->intern_buckets = NULL;
+    ctx->intern_capacity = 0;
+    ctx->intern_count = 0;
+#endif
+#if DMINI_USE_PRESERVE
+    ctx->source = NULL;
+#endif
+    ctx->watches = NULL;
+    ctx->notifying = 0;
+    ctx->watch_removed = 0;
+}
+
+/**
+ * @brief Create the global section of a reset context
+ */
+static int context_add_global(dmini_context_t ctx)
+{
+    /* Create global section (unnamed section for keys without section) */
+    ctx->sections = create_section(ctx, NULL, 0, hash_string(NULL), 0);
+    if (!ctx->sections)
+    {
+        return DMINI_ERR_MEMORY;
+    }
+    ctx->sections_tail = ctx->sections;
+    ctx->section_count = 1;
+
+    return DMINI_OK;
+}
+
+/**
+ * @brief Initialize a freshly allocated context and create its global section
+ */
+static int context_init(dmini_context_t ctx, unsigned int owner_token)
+{
+    context_reset(ctx, owner_token);
+    return context_add_global(ctx);
+}
+
+dmini_context_t dmini_create_with_token(unsigned int owner_token)
+{
+    return dmini_create_ex(NULL, 0, owner_token);
+}
+
+/**
+ * @brief Make the first allocation of an arena block the context and initialize it
+ *
+ * @param block_size Size of further blocks (0 = caller buffer, no growth)
+ */
+static dmini_context_t context_in_block(dmini_arena_block_t* block, size_t block_size,
+                                        const dmini_allocator_t* allocator, unsigned int owner_token)
+{
+    dmini_context_t ctx = (dmini_context_t)arena_data(block);
+    block->used = DMINI_ALIGN_UP(sizeof(struct dmini_context));
+    ctx->allocator = *allocator;
+    ctx->arena = block;
+    ctx->arena_block_size = block_size;
+    ctx->memory_used = 0;
+
+    if (context_init(ctx, owner_token) != DMINI_OK)
+    {
+        dmini_destroy(ctx);
+        return NULL;
+    }
+
+    return ctx;
+}
+
+dmini_context_t dmini_create_ex(const dmini_allocator_t* allocator, size_t arena_block_size, unsigned int owner_token)
+{
+    if (!allocator)
+    {
+        allocator = &default_allocator;
+    }
+    if (!allocator->malloc_fn || !allocator->free_fn)
+    {
+        return NULL;
+    }
+
+    if (arena_block_size)
+    {
+        size_t block_size = DMINI_ALIGN_UP(arena_block_size);
+        if (block_size < DMINI_ALIGN_UP(sizeof(struct dmini_context)))
+        {
+            block_size = DMINI_ALIGN_UP(sizeof(struct dmini_context));
+        }
+
+        dmini_arena_block_t* block = arena_block_create(allocator, block_size);
+        if (!block)
+        {
+            return NULL;
+        }
+        return context_in_block(block, block_size, allocator, owner_token);
+    }
+
+    dmini_context_t ctx = (dmini_context_t)allocator->malloc_fn(sizeof(struct dmini_context), allocator->user);
+    if (!ctx)
+    {
+        return NULL;
+    }
+
+    ctx->allocator = *allocator;
+    ctx->arena = NULL;
+    ctx->arena_block_size = 0;
+    ctx->memory_used = DMINI_ARENA_HEADER_SIZE + DMINI_ALIGN_UP(sizeof(struct dmini_context));
+
+    if (context_init(ctx, owner_token) != DMINI_OK)
+    {
+        dmini_destroy(ctx);
+        return NULL;
+    }
+
+    return ctx;
+}
+
+dmini_context_t dmini_create_with_arena(void* buffer, size_t size)
+{
+    if (!buffer)
+    {
+        return dmini_create_ex(NULL, size ? size : DMINI_ARENA_BLOCK_SIZE, 0);
+    }
+
+    /* Caller memory: align the start and keep everything inside it */
+    size_t skew = (DMINI_ALIGNMENT - ((size_t)buffer & (DMINI_ALIGNMENT - 1))) & (DMINI_ALIGNMENT - 1);
+    if (size < skew + DMINI_ARENA_HEADER_SIZE + DMINI_ALIGN_UP(sizeof(struct dmini_context)))
+    {
+        return NULL;
+    }
+
+    dmini_arena_block_t* block = (dmini_arena_block_t*)((char*)buffer + skew);
+    block->next = NULL;
+    block->size = (size - skew - DMINI_ARENA_HEADER_SIZE) & ~(size_t)(DMINI_ALIGNMENT - 1);
+    block->used = 0;
+    return context_in_block(block, 0, &default_allocator, 0);
+}
+
+#if DMINI_USE_STATIC
+/* DMINI_STATIC_SIZE() must reserve enough for the real sizes */
+typedef char dmini_static_context_fits[(DMINI_ALIGNMENT + DMINI_ARENA_HEADER_SIZE +
+                                        DMINI_ALIGN_UP(sizeof(struct dmini_context)) +
+                                        DMINI_ALIGN_UP(sizeof(dmini_scratch_t)) +
+                                        (DMINI_STATIC_CLASSES + 1) * sizeof(void*) <= DMINI_STATIC_CONTEXT_BYTES) ? 1 : -1];
+typedef char dmini_static_section_fits[(DMINI_ALIGN_UP(sizeof(dmini_section_t)) <= DMINI_STATIC_SECTION_BYTES) ? 1 : -1];
+typedef char dmini_static_pair_fits[(DMINI_ALIGN_UP(sizeof(dmini_pair_t)) <= DMINI_STATIC_PAIR_BYTES) ? 1 : -1];
+
+/**
+ * @brief Push the nodes of an array onto a free list
+ */
+static void pool_fill(void** pool, char* nodes, size_t count, size_t size)
+{
+    while (count-- > 0)
+    {
+        void* node = nodes + count * size;
+        *(void**)node = *pool;
+        *pool = node;
+    }
+}
+#endif
+
+dmini_context_t dmini_create_static(dmini_static_t* storage)
+{
+#if DMINI_USE_STATIC
+    if (!storage || !storage->memory)
+    {
+        return NULL;
+    }
+
+    /* The context, the scratch area and the node pools are carved out first; the rest is the string pool */
+    size_t sections = (size_t)storage->max_sections + 1;
+    size_t section_size = DMINI_ALIGN_UP(sizeof(dmini_section_t));
+    size_t pair_size = DMINI_ALIGN_UP(sizeof(dmini_pair_t));
+    size_t skew = (DMINI_ALIGNMENT - ((size_t)storage->memory & (DMINI_ALIGNMENT - 1))) & (DMINI_ALIGNMENT - 1);
+    size_t fixed = skew + DMINI_ARENA_HEADER_SIZE + DMINI_ALIGN_UP(sizeof(struct dmini_context)) +
+                   DMINI_ALIGN_UP(sizeof(dmini_scratch_t)) + DMINI_ALIGN_UP(DMINI_STATIC_SCRATCH_BYTES) +
+                   (DMINI_STATIC_CLASSES + 1) * sizeof(void*) +
+                   sections * section_size + storage->max_pairs * pair_size;
+    if (storage->size < fixed)
+    {
+        return NULL;
+    }
+
+    dmini_arena_block_t* block = (dmini_arena_block_t*)((char*)storage->memory + skew);
+    block->next = NULL;
+    block->size = (storage->size - skew - DMINI_ARENA_HEADER_SIZE) & ~(size_t)(DMINI_ALIGNMENT - 1);
+    block->used = DMINI_ALIGN_UP(sizeof(struct dmini_context));
+
+    dmini_context_t ctx = (dmini_context_t)arena_data(block);
+    ctx->arena = block;
+    ctx->arena_block_size = 0;
+    ctx->memory_used = 0;
+    context_reset(ctx, 0);
+
+    /* Temporary buffers come from the scratch area instead of the heap */
+    dmini_scratch_t* scratch = (dmini_scratch_t*)arena_alloc(ctx, sizeof(dmini_scratch_t));
+    scratch->base = (char*)arena_alloc(ctx, DMINI_STATIC_SCRATCH_BYTES);
+    scratch->size = DMINI_STATIC_SCRATCH_BYTES;
+    scratch->used = 0;
+    scratch->top = 0;
+    scratch->live = 0;
+    ctx->allocator.malloc_fn = scratch_malloc;
+    ctx->allocator.free_fn = scratch_free;
+    ctx->allocator.realloc_fn = scratch_realloc;
+    ctx->allocator.user = scratch;
+    ctx->io_buffer_size = DMINI_STATIC_SCRATCH_BYTES / 4;
+
+    ctx->fixed = 1;
+    ctx->free_blocks = (void**)arena_alloc(ctx, (DMINI_STATIC_CLASSES + 1) * sizeof(void*));
+    memset(ctx->free_blocks, 0, (DMINI_STATIC_CLASSES + 1) * sizeof(void*));
+    pool_fill(&ctx->free_sections, (char*)arena_alloc(ctx, sections * section_size), sections, section_size);
+    pool_fill(&ctx->free_pairs, (char*)arena_alloc(ctx, storage->max_pairs * pair_size), storage->max_pairs, pair_size);
+
+    return context_add_global(ctx) == DMINI_OK ? ctx : NULL;
+#else
+    return NULL;
+#endif
+}
+
+void dmini_destroy(dmini_context_t ctx)
+{
+    if (!ctx)
+    {
+        return;
+    }
+
+    /* The hooks live in the memory they release */
+    dmini_allocator_t allocator = ctx->allocator;
+
+    if (ctx->image)
+    {
+        /* A snapshot is a single block */
+        allocator.free_fn(ctx, allocator.user);
+        return;
+    }
+
+#if DMINI_USE_CONCURRENCY
+    if (ctx->concurrent)
+    {
+        /* No readers may be active any more */
+        retire_reclaim(ctx, ctx->retired[0]);
+        retire_reclaim(ctx, ctx->retired[1]);
+        Dmod_Mutex_Delete(ctx->write_mutex);
+    }
+#endif
+
+    // Temporary buffers are not arena memory
+    stream_free(ctx);
+#if DMINI_USE_PRESERVE
+    source_free(ctx);
+#endif
+
+    if (ctx->arena)
+    {
+        /* Everything, including the context, lives in the arena */
+        dmini_arena_block_t* block = ctx->arena;
+        if (ctx->arena_block_size == 0)
+        {
+            return;
+        }
+        while (block)
+        {
+            dmini_arena_block_t* next = block->next;
+            allocator.free_fn(block, allocator.user);
+            block = next;
+        }
+        return;
+    }
+    
+    // Free all sections
+    dmini_section_t* section = ctx->sections;
+    while (section)
+    {
+        dmini_section_t* next = section->next;
+        free_section(ctx, section);
+        section = next;
+    }
+
+#if DMINI_USE_HASH_INDEX
+    if (ctx->section_index)
+    {
+        ctx_free(ctx, ctx->section_index, index_size(ctx->section_index->capacity));
+    }
+#endif
+
+#if DMINI_USE_INTERN
+    /* The pairs released every pooled string */
+    ctx_free(ctx, ctx->intern_buckets, ctx->intern_capacity * sizeof(dmini_intern_t*));
+#endif
+
+    ctx_free_string(ctx, ctx->active_section);
+    ctx_free_string(ctx, ctx->lazy_file);
+    while (ctx->watches)
+    {
+        dmini_watch_t* watch = ctx->watches;
+        ctx->watches = watch->next;
+        watch_free(ctx, watch);
+    }
+
+    allocator.free_fn(ctx, allocator.user);
+}
+
+int dmini_enable_concurrency(dmini_context_t ctx)
+{
+    if (!ctx)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+#if DMINI_USE_CONCURRENCY
+    // Retiring memory under readers needs allocations a static context cannot make
+    if (CTX_STATIC(ctx))
+    {
+        return DMINI_ERR_GENERAL;
+    }
+
+    if (!ctx->concurrent && !ctx->image)
+    {
+        // Lock-free readers cannot load sections on demand
+        int result = lazy_load_all(ctx);
+        if (result != DMINI_OK)
+        {
+            return result;
+        }
+
+        ctx->write_mutex = Dmod_Mutex_New(true);
+        if (!ctx->write_mutex)
+        {
+            return DMINI_ERR_MEMORY;
+        }
+        DMINI_PUBLISH(ctx->concurrent, 1);
+    }
+    return DMINI_OK;
+#else
+    return DMINI_ERR_GENERAL;
+#endif
+}
+
+unsigned int dmini_read_begin(dmini_context_t ctx)
+{
+#if DMINI_USE_CONCURRENCY
+    if (ctx && ctx->concurrent)
+    {
+        /*
+         * Register in the current epoch. If a writer advanced the epoch in
+         * the meantime, nothing has been read yet, so simply retry.
+         */
+        for (;;)
+        {
+            unsigned int epoch = DMINI_ATOMIC_LOAD(&ctx->epoch);
+            DMINI_ATOMIC_ADD(&ctx->readers[epoch & 1u], 1u);
+            if (DMINI_ATOMIC_LOAD(&ctx->epoch) == epoch)
+            {
+                return epoch;
+            }
+            DMINI_ATOMIC_SUB(&ctx->readers[epoch & 1u], 1u);
+        }
+    }
+#endif
+    return 0;
+}
+
+void dmini_read_end(dmini_context_t ctx, unsigned int token)
+{
+#if DMINI_USE_CONCURRENCY
+    if (ctx && ctx->concurrent)
+    {
+        DMINI_ATOMIC_SUB(&ctx->readers[token & 1u], 1u);
+    }
+#endif
+}
+
+/**
+ * @brief Allocate a snapshot context
+ *
+ * @param allocator  Allocator of the snapshot block
+ * @param image_size Bytes reserved for an image right after the context
+ *                   header (0 when the image lives elsewhere)
+ */
+static dmini_snapshot_t snapshot_alloc(const dmini_allocator_t* allocator, size_t image_size)
+{
+    size_t offset = DMINI_ALIGN_UP(sizeof(struct dmini_context));
+    dmini_snapshot_t snapshot = (dmini_snapshot_t)allocator->malloc_fn(offset + image_size, allocator->user);
+    if (!snapshot)
+    {
+        return NULL;
+    }
+
+    snapshot->allocator = *allocator;
+    snapshot->arena = NULL;
+    snapshot->arena_block_size = 0;
+    snapshot->memory_used = DMINI_ARENA_HEADER_SIZE + offset + DMINI_ALIGN_UP(image_size);
+    context_reset(snapshot, 0);
+    return snapshot;
+}
+
+/**
+ * @brief Attach an image to a snapshot context
+ */
+static void snapshot_attach(dmini_snapshot_t snapshot, const dmini_image_t* image)
+{
+    snapshot->image = image;
+    snapshot->section_count = image->section_count;
+}
+
+/**
+ * @brief dmini_freeze() body, called with the writer lock held
+ */
+static dmini_snapshot_t freeze_locked(dmini_context_t ctx)
+{
+    // A snapshot outlives the temporary buffers a static context could hold it in
+    if (CTX_STATIC(ctx) || lazy_load_all(ctx) != DMINI_OK)
+    {
+        return NULL;
+    }
+
+    dmini_image_t header;
+    size_t size = ctx->image ? ctx->image->size : image_measure(ctx, &header);
+    if (size == 0)
+    {
+        return NULL;
+    }
+
+    /* The context header and the image share one allocation */
+    dmini_snapshot_t snapshot = snapshot_alloc(&ctx->allocator, size);
+    if (!snapshot)
+    {
+        return NULL;
+    }
+
+    void* image = (char*)snapshot + DMINI_ALIGN_UP(sizeof(struct dmini_context));
+    if (ctx->image)
+    {
+        memcpy(image, ctx->image, size);
+    }
+    else
+    {
+        image_write(ctx, &header, image);
+    }
+
+    snapshot_attach(snapshot, (const dmini_image_t*)image);
+    return snapshot;
+}
+
+dmini_snapshot_t dmini_freeze(dmini_context_t ctx)
+{
+    if (!ctx)
+    {
+        return NULL;
+    }
+
+    writer_lock(ctx);
+    dmini_snapshot_t result = freeze_locked(ctx);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_export_binary() body, called with the writer lock held
+ */
+static int export_binary_locked(dmini_context_t ctx, void* buffer, size_t buffer_size)
+{
+    int loaded = lazy_load_all(ctx);
+    if (loaded != DMINI_OK)
+    {
+        return loaded;
+    }
+
+    dmini_image_t header;
+    size_t size = ctx->image ? ctx->image->size : image_measure(ctx, &header);
+    if (size == 0 || size > 0x7FFFFFFFu)
+    {
+        return DMINI_ERR_GENERAL;
+    }
+
+    if (!buffer)
+    {
+        return (int)size;
+    }
+    if (((uintptr_t)buffer & 3u) != 0)
+    {
+        return DMINI_ERR_INVALID;
+    }
+    if (buffer_size < size)
+    {
+        return DMINI_ERR_MEMORY;
+    }
+
+    if (ctx->image)
+    {
+        memcpy(buffer, ctx->image, size);
+    }
+    else
+    {
+        image_write(ctx, &header, buffer);
+    }
+    return (int)size;
+}
+
+int dmini_export_binary(dmini_context_t ctx, void* buffer, size_t buffer_size)
+{
+    if (!ctx)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    writer_lock(ctx);
+    int result = export_binary_locked(ctx, buffer, buffer_size);
+    writer_unlock(ctx);
+    return result;
+}
+
+dmini_snapshot_t dmini_open_binary(const void* data, size_t size)
+{
+    if (!data || !image_valid((const dmini_image_t*)data, size))
+    {
+        return NULL;
+    }
+
+    dmini_snapshot_t snapshot = snapshot_alloc(&default_allocator, 0);
+    if (!snapshot)
+    {
+        return NULL;
+    }
+
+    snapshot_attach(snapshot, (const dmini_image_t*)data);
+    return snapshot;
+}
+
+int dmini_set_io_buffer_size(dmini_context_t ctx, size_t size)
+{
+    if (!ctx)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+#if DMINI_USE_STATIC
+    // The scratch area also holds a line carry buffer and a second block while a record is checked
+    if (CTX_STATIC(ctx))
+    {
+        if (size > DMINI_STATIC_SCRATCH_BYTES / 4)
+        {
+            return DMINI_ERR_INVALID;
+        }
+        ctx->io_buffer_size = size ? size : DMINI_STATIC_SCRATCH_BYTES / 4;
+        return DMINI_OK;
+    }
+#endif
+
+    ctx->io_buffer_size = size ? size : DMINI_IO_BUFFER_SIZE;
+    return DMINI_OK;
+}
+
+/**
+ * @brief dmini_enable_interning() body, called with the writer lock held
+ */
+static int enable_interning_locked(dmini_context_t ctx)
+{
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
+    if (!ctx)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+#if DMINI_USE_INTERN
+    if (ctx->intern_buckets)
+    {
+        return DMINI_OK;
+    }
+
+    dmini_intern_t** buckets = (dmini_intern_t**)ctx_alloc(ctx, DMINI_INTERN_BUCKETS * sizeof(dmini_intern_t*));
+    if (!buckets)
+    {
+        return DMINI_ERR_MEMORY;
+    }
+    memset(buckets, 0, DMINI_INTERN_BUCKETS * sizeof(dmini_intern_t*));
+    ctx->intern_capacity = DMINI_INTERN_BUCKETS;
+    ctx->intern_count = 0;
+    ctx->intern_buckets = buckets;
+    return DMINI_OK;
+#else
+    return DMINI_ERR_GENERAL;
+#endif
+}
+
+int dmini_enable_interning(dmini_context_t ctx)
+{
+    writer_lock(ctx);
+    int result = enable_interning_locked(ctx);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_enable_format_preserving() body, called with the writer lock held
+ */
+static int enable_format_preserving_locked(dmini_context_t ctx)
+{
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
+    if (!ctx || ctx->stream)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+#if DMINI_USE_PRESERVE
+    // The kept document and its line table do not fit the scratch area of a static context
+    if (CTX_STATIC(ctx))
+    {
+        return DMINI_ERR_GENERAL;
+    }
+
+    if (ctx->source)
+    {
+        return DMINI_OK;
+    }
+
+    // The kept document replaces the lazy file, so what is pending is read now
+    int result = lazy_load_all(ctx);
+    if (result != DMINI_OK)
+    {
+        return result;
+    }
+
+    dmini_source_t* source = (dmini_source_t*)ctx_alloc_temp(ctx, sizeof(dmini_source_t));
+    if (!source)
+    {
+        return DMINI_ERR_MEMORY;
+    }
+    memset(source, 0, sizeof(dmini_source_t));
+    source->state = DMINI_SOURCE_EMPTY;
+    ctx->source = source;
+    return DMINI_OK;
+#else
+    return DMINI_ERR_GENERAL;
+#endif
+}
+
+int dmini_enable_format_preserving(dmini_context_t ctx)
+{
+    writer_lock(ctx);
+    int result = enable_format_preserving_locked(ctx);
+    writer_unlock(ctx);
+    return result;
+}
+
+size_t dmini_memory_usage(dmini_context_t ctx)
+{
+    if (!ctx)
+    {
+        return 0;
+    }
+
+    if (!ctx->arena)
+    {
+        return ctx->memory_used;
+    }
+
+    size_t used = 0;
+    for (dmini_arena_block_t* block = ctx->arena; block; block = block->next)
+    {
+        used += DMINI_ARENA_HEADER_SIZE + block->used;
+    }
+    return used;
+}
+
+int dmini_get_stats(dmini_context_t ctx, dmini_stats_t* stats)
+{
+    if (!ctx || !stats)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+#if DMINI_USE_STATS
+    stats->section_lookups = DMINI_STAT_GET(ctx, DMINI_STAT_SECTION_LOOKUPS);
+    stats->section_misses = DMINI_STAT_GET(ctx, DMINI_STAT_SECTION_MISSES);
+    stats->pair_lookups = DMINI_STAT_GET(ctx, DMINI_STAT_PAIR_LOOKUPS);
+    stats->pair_misses = DMINI_STAT_GET(ctx, DMINI_STAT_PAIR_MISSES);
+    stats->nodes_visited = DMINI_STAT_GET(ctx, DMINI_STAT_NODES_VISITED);
+    stats->allocations = DMINI_STAT_GET(ctx, DMINI_STAT_ALLOCATIONS);
+    stats->parse_calls = DMINI_STAT_GET(ctx, DMINI_STAT_PARSE_CALLS);
+    stats->parse_lines = DMINI_STAT_GET(ctx, DMINI_STAT_PARSE_LINES);
+    stats->parse_time_ms = DMINI_STAT_GET(ctx, DMINI_STAT_PARSE_TIME);
+    stats->generate_bytes = DMINI_STAT_GET(ctx, DMINI_STAT_GENERATE_BYTES);
+    stats->active_rejections = DMINI_STAT_GET(ctx, DMINI_STAT_REJECTIONS);
+
+    writer_lock(ctx);
+    stats->bytes_held = dmini_memory_usage(ctx);
+    writer_unlock(ctx);
+    return DMINI_OK;
+#else
+    return DMINI_ERR_GENERAL;
+#endif
+}
+
+int dmini_reset_stats(dmini_context_t ctx)
+{
+    if (!ctx)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+#if DMINI_USE_STATS
+    for (int i = 0; i < DMINI_STAT_COUNT; i++)
+    {
+        DMINI_STAT_SET(ctx, i, 0);
+    }
+    return DMINI_OK;
+#else
+    return DMINI_ERR_GENERAL;
+#endif
+}
+
+/**
+ * @brief dmini_parse_string() body, called with the writer lock held
+ */
+static int parse_string_locked(dmini_context_t ctx, const char* data)
+{
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
+    if (!ctx || !data)
+    {
+        return DMINI_ERR_INVALID;
+    }
+    
+    dmini_parser_t parser;
+    parser_init(&parser, ctx);
+    return parse_document(&parser, data, strlen(data));
+}
+
+int dmini_parse_string(dmini_context_t ctx, const char* data)
+{
+    writer_lock(ctx);
+    unsigned int started = stats_clock();
+    int result = parse_string_locked(ctx, data);
+    stats_parsed(ctx, started);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_parse_memory() body, called with the writer lock held
+ */
+static int parse_memory_locked(dmini_context_t ctx, const char* data, size_t len)
+{
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
+    if (!ctx || (!data && len > 0))
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    /* The range is only read, so it may live in read-only or mapped memory */
+    dmini_parser_t parser;
+    parser_init(&parser, ctx);
+    return parse_document(&parser, data, len);
+}
+
+int dmini_parse_memory(dmini_context_t ctx, const char* data, size_t len)
+{
+    writer_lock(ctx);
+    unsigned int started = stats_clock();
+    int result = parse_memory_locked(ctx, data, len);
+    stats_parsed(ctx, started);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_parse_buffer_inplace() body, called with the writer lock held
+ */
+static int parse_buffer_inplace_locked(dmini_context_t ctx, char* buffer, size_t len)
+{
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
+    if (!ctx || (!buffer && len > 0))
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    dmini_parser_t parser;
+    parser_init(&parser, ctx);
+    parser.inplace_end = buffer + len;
+    return parse_document(&parser, buffer, len);
+}
+
+int dmini_parse_buffer_inplace(dmini_context_t ctx, char* buffer, size_t len)
+{
+    writer_lock(ctx);
+    unsigned int started = stats_clock();
+    int result = parse_buffer_inplace_locked(ctx, buffer, len);
+    stats_parsed(ctx, started);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_parse_begin() body, called with the writer lock held
+ */
+static int parse_begin_locked(dmini_context_t ctx)
+{
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
+    if (!ctx || ctx->stream)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    dmini_stream_t* stream = (dmini_stream_t*)ctx_alloc_temp(ctx, sizeof(dmini_stream_t));
+    if (!stream)
+    {
+        return DMINI_ERR_MEMORY;
+    }
+
+    stream_init(stream, ctx);
+#if DMINI_USE_PRESERVE
+    source_claim(&stream->parser);
+#endif
+    ctx->stream = stream;
+    return DMINI_OK;
+}
+
+int dmini_parse_begin(dmini_context_t ctx)
+{
+    writer_lock(ctx);
+    int result = parse_begin_locked(ctx);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_parse_feed() body, called with the writer lock held
+ */
+static int parse_feed_locked(dmini_context_t ctx, const char* chunk, size_t len)
+{
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
+    if (!ctx || !ctx->stream || (!chunk && len > 0))
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    dmini_stream_t* stream = ctx->stream;
+    if (stream->error == DMINI_OK)
+    {
+        stream->error = stream_feed(ctx, stream, chunk, len);
+    }
+    return stream->error;
+}
+
+int dmini_parse_feed(dmini_context_t ctx, const char* chunk, size_t len)
+{
+    writer_lock(ctx);
+    unsigned int started = stats_clock();
+    int result = parse_feed_locked(ctx, chunk, len);
+    stats_parsed(ctx, started);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_parse_end() body, called with the writer lock held
+ */
+static int parse_end_locked(dmini_context_t ctx)
+{
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
+    if (!ctx || !ctx->stream)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    dmini_stream_t* stream = ctx->stream;
+    int result = stream_finish(ctx, stream, stream->error);
+
+    ctx_free_temp(ctx, stream, sizeof(dmini_stream_t));
+    ctx->stream = NULL;
+    return result;
+}
+
+int dmini_parse_end(dmini_context_t ctx)
+{
+    writer_lock(ctx);
+    unsigned int started = stats_clock();
+    int result = parse_end_locked(ctx);
+    stats_parsed(ctx, started);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief Parse up to @p limit bytes of an open file from its current position
+ *
+ * The file is read in large blocks and lines are split from the block itself.
+ * Records appended by dmini_save_changes() are found by their offset, so a
+ * file whose records are checked is parsed from its start.
+ *
+ * @param filtered 1 to keep only the pairs of @p section
+ * @param section  Section to keep (NULL = global section)
+ * @param journal  Name of the file, to check its appended records (NULL = not checked)
+ * @param torn     Set to 1 when a torn record ended the document (may be NULL)
+ */
+static int parse_open_file(dmini_context_t ctx, void* file, size_t limit, int filtered, const char* section,
+                           const char* journal, int* torn)
+{
+    size_t block_size = ctx->io_buffer_size;
+    char* block = (char*)ctx_alloc_temp(ctx, block_size);
+    if (!block)
+    {
+        return DMINI_ERR_MEMORY;
+    }
+
+    dmini_stream_t stream;
+    stream_init(&stream, ctx);
+    if (filtered)
+    {
+        parser_filter(&stream.parser, section);
+    }
+    stream.parser.journal = journal;
+#if DMINI_USE_PRESERVE
+    source_claim(&stream.parser);
+#endif
+
+    int result = DMINI_OK;
+    size_t read;
+    while (result == DMINI_OK && !stream.finished && limit > 0 &&
+           (read = Dmod_FileRead(block, 1, limit < block_size ? limit : block_size, file)) > 0)
+    {
+        limit -= read;
+        result = stream_feed(ctx, &stream, block, read);
+    }
+    result = stream_finish(ctx, &stream, result);
+    if (torn)
+    {
+        *torn = stream.parser.torn;
+    }
+
+    ctx_free_temp(ctx, block, block_size);
+    return result;
+}
+
+/**
+ * @brief dmini_parse_file() / dmini_parse_file_section() body, called with
+ *        the writer lock held
+ *
+ * @param filtered 1 to keep only the pairs of @p section
+ * @param section  Section to keep (NULL = global section)
+ */
+static int parse_file_locked(dmini_context_t ctx, const char* filename, int filtered, const char* section)
+{
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
+    if (!ctx || !filename)
+    {
+        return DMINI_ERR_INVALID;
+    }
+    
+    // Open file using SAL
+    void* file = Dmod_FileOpen(filename, "r");
+    if (!file)
+    {
+        return DMINI_ERR_FILE;
+    }
+
+    // The file becomes the sync baseline when all of it is loaded into an empty context
+    int baseline = !filtered && ctx->section_count == 1 && ctx->content_size == 0 && !ctx->active_section_locked;
+
+    int torn = 0;
+    int result = parse_open_file(ctx, file, (size_t)-1, filtered, section, filename, &torn);
+    Dmod_FileClose(file);
+    if (result == DMINI_OK && baseline)
+    {
+        mark_synced(ctx, filename);
+    }
+
+    // Records appended after the remains of a torn one would be dropped with it
+    if (torn)
+    {
+        ctx->sync_rewrite = 1;
+    }
+    return result;
+}
+
+int dmini_parse_file(dmini_context_t ctx, const char* filename)
+{
+    writer_lock(ctx);
+    unsigned int started = stats_clock();
+    int result = parse_file_locked(ctx, filename, 0, NULL);
+    stats_parsed(ctx, started);
+    writer_unlock(ctx);
+    return result;
+}
+
+int dmini_parse_file_section(dmini_context_t ctx, const char* filename, const char* section)
+{
+    writer_lock(ctx);
+    unsigned int started = stats_clock();
+    int result = parse_file_locked(ctx, filename, 1, section);
+    stats_parsed(ctx, started);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_open_lazy() body, called with the writer lock held
+ */
+static int open_lazy_locked(dmini_context_t ctx, const char* filename)
+{
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
+    if (!ctx || !filename)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    // Lock-free readers cannot load sections, and a kept document must be read whole,
+    // so these contexts parse everything now
+    if (CTX_CONCURRENT(ctx) || CTX_PRESERVING(ctx))
+    {
+        return parse_file_locked(ctx, filename, 0, NULL);
+    }
+
+    // Ranges of only one file can be pending
+    int result = lazy_load_all(ctx);
+    if (result != DMINI_OK)
+    {
+        return result;
+    }
+
+    void* file = Dmod_FileOpen(filename, "r");
+    if (!file)
+    {
+        return DMINI_ERR_FILE;
+    }
+
+    size_t block_size = ctx->io_buffer_size;
+    char* block = (char*)ctx_alloc_temp(ctx, block_size);
+    ctx->lazy_file = ctx_strdup(ctx, filename);
+    if (!block || !ctx->lazy_file)
+    {
+        ctx_free_temp(ctx, block, block_size);
+        ctx_free_string(ctx, ctx->lazy_file);
+        ctx->lazy_file = NULL;
+        Dmod_FileClose(file);
+        return DMINI_ERR_MEMORY;
+    }
+
+    int baseline = ctx->section_count == 1 && ctx->content_size == 0 && !ctx->active_section_locked;
+
+    // Create the sections and remember where their pairs are, without parsing them
+    dmini_lazy_scan_t scan;
+    stream_init(&scan.stream, ctx);
+    scan.range_start = 0;
+    scan.line_start = 0;
+    scan.end = 0;
+    scan.content = 0;
+    scan.state = DMINI_SCAN_LINE_START;
+    scan.stream.parser.journal = filename;
+    ctx->lazy_busy = 1;
+
+    size_t read;
+    while (result == DMINI_OK && !scan.stream.finished &&
+           (read = Dmod_FileRead(block, 1, block_size, file)) > 0)
+    {
+        result = lazy_scan_feed(ctx, &scan, block, read, scan.end);
+        if (!scan.stream.finished)
+        {
+            scan.end += read;
+        }
+    }
+    result = lazy_scan_finish(ctx, &scan, result);
+
+    ctx->lazy_busy = 0;
+    ctx_free_temp(ctx, block, block_size);
+    Dmod_FileClose(file);
+
+    if (ctx->lazy_size == 0)
+    {
+        ctx_free_string(ctx, ctx->lazy_file);
+        ctx->lazy_file = NULL;
+    }
+
+    // Pairs loaded later are not tracked as changes, so only an empty context stays synced
+    if (result == DMINI_OK && baseline)
+    {
+        mark_synced(ctx, filename);
+        ctx->sync_rewrite = scan.stream.parser.torn;
+    }
+    else
+    {
+        ctx->synced = 0;
+    }
+    return result;
+}
+
+int dmini_open_lazy(dmini_context_t ctx, const char* filename)
+{
+    writer_lock(ctx);
+    unsigned int started = stats_clock();
+    int result = open_lazy_locked(ctx, filename);
+    stats_parsed(ctx, started);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_generate_string() body, called with the writer lock held
+ */
+static int generate_string_locked(dmini_context_t ctx, char* buffer, size_t buffer_size)
+{
+    if (!ctx)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    // The text of a lazily opened file is only known once it is parsed
+    int loaded = lazy_load_all(ctx);
+    if (loaded != DMINI_OK)
+    {
+        return loaded;
+    }
+    
+    // Required buffer size is kept up to date by every modification
+    size_t required_size = ctx->image ? ctx->image->text_size : serialized_size(ctx);
+#if DMINI_USE_PRESERVE
+    if (source_kept(ctx))
+    {
+        required_size = source_size(ctx);
+    }
+#endif
+    
+    // If buffer is NULL, just return the required size
+    if (!buffer)
+    {
+        return (int)required_size;
+    }
+    
+    // Check if buffer is large enough
+    if (buffer_size < required_size)
+    {
+        return DMINI_ERR_MEMORY;
+    }
+    
+    // Generate INI string
+    dmini_writer_t writer;
+    writer.buffer = buffer;
+    writer.size = buffer_size;
+    writer.pos = 0;
+    writer.file = NULL;
+    writer.flushed = 0;
+    writer.crc = NULL;
+    writer.error = DMINI_OK;
+
+    int result;
+#if DMINI_USE_PRESERVE
+    if (source_kept(ctx))
+    {
+        result = emit_source(ctx, &writer);
+    }
+    else
+#endif
+    result = ctx->image ? image_emit(ctx->image, &writer) : emit_context(ctx, &writer);
+    if (result != DMINI_OK)
+    {
+        return result;
+    }
+    buffer[writer.pos] = '\0';
+    DMINI_STAT_ADD(ctx, DMINI_STAT_GENERATE_BYTES, writer.pos);
+    
+    return (int)required_size;
+}
+
+int dmini_generate_string(dmini_context_t ctx, char* buffer, size_t buffer_size)
+{
+    writer_lock(ctx);
+    int result = generate_string_locked(ctx, buffer, buffer_size);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief Write the whole content to an open file
+ *
+ * Output is batched in one buffer and written out only when it is full.
+ *
+ * @param crc In/out CRC-32 extended over the written bytes (NULL = none)
+ */
+static int generate_open_file(dmini_context_t ctx, void* file, uint32_t* crc)
+{
+    dmini_writer_t writer;
+    writer.size = ctx->io_buffer_size;
+    writer.buffer = (char*)ctx_alloc_temp(ctx, writer.size);
+    writer.pos = 0;
+    writer.file = file;
+    writer.flushed = 0;
+    writer.crc = crc;
+    writer.error = DMINI_OK;
+    if (!writer.buffer)
+    {
+        return DMINI_ERR_MEMORY;
+    }
+
+    if (ctx->image)
+    {
+        image_emit(ctx->image, &writer);
+    }
+#if DMINI_USE_PRESERVE
+    else if (source_kept(ctx))
+    {
+        emit_source(ctx, &writer);
+    }
+#endif
+    else
+    {
+        emit_context(ctx, &writer);
+    }
+    writer_flush(&writer);
+    DMINI_STAT_ADD(ctx, DMINI_STAT_GENERATE_BYTES, writer.flushed);
+
+    ctx_free_temp(ctx, writer.buffer, writer.size);
+    return writer.error;
+}
+
+/**
+ * @brief dmini_generate_file() body, called with the writer lock held
+ */
+static int generate_file_locked(dmini_context_t ctx, const char* filename)
+{
+    if (!ctx || !filename)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    // Load everything first, the file may be the one the sections are read from
+    int loaded = lazy_load_all(ctx);
+    if (loaded != DMINI_OK)
+    {
+        return loaded;
+    }
+    
+    // Open file for writing
+    void* file = Dmod_FileOpen(filename, "w");
+    if (!file)
+    {
+        return DMINI_ERR_FILE;
+    }
+
+    int result = generate_open_file(ctx, file, NULL);
+    Dmod_FileClose(file);
+
+    /* A restricted context wrote only part of its content */
+    if (!ctx->image && result != DMINI_ERR_MEMORY)
+    {
+        if (result == DMINI_OK && !ctx->active_section_locked)
+        {
+            mark_synced(ctx, filename);
+        }
+        else
+        {
+            ctx->synced = 0;
+        }
+    }
+    return result;
+}
+
+int dmini_generate_file(dmini_context_t ctx, const char* filename)
+{
+    writer_lock(ctx);
+    int result = generate_file_locked(ctx, filename);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_save_changes() body, called with the writer lock held
+ */
+static int save_changes_locked(dmini_context_t ctx, const char* filename)
+{
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
+    if (!ctx || !filename)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    /* Fall back to a full rewrite whenever appending cannot express the change */
+    if (!ctx->synced || ctx->sync_rewrite || ctx->active_section_locked ||
+        ctx->sync_file != hash_string(filename) || CTX_PRESERVING(ctx))
+    {
+        return generate_file_locked(ctx, filename);
+    }
+    if (ctx->dirty_sections == 0)
+    {
+        return DMINI_OK;
+    }
+
+    /* Compact once the appended changes outgrow the content itself */
+    size_t size = changes_size(ctx);
+    if (ctx->journal_size + size > ctx->content_size + ctx->lazy_size)
+    {
+        return generate_file_locked(ctx, filename);
+    }
+
+    /* The record follows a line announcing its length and CRC, so it is checksummed first */
+    uint32_t crc = 0;
+    dmini_writer_t writer;
+    writer.size = size + DMINI_JOURNAL_LINE_SIZE + 2;
+    writer.size = writer.size < ctx->io_buffer_size ? writer.size : ctx->io_buffer_size;
+    writer.buffer = (char*)ctx_alloc_temp(ctx, writer.size);
+    writer.pos = 0;
+    writer.file = NULL;
+    writer.flushed = 0;
+    writer.crc = &crc;
+    writer.error = DMINI_OK;
+    if (!writer.buffer)
+    {
+        return DMINI_ERR_MEMORY;
+    }
+    emit_changes(ctx, &writer);
+    writer_flush(&writer);
+
+    void* file = Dmod_FileOpen(filename, "a");
+    if (!file)
+    {
+        ctx_free_temp(ctx, writer.buffer, writer.size);
+        return DMINI_ERR_FILE;
+    }
+
+    char header[DMINI_JOURNAL_LINE_SIZE + 2];
+    header[0] = '\n';
+    memcpy(header + 1, DMINI_JOURNAL_TAG, DMINI_JOURNAL_TAG_SIZE);
+    hex_put(header + 1 + DMINI_JOURNAL_TAG_SIZE, (uint32_t)size);
+    header[1 + DMINI_JOURNAL_TAG_SIZE + 8] = ' ';
+    hex_put(header + 1 + DMINI_JOURNAL_TAG_SIZE + 9, crc);
+    header[DMINI_JOURNAL_LINE_SIZE + 1] = '\n';
+
+    writer.file = file;
+    writer.flushed = 0;
+    writer.crc = NULL;
+    writer_put(&writer, header, sizeof(header));
+    emit_changes(ctx, &writer);
+    writer_flush(&writer);
+    DMINI_STAT_ADD(ctx, DMINI_STAT_GENERATE_BYTES, writer.flushed);
+
+    ctx_free_temp(ctx, writer.buffer, writer.size);
+    Dmod_FileClose(file);
+
+    if (writer.error != DMINI_OK)
+    {
+        /* The file may end with a partial record; rewrite it next time */
+        ctx->sync_rewrite = 1;
+        return writer.error;
+    }
+    clear_changes(ctx);
+    ctx->journal_size += sizeof(header) + size;
+    return DMINI_OK;
+}
+
+int dmini_save_changes(dmini_context_t ctx, const char* filename)
+{
+    writer_lock(ctx);
+    int result = save_changes_locked(ctx, filename);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_save_atomic() body, called with the writer lock held
+ */
+static int save_atomic_locked(dmini_context_t ctx, const char* filename)
+{
+    if (!ctx || !filename)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    int loaded = lazy_load_all(ctx);
+    if (loaded != DMINI_OK)
+    {
+        return loaded;
+    }
+
+    // The slots are only searched when this context did not save or load them last
+    unsigned int name_hash = hash_string(filename);
+    int current = ctx->slot_current;
+    uint32_t sequence = ctx->slot_sequence;
+    if (current < 0 || ctx->slot_file != name_hash)
+    {
+        dmini_slot_t slots[2];
+        current = slot_newest(ctx, filename, slots);
+        sequence = current < 0 ? 0 : slots[current].sequence;
+    }
+
+    // Never touch the slot holding the newest valid content
+    int target = current < 0 ? 0 : 1 - current;
+    void* file = slot_open(ctx, filename, target, "w");
+    if (!file)
+    {
+        return DMINI_ERR_FILE;
+    }
+
+    uint32_t crc = 0;
+    int result = generate_open_file(ctx, file, &crc);
+    if (result == DMINI_OK)
+    {
+        char trailer[DMINI_SLOT_TRAILER_SIZE];
+        memcpy(trailer, DMINI_SLOT_TAG, DMINI_SLOT_TAG_SIZE);
+        hex_put(trailer + DMINI_SLOT_TAG_SIZE, sequence + 1);
+        trailer[DMINI_SLOT_TAG_SIZE + 8] = ' ';
+        hex_put(trailer + DMINI_SLOT_TAG_SIZE + 9, crc);
+        trailer[DMINI_SLOT_TRAILER_SIZE - 1] = '\n';
+        if (Dmod_FileWrite(trailer, 1, sizeof(trailer), file) != sizeof(trailer))
+        {
+            result = DMINI_ERR_FILE;
+        }
+    }
+    Dmod_FileClose(file);
+
+    // A snapshot is read-only, it finds the slots again next time
+    if (result == DMINI_OK && !ctx->image)
+    {
+        ctx->slot_file = name_hash;
+        ctx->slot_current = target;
+        ctx->slot_sequence = sequence + 1;
+    }
+    return result;
+}
+
+int dmini_save_atomic(dmini_context_t ctx, const char* filename)
+{
+    writer_lock(ctx);
+    int result = save_atomic_locked(ctx, filename);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_load_atomic() body, called with the writer lock held
+ */
+static int load_atomic_locked(dmini_context_t ctx, const char* filename)
+{
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
+    if (!ctx || !filename)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    dmini_slot_t slots[2];
+    int slot = slot_newest(ctx, filename, slots);
+    if (slot < 0)
+    {
+        return DMINI_ERR_FILE;
+    }
+
+    void* file = slot_open(ctx, filename, slot, "r");
+    if (!file)
+    {
+        return DMINI_ERR_FILE;
+    }
+    int result = parse_open_file(ctx, file, slots[slot].length, 0, NULL, NULL, NULL);
+    Dmod_FileClose(file);
+
+    if (result == DMINI_OK)
+    {
+        ctx->slot_file = hash_string(filename);
+        ctx->slot_current = slot;
+        ctx->slot_sequence = slots[slot].sequence;
+    }
+    return result;
+}
+
+int dmini_load_atomic(dmini_context_t ctx, const char* filename)
+{
+    writer_lock(ctx);
+    unsigned int started = stats_clock();
+    int result = load_atomic_locked(ctx, filename);
+    stats_parsed(ctx, started);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_watch() body, called with the writer lock held
+ */
+static int watch_locked(dmini_context_t ctx, const char* section, const char* key,
+                        dmini_watch_callback_t callback, void* user)
+{
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
+    if (!ctx || !callback)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    dmini_watch_t* watch = (dmini_watch_t*)ctx_alloc(ctx, sizeof(dmini_watch_t));
+    if (!watch)
+    {
+        return DMINI_ERR_MEMORY;
+    }
+    watch->section = section ? ctx_strdup(ctx, section) : NULL;
+    watch->key = key ? ctx_strdup(ctx, key) : NULL;
+    watch->callback = callback;
+    watch->user = user;
+    if ((section && !watch->section) || (key && !watch->key))
+    {
+        watch_free(ctx, watch);
+        return DMINI_ERR_MEMORY;
+    }
+
+    // Added at the head, so a notification in progress does not reach it
+    watch->next = ctx->watches;
+    ctx->watches = watch;
+    return DMINI_OK;
+}
+
+int dmini_watch(dmini_context_t ctx, const char* section, const char* key,
+                dmini_watch_callback_t callback, void* user)
+{
+    writer_lock(ctx);
+    int result = watch_locked(ctx, section, key, callback, user);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_unwatch() body, called with the writer lock held
+ */
+static int unwatch_locked(dmini_context_t ctx, const char* section, const char* key,
+                          dmini_watch_callback_t callback, void* user)
+{
+    if (!ctx || !callback)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    for (dmini_watch_t** link = &ctx->watches; *link; link = &(*link)->next)
+    {
+        dmini_watch_t* watch = *link;
+        if (watch->callback == callback && watch->user == user &&
+            section_names_equal(watch->section, section) && section_names_equal(watch->key, key))
+        {
+            if (ctx->notifying)
+            {
+                // The list is being walked; free the watch once the notification ends
+                watch->callback = NULL;
+                ctx->watch_removed = 1;
+            }
+            else
+            {
+                *link = watch->next;
+                watch_free(ctx, watch);
+            }
+            return DMINI_OK;
+        }
+    }
+
+    return DMINI_ERR_NOT_FOUND;
+}
+
+int dmini_unwatch(dmini_context_t ctx, const char* section, const char* key,
+                  dmini_watch_callback_t callback, void* user)
+{
+    writer_lock(ctx);
+    int result = unwatch_locked(ctx, section, key, callback, user);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief Find a pair by section and key name
+ */
+static dmini_pair_t* lookup_pair(dmini_context_t ctx, const char* section, const char* key)
+{
+    if (!ctx || !key)
+    {
+        return NULL;
+    }
+    
+    dmini_section_t* sec = find_section(ctx, section);
+    if (!sec)
+    {
+        return NULL;
+    }
+    
+    return find_pair(ctx, sec, key);
+}
+
+/**
+ * @brief dmini_get_string() body, called inside a read-side section
+ */
+static const char* get_string_guarded(dmini_context_t ctx, const char* section, const char* key, const char* default_value)
+{
+    if (ctx_frozen(ctx))
+    {
+        const char* value = key ? frozen_value(ctx, section, key) : NULL;
+        return value ? value : default_value;
+    }
+
+    dmini_pair_t* pair = lookup_pair(ctx, section, key);
+    return pair ? DMINI_LOAD(pair->value) : default_value;
+}
+
+const char* dmini_get_string(dmini_context_t ctx, const char* section, const char* key, const char* default_value)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    const char* result = get_string_guarded(ctx, section, key, default_value);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+/**
+ * @brief Convert a value string to a 64-bit integer
+ *
+ * Accepts leading blanks, an optional sign and either decimal digits or
+ * hex digits after a 0x / 0X prefix. Conversion stops at the first
+ * character that is not a digit.
+ */
+static int64_t parse_int64(const char* value)
+{
+    uint64_t result = 0;
+    int negative = 0;
+    const char* p = value;
+    
+    // Skip whitespace
+    while (*p == ' ' || *p == '\t')
+    {
+        p++;
+    }
+    
+    // Check for sign
+    if (*p == '-')
+    {
+        negative = 1;
+        p++;
+    }
+    else if (*p == '+')
+    {
+        p++;
+    }
+    
+    if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+    {
+        // Convert hex digits
+        for (p += 2; ; p++)
+        {
+            unsigned int digit;
+            if (*p >= '0' && *p <= '9')
+            {
+                digit = (unsigned int)(*p - '0');
+            }
+            else if (*p >= 'a' && *p <= 'f')
+            {
+                digit = (unsigned int)(*p - 'a') + 10;
+            }
+            else if (*p >= 'A' && *p <= 'F')
+            {
+                digit = (unsigned int)(*p - 'A') + 10;
+            }
+            else
+            {
+                break;
+            }
+            result = (result << 4) | digit;
+        }
+    }
+    else
+    {
+        // Convert decimal digits
+        while (*p >= '0' && *p <= '9')
+        {
+            result = result * 10 + (uint64_t)(*p - '0');
+            p++;
+        }
+    }
+    
+    return negative ? (int64_t)(0 - result) : (int64_t)result;
+}
+
+/**
+ * @brief Convert a value string to a float
+ *
+ * Accepts leading blanks, an optional sign, decimal digits with an optional
+ * fraction and exponent (1.5, -.25, 6e-3), or a 0x / 0X hex integer.
+ */
+static float parse_float(const char* value)
+{
+    /* Digits beyond this do not change a float and would overflow the mantissa */
+    const uint64_t mantissa_limit = 100000000000000000ull;
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int negative = 0;
+    const char* p = value;
+    
+    while (*p == ' ' || *p == '\t')
+    {
+        p++;
+    }
+    if (*p == '-')
+    {
+        negative = 1;
+        p++;
+    }
+    else if (*p == '+')
+    {
+        p++;
+    }
+    if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+    {
+        return (float)parse_int64(value);
+    }
+    
+    // Integer part
+    for (; *p >= '0' && *p <= '9'; p++)
+    {
+        if (mantissa < mantissa_limit)
+        {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+        }
+        else
+        {
+            exponent++;
+        }
+    }
+    
+    // Fraction
+    if (*p == '.')
+    {
+        for (p++; *p >= '0' && *p <= '9'; p++)
+        {
+            if (mantissa < mantissa_limit)
+            {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                exponent--;
+            }
+        }
+    }
+    
+    // Exponent (ignored unless followed by digits)
+    if (*p == 'e' || *p == 'E')
+    {
+        const char* e = p + 1;
+        int exp_negative = 0;
+        int exp_value = 0;
+        if (*e == '-' || *e == '+')
+        {
+            exp_negative = (*e == '-');
+            e++;
+        }
+        for (; *e >= '0' && *e <= '9'; e++)
+        {
+            if (exp_value < 1000)
+            {
+                exp_value = exp_value * 10 + (*e - '0');
+            }
+        }
+        exponent += exp_negative ? -exp_value : exp_value;
+    }
+    
+    // Scale by 10^|exponent| using square-and-multiply
+    double result = (double)mantissa;
+    double scale = 1.0;
+    double base = 10.0;
+    unsigned int n = (unsigned int)(exponent < 0 ? -exponent : exponent);
+    if (n > 400)
+    {
+        n = 400;
+    }
+    for (; n; n >>= 1)
+    {
+        if (n & 1u)
+        {
+            scale *= base;
+        }
+        base *= base;
+    }
+    result = exponent < 0 ? result / scale : result * scale;
+    
+    return (float)(negative ? -result : result);
+}
+
+/**
+ * @brief Compare a string with a lowercase word ignoring case
+ */
+static int equals_nocase(const char* str, const char* word)
+{
+    for (; *word; str++, word++)
+    {
+        char c = *str;
+        if (c >= 'A' && c <= 'Z')
+        {
+            c = (char)(c - 'A' + 'a');
+        }
+        if (c != *word)
+        {
+            return 0;
+        }
+    }
+    return *str == '\0';
+}
+
+/**
+ * @brief Convert a value string to a boolean
+ *
+ * @return 1 for 1/true/yes/on, 0 for 0/false/no/off (any case), -1 otherwise
+ */
+static int parse_bool(const char* value)
+{
+    static const char* const true_words[] = { "1", "true", "yes", "on" };
+    static const char* const false_words[] = { "0", "false", "no", "off" };
+    
+    for (size_t i = 0; i < sizeof(true_words) / sizeof(true_words[0]); i++)
+    {
+        if (equals_nocase(value, true_words[i]))
+        {
+            return 1;
+        }
+        if (equals_nocase(value, false_words[i]))
+        {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Get the value of a pair as an integer, converting it at most once
+ *
+ * The cache is not used in concurrent mode, where readers must not write to
+ * shared nodes.
+ */
+static int64_t pair_int64(dmini_context_t ctx, dmini_pair_t* pair)
+{
+#if DMINI_CACHE_VALUES
+    if (CTX_CONCURRENT(ctx))
+    {
+        return parse_int64(DMINI_LOAD(pair->value));
+    }
+    if (!(pair->flags & DMINI_PAIR_CACHED_INT))
+    {
+        pair->cache.i = parse_int64(DMINI_LOAD(pair->value));
+        pair->flags = (pair->flags & ~DMINI_PAIR_CACHED_MASK) | DMINI_PAIR_CACHED_INT;
+    }
+    return pair->cache.i;
+#else
+    return parse_int64(DMINI_LOAD(pair->value));
+#endif
+}
+
+/**
+ * @brief Get the value of a pair as a float, converting it at most once
+ */
+static float pair_float(dmini_context_t ctx, dmini_pair_t* pair)
+{
+#if DMINI_CACHE_VALUES
+    if (CTX_CONCURRENT(ctx))
+    {
+        return parse_float(DMINI_LOAD(pair->value));
+    }
+    if (!(pair->flags & DMINI_PAIR_CACHED_FLOAT))
+    {
+        pair->cache.f = parse_float(DMINI_LOAD(pair->value));
+        pair->flags = (pair->flags & ~DMINI_PAIR_CACHED_MASK) | DMINI_PAIR_CACHED_FLOAT;
+    }
+    return pair->cache.f;
+#else
+    return parse_float(DMINI_LOAD(pair->value));
+#endif
+}
+
+/**
+ * @brief Get the value of a pair as a boolean (-1 if it is not one)
+ */
+static int pair_bool(dmini_context_t ctx, dmini_pair_t* pair)
+{
+#if DMINI_CACHE_VALUES
+    if (CTX_CONCURRENT(ctx))
+    {
+        return parse_bool(DMINI_LOAD(pair->value));
+    }
+    if (!(pair->flags & DMINI_PAIR_CACHED_BOOL))
+    {
+        pair->cache.i = parse_bool(DMINI_LOAD(pair->value));
+        pair->flags = (pair->flags & ~DMINI_PAIR_CACHED_MASK) | DMINI_PAIR_CACHED_BOOL;
+    }
+    return (int)pair->cache.i;
+#else
+    return parse_bool(DMINI_LOAD(pair->value));
+#endif
+}
+
+/**
+ * @brief dmini_get_int() body, called inside a read-side section
+ */
+static int get_int_guarded(dmini_context_t ctx, const char* section, const char* key, int default_value)
+{
+    if (ctx_frozen(ctx))
+    {
+        const char* value = key ? frozen_value(ctx, section, key) : NULL;
+        return value ? (int)parse_int64(value) : default_value;
+    }
+
+    dmini_pair_t* pair = lookup_pair(ctx, section, key);
+    return pair ? (int)pair_int64(ctx, pair) : default_value;
+}
+
+int dmini_get_int(dmini_context_t ctx, const char* section, const char* key, int default_value)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    int result = get_int_guarded(ctx, section, key, default_value);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+/**
+ * @brief dmini_get_int64() body, called inside a read-side section
+ */
+static int64_t get_int64_guarded(dmini_context_t ctx, const char* section, const char* key, int64_t default_value)
+{
+    if (ctx_frozen(ctx))
+    {
+        const char* value = key ? frozen_value(ctx, section, key) : NULL;
+        return value ? parse_int64(value) : default_value;
+    }
+
+    dmini_pair_t* pair = lookup_pair(ctx, section, key);
+    return pair ? pair_int64(ctx, pair) : default_value;
+}
+
+int64_t dmini_get_int64(dmini_context_t ctx, const char* section, const char* key, int64_t default_value)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    int64_t result = get_int64_guarded(ctx, section, key, default_value);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+/**
+ * @brief dmini_get_float() body, called inside a read-side section
+ */
+static float get_float_guarded(dmini_context_t ctx, const char* section, const char* key, float default_value)
+{
+    if (ctx_frozen(ctx))
+    {
+        const char* value = key ? frozen_value(ctx, section, key) : NULL;
+        return value ? parse_float(value) : default_value;
+    }
+
+    dmini_pair_t* pair = lookup_pair(ctx, section, key);
+    return pair ? pair_float(ctx, pair) : default_value;
+}
+
+float dmini_get_float(dmini_context_t ctx, const char* section, const char* key, float default_value)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    float result = get_float_guarded(ctx, section, key, default_value);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+/**
+ * @brief dmini_get_bool() body, called inside a read-side section
+ */
+static int get_bool_guarded(dmini_context_t ctx, const char* section, const char* key, int default_value)
+{
+    int value;
+    if (ctx_frozen(ctx))
+    {
+        const char* text = key ? frozen_value(ctx, section, key) : NULL;
+        value = text ? parse_bool(text) : -1;
+    }
+    else
+    {
+        dmini_pair_t* pair = lookup_pair(ctx, section, key);
+        value = pair ? pair_bool(ctx, pair) : -1;
+    }
+    return value < 0 ? default_value : value;
+}
+
+int dmini_get_bool(dmini_context_t ctx, const char* section, const char* key, int default_value)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    int result = get_bool_guarded(ctx, section, key, default_value);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+/**
+ * @brief Find a pair, scanning the list from a given start and wrapping around
+ *
+ * Used by dmini_get_batch(): when the queries follow the order of the keys,
+ * every lookup starts where the previous one matched and the whole batch is
+ * a single walk of the list.
+ */
+static dmini_pair_t* find_pair_from(dmini_context_t ctx, dmini_section_t* section, dmini_pair_t* start,
+                                    const char* key, size_t len, unsigned int hash)
+{
+#if DMINI_USE_HASH_INDEX
+    if (section->index)
+    {
+        return find_pair_hashed(ctx, section, key, len, hash);
+    }
+#endif
+
+    unsigned int visited = 0;
+    dmini_pair_t* pair = start ? start : DMINI_LOAD(section->pairs);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (; pair; pair = DMINI_LOAD(pair->next))
+        {
+            visited++;
+            if (pair->hash == hash && span_equals(pair->key, pair->key_len, key, len))
+            {
+                return pair_found(ctx, pair, visited);
+            }
+            if (pass == 1 && pair == start)
+            {
+                return pair_found(ctx, NULL, visited);
+            }
+        }
+        if (!start)
+        {
+            break;
+        }
+        pair = DMINI_LOAD(section->pairs);
+    }
+
+    return pair_found(ctx, NULL, visited);
+}
+
+/**
+ * @brief Fill batch queries from a snapshot
+ */
+static int frozen_batch(dmini_context_t ctx, const char* section, const dmini_query_t* queries, size_t count)
+{
+    const dmini_image_t* image = ctx->image;
+    const dmini_image_section_t* sec = image_find_section(image, section);
+    int found = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const dmini_query_t* query = &queries[i];
+        const dmini_image_pair_t* pair = image_find_pair(image, sec, query->key);
+        const char* value = pair ? image_string(image, pair->value) : NULL;
+        if (value)
+        {
+            found++;
+        }
+        if (!query->out)
+        {
+            continue;
+        }
+
+        switch (query->type)
+        {
+            case DMINI_TYPE_STRING:
+                *(const char**)query->out = value ? value : query->default_value.s;
+                break;
+            case DMINI_TYPE_INT:
+                *(int*)query->out = value ? (int)parse_int64(value) : query->default_value.i;
+                break;
+            case DMINI_TYPE_INT64:
+                *(int64_t*)query->out = value ? parse_int64(value) : query->default_value.i64;
+                break;
+            case DMINI_TYPE_FLOAT:
+                *(float*)query->out = value ? parse_float(value) : query->default_value.f;
+                break;
+            case DMINI_TYPE_BOOL:
+            {
+                int flag = value ? parse_bool(value) : -1;
+                *(int*)query->out = flag < 0 ? query->default_value.i : flag;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    return found;
+}
+
+/**
+ * @brief dmini_get_batch() body, called inside a read-side section
+ */
+static int get_batch_guarded(dmini_context_t ctx, const char* section, const dmini_query_t* queries, size_t count)
+{
+    if (!ctx || (!queries && count > 0))
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    if (ctx_frozen(ctx))
+    {
+        return frozen_batch(ctx, section, queries, count);
+    }
+
+    dmini_section_t* sec = find_section(ctx, section);
+    dmini_pair_t* next = NULL;
+    int found = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const dmini_query_t* query = &queries[i];
+        dmini_pair_t* pair = NULL;
+        if (sec && query->key)
+        {
+            size_t len = strlen(query->key);
+            pair = find_pair_from(ctx, sec, next, query->key, len, hash_bytes(query->key, len));
+        }
+        if (pair)
+        {
+            next = DMINI_LOAD(pair->next);
+            found++;
+        }
+        if (!query->out)
+        {
+            continue;
+        }
+
+        switch (query->type)
+        {
+            case DMINI_TYPE_STRING:
+                *(const char**)query->out = pair ? DMINI_LOAD(pair->value) : query->default_value.s;
+                break;
+            case DMINI_TYPE_INT:
+                *(int*)query->out = pair ? (int)pair_int64(ctx, pair) : query->default_value.i;
+                break;
+            case DMINI_TYPE_INT64:
+                *(int64_t*)query->out = pair ? pair_int64(ctx, pair) : query->default_value.i64;
+                break;
+            case DMINI_TYPE_FLOAT:
+                *(float*)query->out = pair ? pair_float(ctx, pair) : query->default_value.f;
+                break;
+            case DMINI_TYPE_BOOL:
+            {
+                int value = pair ? pair_bool(ctx, pair) : -1;
+                *(int*)query->out = value < 0 ? query->default_value.i : value;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    return found;
+}
+
+int dmini_get_batch(dmini_context_t ctx, const char* section, const dmini_query_t* queries, size_t count)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    int result = get_batch_guarded(ctx, section, queries, count);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+/**
+ * @brief Resolve a handle to its pair (NULL if the handle is stale)
+ */
+static dmini_pair_t* handle_pair(dmini_context_t ctx, dmini_handle_t handle)
+{
+    if (!ctx || !handle.pair || handle.generation != DMINI_ATOMIC_LOAD(&ctx->generation))
+    {
+        return NULL;
+    }
+    return (dmini_pair_t*)handle.pair;
+}
+
+/**
+ * @brief dmini_lookup() body, called inside a read-side section
+ */
+static dmini_handle_t lookup_guarded(dmini_context_t ctx, const char* section, const char* key)
+{
+    dmini_handle_t handle = { NULL, 0 };
+    if (!ctx || !key)
+    {
+        return handle;
+    }
+
+    if (ctx_frozen(ctx))
+    {
+        const dmini_image_t* image = ctx->image;
+        handle.pair = (void*)image_find_pair(image, image_find_section(image, section), key);
+        handle.generation = handle.pair ? ctx->generation : 0;
+        return handle;
+    }
+
+    dmini_section_t* sec = find_section(ctx, section);
+    if (!sec)
+    {
+        return handle;
+    }
+
+    handle.pair = find_pair(ctx, sec, key);
+    if (handle.pair)
+    {
+        handle.generation = DMINI_ATOMIC_LOAD(&ctx->generation);
+    }
+    return handle;
+}
+
+dmini_handle_t dmini_lookup(dmini_context_t ctx, const char* section, const char* key)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    dmini_handle_t result = lookup_guarded(ctx, section, key);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+/**
+ * @brief dmini_handle_valid() body, called inside a read-side section
+ */
+static int handle_valid_guarded(dmini_context_t ctx, dmini_handle_t handle)
+{
+    return handle_pair(ctx, handle) != NULL;
+}
+
+int dmini_handle_valid(dmini_context_t ctx, dmini_handle_t handle)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    int result = handle_valid_guarded(ctx, handle);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+/**
+ * @brief dmini_handle_get_string() body, called inside a read-side section
+ */
+static const char* handle_get_string_guarded(dmini_context_t ctx, dmini_handle_t handle, const char* default_value)
+{
+    if (ctx_frozen(ctx))
+    {
+        const dmini_image_pair_t* pair = (const dmini_image_pair_t*)handle_pair(ctx, handle);
+        return pair ? image_string(ctx->image, pair->value) : default_value;
+    }
+
+    dmini_pair_t* pair = handle_pair(ctx, handle);
+    return pair ? DMINI_LOAD(pair->value) : default_value;
+}
+
+const char* dmini_handle_get_string(dmini_context_t ctx, dmini_handle_t handle, const char* default_value)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    const char* result = handle_get_string_guarded(ctx, handle, default_value);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+/**
+ * @brief dmini_handle_get_int() body, called inside a read-side section
+ */
+static int handle_get_int_guarded(dmini_context_t ctx, dmini_handle_t handle, int default_value)
+{
+    if (ctx_frozen(ctx))
+    {
+        const dmini_image_pair_t* pair = (const dmini_image_pair_t*)handle_pair(ctx, handle);
+        return pair ? (int)parse_int64(image_string(ctx->image, pair->value)) : default_value;
+    }
 
-    /* Create global section (unnamed section for keys without section) */
-    ctx->sections = create_section(NULL);
-    if (!ctx->sections)
+    dmini_pair_t* pair = handle_pair(ctx, handle);
+    return pair ? (int)pair_int64(ctx, pair) : default_value;
+}
+
+int dmini_handle_get_int(dmini_context_t ctx, dmini_handle_t handle, int default_value)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    int result = handle_get_int_guarded(ctx, handle, default_value);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+/**
+ * @brief dmini_set_string() body, called with the writer lock held
+ */
+static int set_string_locked(dmini_context_t ctx, const char* section, const char* key, const char* value)
+{
+    if (ctx_frozen(ctx))
     {
-        Dmod_Free(ctx);
-        return NULL;
+        return DMINI_ERR_READONLY;
     }
 
-    return ctx;
+    if (!ctx || !key || !value)
+    {
+        return DMINI_ERR_INVALID;
+    }
+    
+    dmini_section_t* sec = get_or_create_section(ctx, section);
+    if (!sec)
+    {
+        return DMINI_ERR_MEMORY;
+    }
+    
+    return set_pair_in_section(ctx, sec, key, value);
 }
 
-void dmini_destroy(dmini_context_t ctx)
+int dmini_set_string(dmini_context_t ctx, const char* section, const char* key, const char* value)
 {
-    if (!ctx)
+    writer_lock(ctx);
+    int result = set_string_locked(ctx, section, key, value);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_set_int() body, called with the writer lock held
+ */
+static int set_int_locked(dmini_context_t ctx, const char* section, const char* key, int value)
+{
+    if (ctx_frozen(ctx))
     {
-        return;
+        return DMINI_ERR_READONLY;
     }
+
+    // Convert integer to string
+    char buffer[32];
+    char* p = buffer + sizeof(buffer) - 1;
+    *p = '\0';
     
-    // Free all sections
-    dmini_section_t* section = ctx->sections;
-    while (section)
+    int is_negative = 0;
+    unsigned int abs_value;
+    
+    if (value < 0)
     {
-        dmini_section_t* next = section->next;
-        free_section(section);
-        section = next;
+        is_negative = 1;
+        // Handle INT_MIN safely by casting to unsigned
+        abs_value = (unsigned int)(-(value + 1)) + 1;
+    }
+    else
+    {
+        abs_value = (unsigned int)value;
+    }
+    
+    // Convert digits
+    do
+    {
+        *--p = '0' + (abs_value % 10);
+        abs_value /= 10;
+    } while (abs_value > 0);
+    
+    // Add sign
+    if (is_negative)
+    {
+        *--p = '-';
+    }
+    
+    if (!ctx || !key)
+    {
+        return DMINI_ERR_INVALID;
+    }
+    
+    dmini_section_t* sec = get_or_create_section(ctx, section);
+    if (!sec)
+    {
+        return DMINI_ERR_MEMORY;
+    }
+    
+    dmini_pair_t* pair = NULL;
+    int result = set_pair_span(ctx, sec, key, strlen(key),
+                               p, (size_t)(buffer + sizeof(buffer) - 1 - p), 0, &pair);
+#if DMINI_CACHE_VALUES
+    /* Seed the cache so the first read does not parse the string back */
+    if (result == DMINI_OK && !CTX_CONCURRENT(ctx))
+    {
+        pair->cache.i = value;
+        pair->flags = (pair->flags & ~DMINI_PAIR_CACHED_MASK) | DMINI_PAIR_CACHED_INT;
     }
+#endif
+    return result;
+}
+
+int dmini_set_int(dmini_context_t ctx, const char* section, const char* key, int value)
+{
+    writer_lock(ctx);
+    int result = set_int_locked(ctx, section, key, value);
+    writer_unlock(ctx);
+    return result;
+}
 
-    if (ctx->active_section)
+/**
+ * @brief dmini_has_section() body, called inside a read-side section
+ */
+static int has_section_guarded(dmini_context_t ctx, const char* section)
+{
+    if (!ctx)
+    {
+        return 0;
+    }
+    
+    if (ctx_frozen(ctx))
     {
-        Dmod_Free(ctx->active_section);
+        return image_find_section(ctx->image, section) ? 1 : 0;
     }
+    
+    return find_section(ctx, section) ? 1 : 0;
+}
 
-    Dmod_Free(ctx);
+int dmini_has_section(dmini_context_t ctx, const char* section)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    int result = has_section_guarded(ctx, section);
+    dmini_read_end(ctx, token);
+    return result;
 }
 
-int dmini_parse_string(dmini_context_t ctx, const char* data)
+/**
+ * @brief dmini_has_key() body, called inside a read-side section
+ */
+static int has_key_guarded(dmini_context_t ctx, const char* section, const char* key)
 {
-    if (!ctx || !data)
+    if (!ctx || !key)
     {
-        return DMINI_ERR_INVALID;
+        return 0;
     }
     
-    // Duplicate data so we can modify it
-    char* buffer = Dmod_StrDup(data);
-    if (!buffer)
+    if (ctx_frozen(ctx))
     {
-        return DMINI_ERR_MEMORY;
+        return frozen_value(ctx, section, key) ? 1 : 0;
+    }
+    
+    dmini_section_t* sec = find_section(ctx, section);
+    if (!sec)
+    {
+        return 0;
     }
     
-    dmini_section_t* current_section = ctx->sections; // Start with global section
+    return find_pair(ctx, sec, key) ? 1 : 0;
+}
+
+int dmini_has_key(dmini_context_t ctx, const char* section, const char* key)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    int result = has_key_guarded(ctx, section, key);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+/**
+ * @brief dmini_remove_section() body, called with the writer lock held
+ */
+static int remove_section_locked(dmini_context_t ctx, const char* section)
+{
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
+    if (!ctx || !section)
+    {
+        return DMINI_ERR_INVALID;
+    }
     
-    char* line = buffer;
-    char* next_line;
+    dmini_section_t* prev = NULL;
+    dmini_section_t* curr = ctx->sections;
     
-    while (line && *line)
+    while (curr)
     {
-        // Find end of line
-        next_line = line;
-        while (*next_line && *next_line != '\n' && *next_line != '\r')
-        {
-            next_line++;
-        }
-        
-        // Null terminate current line
-        if (*next_line)
-        {
-            *next_line = '\0';
-            next_line++;
-            // Skip \r\n combinations
-            if (*next_line == '\n' || *next_line == '\r')
-            {
-                next_line++;
-            }
-        }
-        
-        // Trim whitespace
-        line = trim_whitespace(line);
-        
-        // Skip empty lines and comments
-        if (*line == '\0' || *line == ';' || *line == '#')
-        {
-            line = next_line;
-            continue;
-        }
-        
-        // Check for section header
-        if (*line == '[')
+        if (curr->name && strcmp(curr->name, section) == 0)
         {
-            char* section_end = line + 1;
-            while (*section_end && *section_end != ']')
-            {
-                section_end++;
-            }
-            
-            if (*section_end == ']')
+            // Watches hear about every key, including the ones not loaded yet
+            if (ctx->watches && curr->lazy)
             {
-                *section_end = '\0';
-                char* section_name = trim_whitespace(line + 1);
-                
-                current_section = get_or_create_section(ctx, section_name);
-                if (!current_section)
-                {
-                    Dmod_Free(buffer);
-                    return DMINI_ERR_MEMORY;
-                }
+                section_load(ctx, curr);
             }
-            
-            line = next_line;
-            continue;
-        }
-        
-        // Parse key=value
-        char* equals = line;
-        while (*equals && *equals != '=')
-        {
-            equals++;
-        }
-        
-        if (*equals == '=')
-        {
-            *equals = '\0';
-            char* key = trim_whitespace(line);
-            strip_inline_comment(equals + 1);
-            char* value = trim_whitespace(equals + 1);
-            
-            if (*key)
+
+            context_unlink_section(ctx, prev, curr);
+            lazy_release(ctx, curr);
+            for (dmini_pair_t* pair = curr->pairs; pair; pair = pair->next)
             {
-                int result = set_pair_in_section(current_section, key, value);
-                if (result != DMINI_OK)
-                {
-                    Dmod_Free(buffer);
-                    return result;
-                }
+                watch_notify(ctx, curr, pair->key, NULL);
             }
+
+            DMINI_ATOMIC_ADD(&ctx->generation, 1u);
+            ctx_retire(ctx, DMINI_RETIRE_SECTION, curr, 0);
+            return DMINI_OK;
         }
         
-        line = next_line;
+        prev = curr;
+        curr = curr->next;
     }
     
-    Dmod_Free(buffer);
-    return DMINI_OK;
+    return DMINI_ERR_NOT_FOUND;
 }
 
-int dmini_parse_file(dmini_context_t ctx, const char* filename)
+int dmini_remove_section(dmini_context_t ctx, const char* section)
 {
-    if (!ctx || !filename)
+    writer_lock(ctx);
+    int result = remove_section_locked(ctx, section);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_remove_key() body, called with the writer lock held
+ */
+static int remove_key_locked(dmini_context_t ctx, const char* section, const char* key)
+{
+    if (ctx_frozen(ctx))
     {
-        return DMINI_ERR_INVALID;
+        return DMINI_ERR_READONLY;
     }
-    
-    // Open file using SAL
-    void* file = Dmod_FileOpen(filename, "r");
-    if (!file)
+
+    if (!ctx || !key)
     {
-        return DMINI_ERR_FILE;
+        return DMINI_ERR_INVALID;
     }
     
-    dmini_section_t* current_section = ctx->sections; // Start with global section
-    if (!current_section)
+    dmini_section_t* sec = find_section(ctx, section);
+    if (!sec)
     {
-        Dmod_FileClose(file);
-        return DMINI_ERR_INVALID;
+        return DMINI_ERR_NOT_FOUND;
     }
     
-    char line_buffer[256];
+    unsigned int hash = hash_string(key);
+    dmini_pair_t* prev = NULL;
+    dmini_pair_t* curr = sec->pairs;
     
-    // Read file line by line
-    while (Dmod_FileReadLine(line_buffer, sizeof(line_buffer), file) != NULL)
+    while (curr)
     {
-        // Trim whitespace
-        char* line = trim_whitespace(line_buffer);
-        
-        // Skip empty lines and comments
-        if (*line == '\0' || *line == ';' || *line == '#')
+        if (curr->hash == hash && strcmp(curr->key, key) == 0)
         {
-            continue;
+            section_unlink_pair(ctx, sec, prev, curr);
+            watch_notify(ctx, sec, curr->key, NULL);
+
+            DMINI_ATOMIC_ADD(&ctx->generation, 1u);
+            ctx_retire(ctx, DMINI_RETIRE_PAIR, curr, 0);
+            return DMINI_OK;
         }
         
-        // Check for section header
-        if (*line == '[')
+        prev = curr;
+        curr = curr->next;
+    }
+    
+    return DMINI_ERR_NOT_FOUND;
+}
+
+int dmini_remove_key(dmini_context_t ctx, const char* section, const char* key)
+{
+    writer_lock(ctx);
+    int result = remove_key_locked(ctx, section, key);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief Bytes a heap context holds for a pair and its strings
+ */
+static inline size_t pair_footprint(const dmini_pair_t* pair)
+{
+    return DMINI_ALIGN_UP(sizeof(dmini_pair_t)) + DMINI_ALIGN_UP(pair->key_len + 1) +
+           DMINI_ALIGN_UP(pair->value_len + 1);
+}
+
+/**
+ * @brief Remove the keys and sections of a merge destination missing in the source
+ */
+static void merge_prune(dmini_context_t dst, dmini_context_t src)
+{
+    dmini_section_t* prev = NULL;
+    dmini_section_t* dsec = dst->sections;
+    while (dsec)
+    {
+        dmini_section_t* next = dsec->next;
+        dmini_section_t* sec = lookup_section(src, dsec->name, dsec->name_len, dsec->hash);
+
+        dmini_pair_t* pair_prev = NULL;
+        dmini_pair_t* pair = dsec->pairs;
+        while (pair)
         {
-            char* section_end = line + 1;
-            while (*section_end && *section_end != ']')
+            dmini_pair_t* pair_next = pair->next;
+            if (sec && find_pair_hashed(src, sec, pair->key, pair->key_len, pair->hash))
             {
-                section_end++;
+                pair_prev = pair;
             }
-            
-            if (*section_end == ']')
+            else
             {
-                *section_end = '\0';
-                char* section_name = trim_whitespace(line + 1);
-                
-                current_section = get_or_create_section(ctx, section_name);
-                if (!current_section)
-                {
-                    Dmod_FileClose(file);
-                    return DMINI_ERR_MEMORY;
-                }
+                section_unlink_pair(dst, dsec, pair_prev, pair);
+                watch_notify(dst, dsec, pair->key, NULL);
+                ctx_retire(dst, DMINI_RETIRE_PAIR, pair, 0);
             }
-            
-            continue;
+            pair = pair_next;
         }
-        
-        // Parse key=value
-        char* equals = line;
-        while (*equals && *equals != '=')
+
+        if (!sec && dsec->name)
         {
-            equals++;
+            context_unlink_section(dst, prev, dsec);
+            ctx_retire(dst, DMINI_RETIRE_SECTION, dsec, 0);
         }
-        
-        if (*equals == '=')
-        {
-            *equals = '\0';
-            char* key = trim_whitespace(line);
-            strip_inline_comment(equals + 1);
-            char* value = trim_whitespace(equals + 1);
-            
-            if (*key)
-            {
-                int result = set_pair_in_section(current_section, key, value);
-                if (result != DMINI_OK)
-                {
-                    Dmod_FileClose(file);
-                    return result;
-                }
-            }
+        else
+        {
+            prev = dsec;
         }
+        dsec = next;
     }
-    
-    Dmod_FileClose(file);
+}
+
+/**
+ * @brief Move the first pair of a source section into the destination section
+ *
+ * New keys take over the node of the source when both contexts allocate
+ * from the heap; changed values and everything else are copied. The pair
+ * stays in the source if the copy fails.
+ */
+static int merge_pair(dmini_context_t dst, dmini_section_t* dsec,
+                      dmini_context_t src, dmini_section_t* sec, int policy)
+{
+    dmini_pair_t* pair = sec->pairs;
+    dmini_pair_t* existing = find_pair_hashed(dst, dsec, pair->key, pair->key_len, pair->hash);
+    int adopt = !existing && ctx_shares_heap(dst, src) && !CTX_CONCURRENT(src) &&
+                !(pair->flags & (DMINI_PAIR_KEY_SHARED | DMINI_PAIR_VALUE_SHARED));
+
+    if (!adopt && !(existing && policy == DMINI_MERGE_KEEP))
+    {
+        int result = set_pair_span(dst, dsec, pair->key, pair->key_len, pair->value, pair->value_len, 0, NULL);
+        if (result != DMINI_OK)
+        {
+            return result;
+        }
+    }
+
+    section_unlink_pair(src, sec, NULL, pair);
+    watch_notify(src, sec, pair->key, NULL);
+    if (!adopt)
+    {
+        ctx_retire(src, DMINI_RETIRE_PAIR, pair, 0);
+        return DMINI_OK;
+    }
+
+    size_t footprint = pair_footprint(pair);
+    src->memory_used -= footprint;
+    dst->memory_used += footprint;
+    pair->next = NULL;
+    pair->flags &= ~DMINI_PAIR_SOURCED;
+    section_append_pair(dst, dsec, pair);
     return DMINI_OK;
 }
 
-int dmini_generate_string(dmini_context_t ctx, char* buffer, size_t buffer_size)
+/**
+ * @brief dmini_merge() body, called with both writer locks held
+ */
+static int merge_locked(dmini_context_t dst, dmini_context_t src, int policy)
 {
-    if (!ctx)
+    if (ctx_frozen(dst) || ctx_frozen(src))
     {
-        return DMINI_ERR_INVALID;
+        return DMINI_ERR_READONLY;
     }
-    
-    // Calculate required buffer size
-    size_t required_size = 0;
-    
-    dmini_section_t* section = ctx->sections;
-    while (section)
+
+    if (!dst || !src || dst == src || policy < DMINI_MERGE_OVERWRITE || policy > DMINI_MERGE_REPLACE ||
+        dst->stream || src->stream)
     {
-        /* Skip sections not visible under the active-section restriction */
-        if (ctx->active_section_locked &&
-            !section_names_equal(section->name, ctx->active_section))
-        {
-            section = section->next;
-            continue;
-        }
+        return DMINI_ERR_INVALID;
+    }
 
-        // Section header (skip global section)
-        if (section->name)
-        {
-            required_size += strlen(section->name) + 3; // [name]\n
-        }
-        
-        // Key-value pairs
-        dmini_pair_t* pair = section->pairs;
-        while (pair)
-        {
-            // Validate pair data before calculating size
-            if (!pair->key || !pair->value)
-            {
-                return DMINI_ERR_INVALID;
-            }
-            required_size += strlen(pair->key) + strlen(pair->value) + 2; // key=value\n
-            pair = pair->next;
-        }
-        
-        // Empty line after section
-        if (section->name && section->next)
-        {
-            required_size += 1;
-        }
-        
-        section = section->next;
+    if (dst->active_section_locked || src->active_section_locked)
+    {
+        return DMINI_ERR_LOCKED;
     }
-    
-    // Add 1 for null terminator
-    required_size += 1;
-    
-    // If buffer is NULL, just return the required size
-    if (!buffer)
+
+    // Sections loaded later would overwrite the merged values
+    int result = lazy_load_all(dst);
+    if (result == DMINI_OK)
     {
-        return (int)required_size;
+        result = lazy_load_all(src);
     }
-    
-    // Check if buffer is large enough
-    if (buffer_size < required_size)
+    if (result != DMINI_OK)
     {
-        return DMINI_ERR_MEMORY;
+        return result;
     }
-    
-    // Generate INI string
-    char* pos = buffer;
-    section = ctx->sections;
-    
-    while (section)
+
+    if (policy == DMINI_MERGE_REPLACE)
     {
-        /* Skip sections not visible under the active-section restriction */
-        if (ctx->active_section_locked &&
-            !section_names_equal(section->name, ctx->active_section))
-        {
-            section = section->next;
-            continue;
-        }
+        merge_prune(dst, src);
+    }
 
-        // Section header (skip global section)
-        if (section->name)
-        {
-            *pos++ = '[';
-            size_t name_len = strlen(section->name);
-            memcpy(pos, section->name, name_len);
-            pos += name_len;
-            *pos++ = ']';
-            *pos++ = '\n';
-        }
-        
-        // Key-value pairs
-        dmini_pair_t* pair = section->pairs;
-        while (pair)
+    for (dmini_section_t* sec = src->sections; sec && result == DMINI_OK; sec = sec->next)
+    {
+        dmini_section_t* dsec = get_or_create_section_span(dst, sec->name, sec->name_len, 0);
+        if (!dsec)
         {
-            size_t key_len = strlen(pair->key);
-            memcpy(pos, pair->key, key_len);
-            pos += key_len;
-            *pos++ = '=';
-            size_t value_len = strlen(pair->value);
-            memcpy(pos, pair->value, value_len);
-            pos += value_len;
-            *pos++ = '\n';
-            pair = pair->next;
+            result = DMINI_ERR_MEMORY;
+            break;
         }
-        
-        // Empty line after section
-        if (section->name && section->next)
+        while (sec->pairs && result == DMINI_OK)
         {
-            *pos++ = '\n';
+            result = merge_pair(dst, dsec, src, sec, policy);
         }
-        
-        section = section->next;
     }
-    
-    *pos = '\0';
-    
-    return (int)required_size;
-}
 
-int dmini_generate_file(dmini_context_t ctx, const char* filename)
-{
-    if (!ctx || !filename)
-    {
-        return DMINI_ERR_INVALID;
-    }
-    
-    // Open file for writing
-    void* file = Dmod_FileOpen(filename, "w");
-    if (!file)
+    // The global section always comes first and stays
+    while (result == DMINI_OK && src->sections->next)
     {
-        return DMINI_ERR_FILE;
+        dmini_section_t* section = src->sections->next;
+        context_unlink_section(src, src->sections, section);
+        ctx_retire(src, DMINI_RETIRE_SECTION, section, 0);
     }
-    
-    // Write sections directly to file
-    dmini_section_t* section = ctx->sections;
-    char line_buffer[256];
-    
-    while (section)
+
+    DMINI_ATOMIC_ADD(&dst->generation, 1u);
+    DMINI_ATOMIC_ADD(&src->generation, 1u);
+    return result;
+}
+
+int dmini_merge(dmini_context_t dst, dmini_context_t src, int policy)
+{
+    writer_lock(dst);
+    writer_lock(src);
+    int result = merge_locked(dst, src, policy);
+    writer_unlock(src);
+    writer_unlock(dst);
+    return result;
+}
+
+/**
+ * @brief Compare the visible keys of one context against another
+ *
+ * @param added 0 to report keys removed or changed in @p other,
+ *              1 to report keys only @p other has
+ */
+static int diff_walk(dmini_context_t ctx, dmini_context_t other, int added,
+                     dmini_diff_callback_t callback, void* user)
+{
+    int count = 0;
+    for (dmini_section_t* sec = DMINI_LOAD(ctx->sections); sec; sec = DMINI_LOAD(sec->next))
     {
-        /* Skip sections not visible under the active-section restriction */
-        if (ctx->active_section_locked &&
-            !section_names_equal(section->name, ctx->active_section))
+        if (!section_visible(ctx, sec))
         {
-            section = section->next;
             continue;
         }
+        section_touch(ctx, sec);
 
-        // Section header (skip global section)
-        if (section->name)
+        dmini_section_t* osec = lookup_section(other, sec->name, sec->name_len, sec->hash);
+        if (osec && !section_visible(other, osec))
         {
-            int len = Dmod_SnPrintf(line_buffer, sizeof(line_buffer), "[%s]\n", section->name);
-            if (len > 0 && len < (int)sizeof(line_buffer))
-            {
-                size_t written = Dmod_FileWrite(line_buffer, 1, len, file);
-                if (written != (size_t)len)
-                {
-                    Dmod_FileClose(file);
-                    return DMINI_ERR_FILE;
-                }
-            }
+            osec = NULL;
         }
-        
-        // Key-value pairs
-        dmini_pair_t* pair = section->pairs;
-        while (pair)
+
+        dmini_pair_t* start = NULL;
+        for (dmini_pair_t* pair = DMINI_LOAD(sec->pairs); pair; pair = DMINI_LOAD(pair->next))
         {
-            if (!pair->key || !pair->value)
-            {
-                Dmod_FileClose(file);
-                return DMINI_ERR_INVALID;
-            }
-            
-            int len = Dmod_SnPrintf(line_buffer, sizeof(line_buffer), "%s=%s\n", 
-                                     pair->key, pair->value);
-            if (len > 0 && len < (int)sizeof(line_buffer))
+            dmini_pair_t* match = osec ? find_pair_from(other, osec, start, pair->key, pair->key_len, pair->hash)
+                                       : NULL;
+            const char* value = DMINI_LOAD(pair->value);
+            if (match)
             {
-                size_t written = Dmod_FileWrite(line_buffer, 1, len, file);
-                if (written != (size_t)len)
+                start = DMINI_LOAD(match->next);
+                const char* other_value = DMINI_LOAD(match->value);
+                if (added || strcmp(value, other_value) == 0)
                 {
-                    Dmod_FileClose(file);
-                    return DMINI_ERR_FILE;
+                    continue;
+                }
+                if (callback)
+                {
+                    callback(sec->name, pair->key, value, other_value, user);
                 }
             }
-            else if (len >= (int)sizeof(line_buffer))
-            {
-                // Line too long - truncated
-                Dmod_FileClose(file);
-                return DMINI_ERR_INVALID;
-            }
-            
-            pair = pair->next;
-        }
-        
-        // Empty line after section
-        if (section->name && section->next)
-        {
-            size_t written = Dmod_FileWrite("\n", 1, 1, file);
-            if (written != 1)
+            else if (callback)
             {
-                Dmod_FileClose(file);
-                return DMINI_ERR_FILE;
+                callback(sec->name, pair->key, added ? NULL : value, added ? value : NULL, user);
             }
+            count++;
         }
-        
-        section = section->next;
     }
-    
-    Dmod_FileClose(file);
-    return DMINI_OK;
+    return count;
 }
 
-const char* dmini_get_string(dmini_context_t ctx, const char* section, const char* key, const char* default_value)
+/**
+ * @brief dmini_diff() body, called inside the read-side sections of both contexts
+ */
+static int diff_guarded(dmini_context_t from, dmini_context_t to, dmini_diff_callback_t callback, void* user)
 {
-    if (!ctx || !key)
-    {
-        return default_value;
-    }
-    
-    dmini_section_t* sec = find_section(ctx, section);
-    if (!sec)
-    {
-        return default_value;
-    }
-    
-    dmini_pair_t* pair = find_pair(sec, key);
-    if (!pair)
+    if (!from || !to || ctx_frozen(from) || ctx_frozen(to))
     {
-        return default_value;
+        return DMINI_ERR_INVALID;
     }
-    
-    return pair->value;
+
+    int count = diff_walk(from, to, 0, callback, user);
+    return count + diff_walk(to, from, 1, callback, user);
 }
 
-int dmini_get_int(dmini_context_t ctx, const char* section, const char* key, int default_value)
+int dmini_diff(dmini_context_t from, dmini_context_t to, dmini_diff_callback_t callback, void* user)
 {
-    const char* value = dmini_get_string(ctx, section, key, NULL);
-    if (!value)
-    {
-        return default_value;
-    }
-    
-    // Simple integer conversion
-    int result = 0;
-    int sign = 1;
-    const char* p = value;
-    
-    // Skip whitespace
-    while (*p == ' ' || *p == '\t')
-    {
-        p++;
-    }
-    
-    // Check for sign
-    if (*p == '-')
+    unsigned int from_token = dmini_read_begin(from);
+    unsigned int to_token = dmini_read_begin(to);
+    int result = diff_guarded(from, to, callback, user);
+    dmini_read_end(to, to_token);
+    dmini_read_end(from, from_token);
+    return result;
+}
+
+#if DMINI_USE_PARALLEL
+/**
+ * @brief Find the first [section] line after the line containing an offset
+ *
+ * Only lines the parser accepts as headers count, so every chunk after the
+ * first starts with the header its lines belong to.
+ *
+ * @return Offset of the header line, or @p len if there is none
+ */
+static size_t parallel_boundary(const char* data, size_t len, size_t from)
+{
+    const char* end = data + len;
+    const char* p = scan_line_end(data + from, end);
+    while (p < end)
     {
-        sign = -1;
-        p++;
+        const char* line = ++p;
+        const char* line_end = scan_line_end(p, end);
+        while (line < line_end && is_space(*line))
+        {
+            line++;
+        }
+        if (line < line_end && *line == '[' && scan_for(line + 1, line_end, ']', ']', ']') < line_end)
+        {
+            return (size_t)(p - data);
+        }
+        p = line_end;
     }
-    else if (*p == '+')
+    return len;
+}
+
+/**
+ * @brief Task parsing one chunk into its private context
+ */
+static void parallel_task(void* arg)
+{
+    dmini_chunk_t* chunk = (dmini_chunk_t*)arg;
+    dmini_parser_t parser;
+    parser_init(&parser, chunk->ctx);
+    chunk->result = parse_buffer(&parser, chunk->data, chunk->len);
+}
+
+/**
+ * @brief Link a section parsed by a chunk into the context
+ *
+ * The section keeps its pairs and key index; its pairs are announced as a
+ * parse would announce them.
+ *
+ * @return Bytes of heap memory the section holds
+ */
+static size_t parallel_adopt(dmini_context_t ctx, dmini_section_t* section)
+{
+    size_t footprint = DMINI_ALIGN_UP(sizeof(dmini_section_t)) + DMINI_ALIGN_UP(section->name_len + 1);
+#if DMINI_USE_HASH_INDEX
+    if (section->index)
     {
-        p++;
+        footprint += DMINI_ALIGN_UP(index_size(section->index->capacity));
     }
-    
-    // Convert digits
-    while (*p >= '0' && *p <= '9')
+#endif
+
+    section->next = NULL;
+    section->flags &= ~DMINI_SECTION_DIRTY;
+    DMINI_PUBLISH(ctx->sections_tail->next, section);
+    ctx->sections_tail = section;
+    ctx->section_count++;
+    ctx->content_size += section->size;
+#if DMINI_USE_HASH_INDEX
+    index_add_section(ctx, section);
+#endif
+    mark_dirty(ctx, section, NULL);
+
+    for (dmini_pair_t* pair = section->pairs; pair; pair = pair->next)
     {
-        result = result * 10 + (*p - '0');
-        p++;
+        footprint += pair_footprint(pair);
+        watch_notify(ctx, section, pair->key, pair->value);
     }
-    
-    return result * sign;
+    return footprint;
 }
 
-int dmini_set_string(dmini_context_t ctx, const char* section, const char* key, const char* value)
+/**
+ * @brief Move the content of a parsed chunk into the context
+ *
+ * A section the context does not have yet is taken over whole when the
+ * context allocates from the heap. Everything else is merged pair by pair
+ * as dmini_merge() does, so repeated sections are merged and later values
+ * win as in a serial parse.
+ */
+static int parallel_splice(dmini_context_t ctx, dmini_context_t part)
 {
-    if (!ctx || !key || !value)
+    dmini_section_t* prev = NULL;
+    dmini_section_t* sec = part->sections;
+    while (sec)
     {
-        return DMINI_ERR_INVALID;
+        dmini_section_t* next = sec->next;
+        dmini_section_t* dsec = lookup_section(ctx, sec->name, sec->name_len, sec->hash);
+        if (!dsec && sec->name && ctx_shares_heap(ctx, part))
+        {
+            context_unlink_section(part, prev, sec);
+            size_t footprint = parallel_adopt(ctx, sec);
+            part->memory_used -= footprint;
+            ctx->memory_used += footprint;
+            sec = next;
+            continue;
+        }
+
+        if (!dsec)
+        {
+            dsec = get_or_create_section_span(ctx, sec->name, sec->name_len, 0);
+            if (!dsec)
+            {
+                return DMINI_ERR_MEMORY;
+            }
+        }
+        while (sec->pairs)
+        {
+            int result = merge_pair(ctx, dsec, part, sec, DMINI_MERGE_OVERWRITE);
+            if (result != DMINI_OK)
+            {
+                return result;
+            }
+        }
+        prev = sec;
+        sec = next;
     }
-    
-    dmini_section_t* sec = get_or_create_section(ctx, section);
-    if (!sec)
+
+#if DMINI_USE_STATS
+    // The work of the chunk is work of this parse
+    for (unsigned int stat = 0; stat < DMINI_STAT_COUNT; stat++)
     {
-        return DMINI_ERR_MEMORY;
+        DMINI_STAT_ADD(ctx, stat, DMINI_STAT_GET(part, stat));
     }
-    
-    return set_pair_in_section(sec, key, value);
+#endif
+    return DMINI_OK;
 }
 
-int dmini_set_int(dmini_context_t ctx, const char* section, const char* key, int value)
+/**
+ * @brief Split a document into chunks and parse them through the executor
+ *
+ * @return DMINI_OK, an error, or 1 when the document is better parsed serially
+ */
+static int parallel_parse(dmini_context_t ctx, const char* data, size_t len,
+                          unsigned int workers, dmini_run_tasks_t run, void* user)
 {
-    // Convert integer to string
-    char buffer[32];
-    char* p = buffer + sizeof(buffer) - 1;
-    *p = '\0';
-    
-    int is_negative = 0;
-    unsigned int abs_value;
-    
-    if (value < 0)
-    {
-        is_negative = 1;
-        // Handle INT_MIN safely by casting to unsigned
-        abs_value = (unsigned int)(-(value + 1)) + 1;
-    }
-    else
+    unsigned int count = workers;
+    if (count > len / DMINI_PARALLEL_MIN_CHUNK)
     {
-        abs_value = (unsigned int)value;
+        count = (unsigned int)(len / DMINI_PARALLEL_MIN_CHUNK);
     }
-    
-    // Convert digits
-    do
-    {
-        *--p = '0' + (abs_value % 10);
-        abs_value /= 10;
-    } while (abs_value > 0);
-    
-    // Add sign
-    if (is_negative)
+    if (count < 2)
     {
-        *--p = '-';
+        return 1;
     }
-    
-    return dmini_set_string(ctx, section, key, p);
-}
 
-int dmini_has_section(dmini_context_t ctx, const char* section)
-{
-    if (!ctx)
+    dmini_chunk_t* chunks = (dmini_chunk_t*)ctx_alloc_temp(ctx, count * (sizeof(dmini_chunk_t) + sizeof(void*)));
+    if (!chunks)
     {
-        return 0;
-    }
-    
-    return find_section(ctx, section) ? 1 : 0;
-}
+        return DMINI_ERR_MEMORY;
+    }
+    void** args = (void**)(chunks + count);
 
-int dmini_has_key(dmini_context_t ctx, const char* section, const char* key)
-{
-    if (!ctx || !key)
+    // Cut after every count-th part of the document, at the next header
+    unsigned int used = 0;
+    size_t start = 0;
+    for (unsigned int i = 1; i <= count && start < len; i++)
     {
-        return 0;
+        size_t cut = len / count * i;
+        size_t end = i == count ? len : parallel_boundary(data, len, cut > start ? cut : start);
+        chunks[used].ctx = NULL;
+        chunks[used].data = data + start;
+        chunks[used].len = end - start;
+        chunks[used].result = DMINI_OK;
+        args[used] = &chunks[used];
+        used++;
+        start = end;
     }
-    
-    dmini_section_t* sec = find_section(ctx, section);
-    if (!sec)
+    if (used < 2)
     {
-        return 0;
+        ctx_free_temp(ctx, chunks, count * (sizeof(dmini_chunk_t) + sizeof(void*)));
+        return 1;
     }
-    
-    return find_pair(sec, key) ? 1 : 0;
-}
 
-int dmini_remove_section(dmini_context_t ctx, const char* section)
-{
-    if (!ctx || !section)
+    int result = DMINI_OK;
+    for (unsigned int i = 0; i < used && result == DMINI_OK; i++)
     {
-        return DMINI_ERR_INVALID;
+        chunks[i].ctx = dmini_create_ex(&ctx->allocator, 0, 0);
+        if (!chunks[i].ctx)
+        {
+            result = DMINI_ERR_MEMORY;
+        }
     }
-    
-    dmini_section_t* prev = NULL;
-    dmini_section_t* curr = ctx->sections;
-    
-    while (curr)
+
+    if (result == DMINI_OK)
     {
-        if (curr->name && strcmp(curr->name, section) == 0)
+        run(parallel_task, args, used, user);
+
+        // Splice in document order; a chunk that failed is kept up to its error like a serial parse
+        for (unsigned int i = 0; i < used && result == DMINI_OK; i++)
         {
-            // Remove from list
-            if (prev)
-            {
-                prev->next = curr->next;
-            }
-            else
+            result = parallel_splice(ctx, chunks[i].ctx);
+            if (result == DMINI_OK)
             {
-                ctx->sections = curr->next;
+                result = chunks[i].result;
             }
-            
-            free_section(curr);
-            return DMINI_OK;
         }
-        
-        prev = curr;
-        curr = curr->next;
     }
-    
-    return DMINI_ERR_NOT_FOUND;
+
+    for (unsigned int i = 0; i < used; i++)
+    {
+        dmini_destroy(chunks[i].ctx);
+    }
+    ctx_free_temp(ctx, chunks, count * (sizeof(dmini_chunk_t) + sizeof(void*)));
+    return result;
 }
+#endif
 
-int dmini_remove_key(dmini_context_t ctx, const char* section, const char* key)
+/**
+ * @brief dmini_parse_parallel() body, called with the writer lock held
+ */
+static int parse_parallel_locked(dmini_context_t ctx, const char* data, size_t len,
+                                 unsigned int workers, dmini_run_tasks_t run, void* user)
 {
-    if (!ctx || !key)
+    if (ctx_frozen(ctx))
     {
-        return DMINI_ERR_INVALID;
+        return DMINI_ERR_READONLY;
     }
-    
-    dmini_section_t* sec = find_section(ctx, section);
-    if (!sec)
+
+    if (!ctx || (!data && len > 0))
     {
-        return DMINI_ERR_NOT_FOUND;
+        return DMINI_ERR_INVALID;
     }
-    
-    dmini_pair_t* prev = NULL;
-    dmini_pair_t* curr = sec->pairs;
-    
-    while (curr)
+
+#if DMINI_USE_PARALLEL
+    // A restricted context remaps sections, a kept document is parsed as one piece
+    // and a static context has no memory for the chunk contexts
+    if (run && !ctx->active_section_locked && !CTX_PRESERVING(ctx) && !CTX_STATIC(ctx))
     {
-        if (strcmp(curr->key, key) == 0)
+        const char* nul = len ? (const char*)memchr(data, '\0', len) : NULL;
+        int result = parallel_parse(ctx, data, nul ? (size_t)(nul - data) : len, workers, run, user);
+        if (result != 1)
         {
-            // Remove from list
-            if (prev)
-            {
-                prev->next = curr->next;
-            }
-            else
-            {
-                sec->pairs = curr->next;
-            }
-            
-            free_pair(curr);
-            return DMINI_OK;
+            return result;
         }
-        
-        prev = curr;
-        curr = curr->next;
     }
-    
-    return DMINI_ERR_NOT_FOUND;
+#endif
+
+    dmini_parser_t parser;
+    parser_init(&parser, ctx);
+    return parse_document(&parser, data, len);
 }
 
-int dmini_section_count(dmini_context_t ctx)
+int dmini_parse_parallel(dmini_context_t ctx, const char* data, size_t len,
+                         unsigned int workers, dmini_run_tasks_t run, void* user)
+{
+    writer_lock(ctx);
+    unsigned int started = stats_clock();
+    int result = parse_parallel_locked(ctx, data, len, workers, run, user);
+    stats_parsed(ctx, started);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_section_count() body, called inside a read-side section
+ */
+static int section_count_guarded(dmini_context_t ctx)
 {
     if (!ctx)
     {
         return DMINI_ERR_INVALID;
     }
 
-    int count = 0;
-    dmini_section_t* section = ctx->sections;
-    while (section)
+    if (ctx_frozen(ctx))
     {
-        if (!ctx->active_section_locked ||
-            section_names_equal(section->name, ctx->active_section))
-        {
-            count++;
-        }
-        section = section->next;
+        return (int)ctx->image->section_count;
     }
 
-    return count;
+    /* Only the active section is visible under the restriction */
+    if (DMINI_LOAD(ctx->active_section_locked))
+    {
+        return find_section_raw(ctx, DMINI_LOAD(ctx->active_section)) ? 1 : 0;
+    }
+
+    return (int)ctx->section_count;
 }
 
-const char* dmini_section_name(dmini_context_t ctx, int index)
+int dmini_section_count(dmini_context_t ctx)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    int result = section_count_guarded(ctx);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+/**
+ * @brief dmini_section_name() body, called inside a read-side section
+ */
+static const char* section_name_guarded(dmini_context_t ctx, int index)
 {
     if (!ctx || index < 0)
     {
         return NULL;
     }
 
+    if (ctx_frozen(ctx))
+    {
+        const dmini_image_t* image = ctx->image;
+        return (uint32_t)index < image->section_count ? image_string(image, image_sections(image)[index].name) : NULL;
+    }
+
+    /* Continue from the previous call when walking forward */
     int current = 0;
-    dmini_section_t* section = ctx->sections;
+    dmini_section_t* section = DMINI_LOAD(ctx->sections);
+    dmini_cursor_t* cursor = &ctx->section_cursor;
+    int use_cursor = !CTX_CONCURRENT(ctx);
+    if (use_cursor && cursor->node && cursor->generation == ctx->generation && cursor->index <= index)
+    {
+        current = cursor->index;
+        section = (dmini_section_t*)cursor->node;
+    }
+
     while (section)
     {
-        if (!ctx->active_section_locked ||
-            section_names_equal(section->name, ctx->active_section))
+        if (section_visible(ctx, section))
         {
             if (current == index)
             {
+                if (use_cursor)
+                {
+                    cursor->node = section;
+                    cursor->index = index;
+                    cursor->generation = ctx->generation;
+                }
                 return section->name;
             }
             current++;
         }
-        section = section->next;
+        section = DMINI_LOAD(section->next);
     }
 
     return NULL;
 }
 
-int dmini_key_count(dmini_context_t ctx, const char* section)
+const char* dmini_section_name(dmini_context_t ctx, int index)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    const char* result = section_name_guarded(ctx, index);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+/**
+ * @brief dmini_key_count() body, called inside a read-side section
+ */
+static int key_count_guarded(dmini_context_t ctx, const char* section)
 {
     if (!ctx)
     {
         return DMINI_ERR_INVALID;
     }
 
+    if (ctx_frozen(ctx))
+    {
+        const dmini_image_section_t* record = image_find_section(ctx->image, section);
+        return record ? (int)record->pair_count : DMINI_ERR_NOT_FOUND;
+    }
+
     dmini_section_t* sec = find_section(ctx, section);
     if (!sec)
     {
         return DMINI_ERR_NOT_FOUND;
     }
 
-    int count = 0;
-    dmini_pair_t* pair = sec->pairs;
-    while (pair)
-    {
-        count++;
-        pair = pair->next;
-    }
+    return (int)sec->pair_count;
+}
 
-    return count;
+int dmini_key_count(dmini_context_t ctx, const char* section)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    int result = key_count_guarded(ctx, section);
+    dmini_read_end(ctx, token);
+    return result;
 }
 
-const char* dmini_key_name(dmini_context_t ctx, const char* section, int index)
+/**
+ * @brief dmini_key_name() body, called inside a read-side section
+ */
+static const char* key_name_guarded(dmini_context_t ctx, const char* section, int index)
 {
     if (!ctx || index < 0)
     {
         return NULL;
     }
 
+    if (ctx_frozen(ctx))
+    {
+        const dmini_image_t* image = ctx->image;
+        const dmini_image_section_t* record = image_find_section(image, section);
+        if (!record || (uint32_t)index >= record->pair_count)
+        {
+            return NULL;
+        }
+        return image_string(image, image_pairs(image)[record->first_pair + index].key);
+    }
+
     dmini_section_t* sec = find_section(ctx, section);
     if (!sec)
     {
         return NULL;
     }
 
+    /* Continue from the previous call when walking forward in the same section */
     int current = 0;
-    dmini_pair_t* pair = sec->pairs;
+    dmini_pair_t* pair = DMINI_LOAD(sec->pairs);
+    dmini_cursor_t* cursor = &ctx->key_cursor;
+    int use_cursor = !CTX_CONCURRENT(ctx);
+    if (use_cursor && cursor->node && cursor->owner == sec &&
+        cursor->generation == ctx->generation && cursor->index <= index)
+    {
+        current = cursor->index;
+        pair = (dmini_pair_t*)cursor->node;
+    }
+
     while (pair)
     {
         if (current == index)
         {
+            if (use_cursor)
+            {
+                cursor->owner = sec;
+                cursor->node = pair;
+                cursor->index = index;
+                cursor->generation = ctx->generation;
+            }
             return pair->key;
         }
         current++;
-        pair = pair->next;
+        pair = DMINI_LOAD(pair->next);
     }
 
     return NULL;
 }
 
-int dmini_set_active_section(dmini_context_t ctx, const char* section, unsigned int owner_token)
+const char* dmini_key_name(dmini_context_t ctx, const char* section, int index)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    const char* result = key_name_guarded(ctx, section, index);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+/**
+ * @brief Check that an iterator still matches its context
+ */
+static int iter_valid(dmini_iter_t* iter)
+{
+    return iter && iter->node && iter->ctx &&
+           iter->generation == DMINI_ATOMIC_LOAD(&iter->ctx->generation);
+}
+
+/**
+ * @brief dmini_iter_sections() body, called inside a read-side section
+ */
+static int iter_sections_guarded(dmini_context_t ctx, dmini_iter_t* iter)
+{
+    if (!ctx || !iter)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    iter->ctx = ctx;
+    iter->generation = DMINI_ATOMIC_LOAD(&ctx->generation);
+    if (ctx_frozen(ctx))
+    {
+        iter->node = ctx->image->section_count ? (void*)image_sections(ctx->image) : NULL;
+        return DMINI_OK;
+    }
+    iter->node = DMINI_LOAD(ctx->active_section_locked) ? find_section_raw(ctx, DMINI_LOAD(ctx->active_section))
+                                            : DMINI_LOAD(ctx->sections);
+    return DMINI_OK;
+}
+
+int dmini_iter_sections(dmini_context_t ctx, dmini_iter_t* iter)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    int result = iter_sections_guarded(ctx, iter);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+int dmini_next_section(dmini_iter_t* iter, const char** name, size_t* name_len)
+{
+    if (!iter || !iter->ctx)
+    {
+        return 0;
+    }
+
+    unsigned int token = dmini_read_begin(iter->ctx);
+    if (!iter_valid(iter))
+    {
+        dmini_read_end(iter->ctx, token);
+        return 0;
+    }
+
+    if (ctx_frozen(iter->ctx))
+    {
+        const dmini_image_t* image = iter->ctx->image;
+        const dmini_image_section_t* record = (const dmini_image_section_t*)iter->node;
+        if (name)
+        {
+            *name = image_string(image, record->name);
+        }
+        if (name_len)
+        {
+            *name_len = record->name_len;
+        }
+        record++;
+        iter->node = record < image_sections(image) + image->section_count ? (void*)record : NULL;
+        dmini_read_end(iter->ctx, token);
+        return 1;
+    }
+
+    dmini_section_t* section = (dmini_section_t*)iter->node;
+    if (name)
+    {
+        *name = section->name;
+    }
+    if (name_len)
+    {
+        *name_len = section->name_len;
+    }
+
+    /* Under the restriction the active section is the only one visible */
+    iter->node = iter->ctx->active_section_locked ? NULL : DMINI_LOAD(section->next);
+    dmini_read_end(iter->ctx, token);
+    return 1;
+}
+
+/**
+ * @brief dmini_iter_pairs() body, called inside a read-side section
+ */
+static int iter_pairs_guarded(dmini_context_t ctx, const char* section, dmini_iter_t* iter)
+{
+    if (!ctx || !iter)
+    {
+        return DMINI_ERR_INVALID;
+    }
+
+    iter->ctx = ctx;
+    iter->generation = DMINI_ATOMIC_LOAD(&ctx->generation);
+    iter->node = NULL;
+
+    if (ctx_frozen(ctx))
+    {
+        const dmini_image_section_t* record = image_find_section(ctx->image, section);
+        if (!record)
+        {
+            return DMINI_ERR_NOT_FOUND;
+        }
+        iter->node = record->pair_count ? (void*)&image_pairs(ctx->image)[record->first_pair] : NULL;
+        return DMINI_OK;
+    }
+
+    dmini_section_t* sec = find_section(ctx, section);
+    if (!sec)
+    {
+        return DMINI_ERR_NOT_FOUND;
+    }
+
+    iter->node = DMINI_LOAD(sec->pairs);
+    return DMINI_OK;
+}
+
+int dmini_iter_pairs(dmini_context_t ctx, const char* section, dmini_iter_t* iter)
+{
+    unsigned int token = dmini_read_begin(ctx);
+    int result = iter_pairs_guarded(ctx, section, iter);
+    dmini_read_end(ctx, token);
+    return result;
+}
+
+int dmini_next_pair(dmini_iter_t* iter, dmini_entry_t* entry)
+{
+    if (!iter || !iter->ctx)
+    {
+        return 0;
+    }
+
+    unsigned int token = dmini_read_begin(iter->ctx);
+    if (!iter_valid(iter))
+    {
+        dmini_read_end(iter->ctx, token);
+        return 0;
+    }
+
+    if (ctx_frozen(iter->ctx))
+    {
+        const dmini_image_t* image = iter->ctx->image;
+        const dmini_image_pair_t* record = (const dmini_image_pair_t*)iter->node;
+        if (entry)
+        {
+            entry->key = image_string(image, record->key);
+            entry->value = image_string(image, record->value);
+            entry->key_len = record->key_len;
+            entry->value_len = record->value_len;
+        }
+        const dmini_image_pair_t* next = record + 1;
+        iter->node = (next < image_pairs(image) + image->pair_count && next->section == record->section)
+                         ? (void*)next : NULL;
+        dmini_read_end(iter->ctx, token);
+        return 1;
+    }
+
+    dmini_pair_t* pair = (dmini_pair_t*)iter->node;
+    if (entry)
+    {
+        entry->key = pair->key;
+        entry->value = DMINI_LOAD(pair->value);
+        entry->key_len = pair->key_len;
+        /* A writer may replace the value concurrently; measure the one we loaded */
+        entry->value_len = CTX_CONCURRENT(iter->ctx) ? strlen(entry->value) : pair->value_len;
+    }
+
+    iter->node = DMINI_LOAD(pair->next);
+    dmini_read_end(iter->ctx, token);
+    return 1;
+}
+
+/**
+ * @brief dmini_set_active_section() body, called with the writer lock held
+ */
+static int set_active_section_locked(dmini_context_t ctx, const char* section, unsigned int owner_token)
 {
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
     if (!ctx)
     {
         return DMINI_ERR_INVALID;
@@ -1241,28 +8278,48 @@ int dmini_set_active_section(dmini_context_t ctx, const char* section, unsigned
         return DMINI_ERR_LOCKED;
     }
 
-    /* Free any previously stored active section name */
-    if (ctx->active_section)
-    {
-        Dmod_Free(ctx->active_section);
-        ctx->active_section = NULL;
-    }
-
+    char* name = NULL;
     if (section)
     {
-        ctx->active_section = Dmod_StrDup(section);
-        if (!ctx->active_section)
+        name = ctx_strdup(ctx, section);
+        if (!name)
         {
             return DMINI_ERR_MEMORY;
         }
     }
 
-    ctx->active_section_locked = 1;
+    /* Handles resolved under the previous view are no longer valid */
+    DMINI_ATOMIC_ADD(&ctx->generation, 1u);
+
+    /* Replace the previously stored active section name */
+    char* old = ctx->active_section;
+    DMINI_PUBLISH(ctx->active_section, name);
+    DMINI_PUBLISH(ctx->active_section_locked, 1);
+    if (old)
+    {
+        ctx_retire(ctx, DMINI_RETIRE_SPAN, old, strlen(old));
+    }
     return DMINI_OK;
 }
 
-int dmini_clear_active_section(dmini_context_t ctx, unsigned int owner_token)
+int dmini_set_active_section(dmini_context_t ctx, const char* section, unsigned int owner_token)
+{
+    writer_lock(ctx);
+    int result = set_active_section_locked(ctx, section, owner_token);
+    writer_unlock(ctx);
+    return result;
+}
+
+/**
+ * @brief dmini_clear_active_section() body, called with the writer lock held
+ */
+static int clear_active_section_locked(dmini_context_t ctx, unsigned int owner_token)
 {
+    if (ctx_frozen(ctx))
+    {
+        return DMINI_ERR_READONLY;
+    }
+
     if (!ctx)
     {
         return DMINI_ERR_INVALID;
@@ -1274,12 +8331,23 @@ int dmini_clear_active_section(dmini_context_t ctx, unsigned int owner_token)
         return DMINI_ERR_LOCKED;
     }
 
-    if (ctx->active_section)
+    /* Handles resolved under the previous view are no longer valid */
+    DMINI_ATOMIC_ADD(&ctx->generation, 1u);
+
+    char* old = ctx->active_section;
+    DMINI_PUBLISH(ctx->active_section_locked, 0);
+    DMINI_PUBLISH(ctx->active_section, NULL);
+    if (old)
     {
-        Dmod_Free(ctx->active_section);
-        ctx->active_section = NULL;
+        ctx_retire(ctx, DMINI_RETIRE_SPAN, old, strlen(old));
     }
-
-    ctx->active_section_locked = 0;
     return DMINI_OK;
 }
+
+int dmini_clear_active_section(dmini_context_t ctx, unsigned int owner_token)
+{
+    writer_lock(ctx);
+    int result = clear_active_section_locked(ctx, owner_token);
+    writer_unlock(ctx);
+    return result;
+}